@@ -1,8 +1,13 @@
 #include "arithmetic.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "real.h"
+#include "progress.h"
 
 
 int add_word_at_hword_idx(struct Real* r, ssize_t hword_idx, word w) {
@@ -54,8 +59,8 @@ int add_word_at_hword_idx(struct Real* r, ssize_t hword_idx, word w) {
     return rtn;
 }
 
-struct Real* mul_with_sig(struct Real* r1, struct Real* r2,
-                          ssize_t min_sig_word_idx) {
+struct Real* schoolbook_mul_with_sig(struct Real* r1, struct Real* r2,
+                                     ssize_t min_sig_word_idx) {
     // Multiply 2 real numbers, ignoring all words below `min_sig_word_idx`.
     struct Real* p;
     enum sign_t sign;
@@ -76,8 +81,14 @@ struct Real* mul_with_sig(struct Real* r1, struct Real* r2,
     ssize_t idx_1, idx_2;
     ssize_t idx_2_lower_bound;
     word h1, h2;
-    for (idx_1 = 2*get_min_word_idx(r1);
-         idx_1 < 2*get_max_word_idx(r1); idx_1++) {
+    // Half-words of `r1` this far down only make products below
+    // `min_word_idx`, so skip them without reading them.
+    ssize_t first_idx_1 = MAX(2*get_min_word_idx(r1),
+                              2*min_word_idx - 2*get_max_word_idx(r2));
+    begin_stage("multiply", MAX(0, 2*get_max_word_idx(r1) - first_idx_1));
+    for (idx_1 = first_idx_1; idx_1 < 2*get_max_word_idx(r1); idx_1++) {
+        // A product can't stop half-way, so this only reports progress.
+        checkpoint(idx_1 - first_idx_1);
         h1 = (word) get_half_word(r1, idx_1);
 
         idx_2_lower_bound = MAX(2 * get_min_word_idx(r2),
@@ -88,6 +99,108 @@ struct Real* mul_with_sig(struct Real* r1, struct Real* r2,
             add_word_at_hword_idx(p, idx_1 + idx_2, h1*h2);
         }
     }
+    end_stage();
+    return p;
+}
+
+struct Real* karatsuba(struct Real* a, struct Real* b) {
+    // Returns a * b for non-negative integers `a` and `b` (i.e. with
+    // `min_word_idx` 0), splitting both in half and using 3 products of
+    // the halves instead of 4:
+    //
+    //   (a1 x + a0)(b1 x + b0) = z2 x^2 + z1 x + z0,
+    //   z1 = (a1 + a0)(b1 + b0) - z2 - z0.
+    if (get_max_word_idx(a) < get_max_word_idx(b)) {
+        struct Real* temp = a;
+        a = b;
+        b = temp;
+    }
+    if (get_max_word_idx(b) < thresholds.karatsuba_min_words) {
+        return schoolbook_mul_with_sig(a, b, 0);
+    }
+
+    ssize_t half = (get_max_word_idx(a) + 1) / 2;
+    struct Real* a0 = view_real(a, 0, half);
+    struct Real* a1 = view_real(a, half, get_max_word_idx(a));
+    shift_words(a1, -half);
+
+    struct Real* p;
+    if (get_max_word_idx(b) <= half) {
+        // `b` has no top half, so split `a` only.
+        begin_stage("multiply", 2);
+        struct Real* high = karatsuba(a1, b);
+        checkpoint(1);
+        p = karatsuba(a0, b);
+        end_stage();
+        shift_words(high, half);
+        add_to(p, high);
+        free_real(high);
+    } else {
+        struct Real* b0 = view_real(b, 0, half);
+        struct Real* b1 = view_real(b, half, get_max_word_idx(b));
+        shift_words(b1, -half);
+
+        begin_stage("multiply", 3);
+        struct Real* z2 = karatsuba(a1, b1);
+        checkpoint(1);
+        p = karatsuba(a0, b0);
+        checkpoint(2);
+        struct Real* sum_a = add(a0, a1);
+        struct Real* sum_b = add(b0, b1);
+        struct Real* z1 = karatsuba(sum_a, sum_b);
+        end_stage();
+        subtract_from(z1, p);
+        subtract_from(z1, z2);
+
+        shift_words(z1, half);
+        shift_words(z2, 2*half);
+        add_to(p, z1);
+        add_to(p, z2);
+
+        free_real(b0);
+        free_real(b1);
+        free_real(z2);
+        free_real(sum_a);
+        free_real(sum_b);
+        free_real(z1);
+    }
+    free_real(a0);
+    free_real(a1);
+    return p;
+}
+
+struct Real* mul_with_sig(struct Real* r1, struct Real* r2,
+                          ssize_t min_sig_word_idx) {
+    // Multiply 2 real numbers, ignoring all words below `min_sig_word_idx`.
+    if (MIN(get_max_word_idx(r1) - get_min_word_idx(r1),
+            get_max_word_idx(r2) - get_min_word_idx(r2))
+        < thresholds.karatsuba_min_words) {
+        return schoolbook_mul_with_sig(r1, r2, min_sig_word_idx);
+    }
+
+    enum sign_t sign = (get_sign(r1) == get_sign(r2)) ? POSITIVE : NEGATIVE;
+    ssize_t min_word_idx = MAX(get_min_word_idx(r1) + get_min_word_idx(r2),
+                               min_sig_word_idx);
+
+    // Words this far down only add less than a unit of the word below
+    // `min_word_idx`, which is less than the schoolbook method drops.
+    struct Real* a = view_real(r1, min_word_idx - get_max_word_idx(r2) - 1,
+                               get_max_word_idx(r1));
+    struct Real* b = view_real(r2, min_word_idx - get_max_word_idx(r1) - 1,
+                               get_max_word_idx(r2));
+    ssize_t shift = get_min_word_idx(a) + get_min_word_idx(b);
+    shift_words(a, -get_min_word_idx(a));
+    shift_words(b, -get_min_word_idx(b));
+    set_sign(a, POSITIVE);
+    set_sign(b, POSITIVE);
+
+    struct Real* p = karatsuba(a, b);
+    shift_words(p, shift);
+    set_sign(p, sign);
+    truncate_real(p, min_word_idx);
+
+    free_real(a);
+    free_real(b);
     return p;
 }
 
@@ -108,6 +221,150 @@ struct Real* mul_with_rel_sig(struct Real* r1, struct Real* r2,
     return mul_with_sig(r1, r2, min_word_idx);
 }
 
+int parallel_add_threads = 0;
+
+int add_words_serial(struct Real* s, struct Real* r1, struct Real* r2,
+                     ssize_t min_word_idx, ssize_t max_word_idx,
+                     int subtracting, int carry) {
+    // Sets the words of `s` in [`min_word_idx`, `max_word_idx`) to those
+    // of `r1` plus (or minus) those of `r2`, starting with a carry (or
+    // borrow) of `carry`. Returns the carry (or borrow) out of the top.
+    word w1, w2, result_word;
+    ssize_t word_idx;
+    for (word_idx = min_word_idx; word_idx < max_word_idx; word_idx++) {
+        w1 = get_word(r1, word_idx);
+        w2 = get_word(r2, word_idx);
+        if (subtracting) {
+            result_word = w1 - w2 - carry;
+            carry = (carry == 0) ? (result_word > w1) : (result_word >= w1);
+        } else {
+            result_word = w1 + w2 + carry;
+            carry = (carry == 0) ? (result_word < w1) : (result_word <= w1);
+        }
+        set_word(s, word_idx, result_word);
+    }
+    return carry;
+}
+
+int carry_into(struct Real* r, ssize_t word_idx, ssize_t max_word_idx,
+               int subtracting) {
+    // Adds (or subtracts) 1 at `word_idx`, modulo 2^(64 * max_word_idx).
+    // Returns 1 if it carries (or borrows) out of the top.
+    word w;
+    for (; word_idx < max_word_idx; word_idx++) {
+        w = get_word(r, word_idx);
+        set_word(r, word_idx, subtracting ? w - 1 : w + 1);
+        if (w != (subtracting ? 0 : ~((word) 0))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+struct AddBlock {
+    struct Real* s;
+    struct Real* r1;
+    struct Real* r2;
+    ssize_t min_word_idx;
+    ssize_t max_word_idx;
+    int subtracting;
+    // The carry out of the block if no carry comes in.
+    int carry;
+    // 1 if a carry coming in would go all the way through the block,
+    // i.e. every word is all 1s (or all 0s when subtracting).
+    int propagate;
+};
+
+void* add_block(void* arg) {
+    struct AddBlock* block = arg;
+    block->carry = add_words_serial(block->s, block->r1, block->r2,
+                                    block->min_word_idx, block->max_word_idx,
+                                    block->subtracting, 0);
+
+    word all = block->subtracting ? 0 : ~((word) 0);
+    ssize_t word_idx;
+    block->propagate = 1;
+    for (word_idx = block->min_word_idx;
+         word_idx < block->max_word_idx && block->propagate;
+         word_idx++) {
+        block->propagate = (get_word(block->s, word_idx) == all);
+    }
+    return NULL;
+}
+
+pthread_once_t num_cpus_once = PTHREAD_ONCE_INIT;
+int num_cpus;
+
+void read_num_cpus(void) {
+    num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+int get_num_cpus(void) {
+    // `sysconf` is a system call on some platforms, which is far too slow
+    // to make on every add, so it's only made once.
+    pthread_once(&num_cpus_once, read_num_cpus);
+    return num_cpus;
+}
+
+int add_words(struct Real* s, struct Real* r1, struct Real* r2,
+              ssize_t min_word_idx, ssize_t max_word_idx, int subtracting) {
+    // Same as `add_words_serial` with no carry in, but big ranges are
+    // split into blocks that are added on separate threads.
+    //
+    // Each block is first added as if nothing carries into it. Then a
+    // quick serial pass works out which blocks do get a carry in and adds
+    // it to them, which only touches the run of words it carries through.
+    // The result is identical to the serial one.
+    if (max_word_idx - min_word_idx < thresholds.parallel_add_min_words) {
+        return add_words_serial(s, r1, r2, min_word_idx, max_word_idx,
+                                subtracting, 0);
+    }
+    int num_threads = parallel_add_threads;
+    if (num_threads <= 0) {
+        num_threads = get_num_cpus();
+    }
+    num_threads = MIN(num_threads, MAX_ADD_THREADS);
+    if (max_word_idx - min_word_idx < num_threads ||
+        num_threads < 2) {
+        return add_words_serial(s, r1, r2, min_word_idx, max_word_idx,
+                                subtracting, 0);
+    }
+
+    // Writing the first word gives `s` its own buffer (if it shares one)
+    // before the threads start writing to it.
+    set_word(s, min_word_idx, get_word(s, min_word_idx));
+
+    struct AddBlock blocks[MAX_ADD_THREADS];
+    pthread_t threads[MAX_ADD_THREADS];
+    ssize_t block_size = (max_word_idx - min_word_idx) / num_threads;
+    int i;
+    for (i = 0; i < num_threads; i++) {
+        blocks[i].s = s;
+        blocks[i].r1 = r1;
+        blocks[i].r2 = r2;
+        blocks[i].min_word_idx = min_word_idx + i*block_size;
+        blocks[i].max_word_idx = (i == num_threads - 1)
+            ? max_word_idx : min_word_idx + (i + 1)*block_size;
+        blocks[i].subtracting = subtracting;
+        pthread_create(&threads[i], NULL, add_block, &blocks[i]);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int carry = 0;
+    for (i = 0; i < num_threads; i++) {
+        if (carry) {
+            carry_into(s, blocks[i].min_word_idx, blocks[i].max_word_idx,
+                       subtracting);
+            carry = blocks[i].carry || blocks[i].propagate;
+        } else {
+            carry = blocks[i].carry;
+        }
+    }
+    return carry;
+}
+
 int greater_abs(struct Real* r1, struct Real* r2) {
     // Returns 1 if abs(r1) > abs(r2).
     // Otherwise returns 0.
@@ -154,29 +411,9 @@ struct Real* add(struct Real* r1, struct Real* r2) {
                        MAX(get_max_word_idx(r1),
                            get_max_word_idx(r2)) + 1);
 
-        ssize_t word_idx;
-        word w1, w2, sum_word;
-        int carry = 0;
-        for (word_idx = get_min_word_idx(s);
-             word_idx < get_max_word_idx(s);
-             word_idx++) {
-            w1 = get_word(r1, word_idx);
-            w2 = get_word(r2, word_idx);
-            sum_word = w1 + w2 + carry;
-            set_word(s, word_idx, sum_word);
-            if ((carry == 0 &&
-                 sum_word < w1) ||
-                (carry == 1 &&
-                 sum_word <= w1)) {
-                carry = 1;
-            } else {
-                carry = 0;
-            }
-        }
-
-        if (carry == 0) {
-            trim_most_significant_zeros(s);
-        }
+        // The top word can't carry out of `s`.
+        add_words(s, r1, r2, get_min_word_idx(s), get_max_word_idx(s), 0);
+        trim_most_significant_zeros(s);
     }
     return s;
 }
@@ -212,27 +449,237 @@ struct Real* subtract(struct Real* r1, struct Real* r2) {
                        MAX(get_max_word_idx(r1),
                            get_max_word_idx(r2)));
 
-        int borrow = 0;
-        word w1, w2, diff_word;
+        add_words(s, r1, r2, get_min_word_idx(s), get_max_word_idx(s), 1);
+    }
+    return s;
+}
+
+void add_magnitude_to(struct Real* acc, struct Real* r) {
+    // Sets |acc| to |acc| + |r| in-place.
+    resize_real(acc,
+                MIN(get_min_word_idx(acc), get_min_word_idx(r)),
+                MAX(get_max_word_idx(acc), get_max_word_idx(r)));
+
+    // Only words from the bottom of `r` up to the last carry change.
+    ssize_t max_word_idx = get_max_word_idx(r);
+    int carry = add_words(acc, acc, r, get_min_word_idx(r), max_word_idx, 0);
+    if (carry) {
+        carry = carry_into(acc, max_word_idx, get_max_word_idx(acc), 0);
+    }
+
+    if (carry) {
+        ssize_t max_word_idx = get_max_word_idx(acc);
+        resize_real(acc, get_min_word_idx(acc), max_word_idx + 1);
+        set_word(acc, max_word_idx, 1);
+    }
+}
+
+void subtract_magnitude_from(struct Real* acc, struct Real* r) {
+    // Sets |acc| to ||acc| - |r||, flipping the sign of `acc` if |r| is
+    // bigger.
+    int flip = greater_abs(r, acc);
+    resize_real(acc,
+                MIN(get_min_word_idx(acc), get_min_word_idx(r)),
+                MAX(get_max_word_idx(acc), get_max_word_idx(r)));
+
+    // If `acc` is bigger, only words from the bottom of `r` up to the
+    // last borrow change. Otherwise all of them do.
+    if (flip) {
+        add_words(acc, r, acc, get_min_word_idx(acc), get_max_word_idx(acc),
+                  1);
+    } else if (add_words(acc, acc, r, get_min_word_idx(r),
+                         get_max_word_idx(r), 1)) {
+        carry_into(acc, get_max_word_idx(r), get_max_word_idx(acc), 1);
+    }
+
+    if (flip) {
+        negate(acc);
+    }
+    trim_most_significant_zeros(acc);
+}
+
+void add_to(struct Real* acc, struct Real* r) {
+    if (get_sign(acc) == get_sign(r)) {
+        add_magnitude_to(acc, r);
+    } else {
+        subtract_magnitude_from(acc, r);
+    }
+}
+
+void subtract_from(struct Real* acc, struct Real* r) {
+    if (get_sign(acc) == get_sign(r)) {
+        subtract_magnitude_from(acc, r);
+    } else {
+        add_magnitude_to(acc, r);
+    }
+}
+
+void accumulate_word(struct Real* r, ssize_t word_idx, word w,
+                     int subtract) {
+    // Adds (or subtracts) w * 2^(64 * word_idx) to `r`, modulo the top of
+    // `r`'s words.
+    word old_word, new_word;
+    while (w != 0 && word_idx < get_max_word_idx(r)) {
+        old_word = get_word(r, word_idx);
+        if (subtract) {
+            new_word = old_word - w;
+            w = (new_word > old_word);
+        } else {
+            new_word = old_word + w;
+            w = (new_word < old_word);
+        }
+        set_word(r, word_idx, new_word);
+        word_idx++;
+    }
+}
+
+void accumulate_hword_product(struct Real* r, ssize_t hword_idx, word w,
+                              int subtract) {
+    // Adds (or subtracts) the product of 2 half-words, w * 2^(32 * hword_idx).
+    if (hword_idx & 1) {
+        ssize_t word_idx = floor_div(hword_idx, 2);
+        accumulate_word(r, word_idx, w << (sizeof(hword)*8), subtract);
+        accumulate_word(r, word_idx + 1, w >> (sizeof(hword)*8), subtract);
+    } else {
+        accumulate_word(r, hword_idx / 2, w, subtract);
+    }
+}
+
+int begin_accumulate(struct Real* acc, enum sign_t product_sign,
+                     ssize_t min_word_idx, ssize_t max_word_idx) {
+    // Widens `acc` to hold a product with words in
+    // [`min_word_idx`, `max_word_idx`), plus a top word that is all 1s if
+    // the result goes negative. Returns 1 if the product's magnitude must
+    // be subtracted from `acc`'s.
+    resize_real(acc,
+                MIN(get_min_word_idx(acc), min_word_idx),
+                MAX(get_max_word_idx(acc), max_word_idx) + 1);
+    return product_sign != get_sign(acc);
+}
+
+void end_accumulate(struct Real* acc, int subtracted) {
+    // If subtracting wrapped around, `acc` holds the two's complement of
+    // the result's magnitude, so negate it back.
+    word top = get_word(acc, get_max_word_idx(acc) - 1);
+    if (subtracted && (top >> (WORD_BITS - 1))) {
+        int carry = 1;
+        word w;
         ssize_t word_idx;
-        for (word_idx = get_min_word_idx(s);
-             word_idx < get_max_word_idx(s);
+        for (word_idx = get_min_word_idx(acc);
+             word_idx < get_max_word_idx(acc);
              word_idx++) {
-            w1 = get_word(r1, word_idx);
-            w2 = get_word(r2, word_idx);
-            diff_word = w1 - w2 - borrow;
-            set_word(s, word_idx, diff_word);
-            if ((borrow == 0 &&
-                 diff_word > w1) ||
-                (borrow == 1 &&
-                 diff_word >= w1)) {
-                borrow = 1;
-            } else {
-                borrow = 0;
-            }
+            w = ~get_word(acc, word_idx) + carry;
+            carry = carry && (w == 0);
+            set_word(acc, word_idx, w);
         }
+        negate(acc);
+    }
+    trim_most_significant_zeros(acc);
+}
+
+void multiply_accumulate(struct Real* acc, struct Real* r1, struct Real* r2,
+                         ssize_t min_sig_word_idx, int subtract) {
+    // Adds (or subtracts) `r1 * r2` into `acc`, with the same product as
+    // `mul_with_sig`.
+    if (MIN(get_max_word_idx(r1) - get_min_word_idx(r1),
+            get_max_word_idx(r2) - get_min_word_idx(r2))
+        >= thresholds.karatsuba_min_words) {
+        // Karatsuba beats accumulating the partial products by far more
+        // than the temporary costs.
+        struct Real* p = mul_with_sig(r1, r2, min_sig_word_idx);
+        if (subtract) {
+            subtract_from(acc, p);
+        } else {
+            add_to(acc, p);
+        }
+        free_real(p);
+        return;
+    }
+
+    struct Real* view1 = NULL;
+    struct Real* view2 = NULL;
+    if (r1 == acc) {
+        // Writing to `acc` gives it its own words, so the view keeps the
+        // old value.
+        view1 = view_real(acc, get_min_word_idx(acc), get_max_word_idx(acc));
+        r1 = view1;
+    }
+    if (r2 == acc) {
+        view2 = view_real(acc, get_min_word_idx(acc), get_max_word_idx(acc));
+        r2 = view2;
+    }
+
+    enum sign_t sign = (get_sign(r1) == get_sign(r2)) ? POSITIVE : NEGATIVE;
+    if (subtract) {
+        sign = (sign == POSITIVE) ? NEGATIVE : POSITIVE;
+    }
+    ssize_t min_word_idx = MAX(get_min_word_idx(r1) + get_min_word_idx(r2),
+                               min_sig_word_idx);
+    int subtracted = begin_accumulate(acc, sign, min_word_idx,
+                                      get_max_word_idx(r1)
+                                      + get_max_word_idx(r2));
+
+    ssize_t idx_1, idx_2;
+    word h1, h2;
+    for (idx_1 = MAX(2*get_min_word_idx(r1),
+                     2*min_word_idx - 2*get_max_word_idx(r2));
+         idx_1 < 2*get_max_word_idx(r1); idx_1++) {
+        h1 = (word) get_half_word(r1, idx_1);
+        if (h1 == 0) {
+            continue;
+        }
+        for (idx_2 = MAX(2*get_min_word_idx(r2), 2*min_word_idx - idx_1);
+             idx_2 < 2*get_max_word_idx(r2); idx_2++) {
+            h2 = (word) get_half_word(r2, idx_2);
+            accumulate_hword_product(acc, idx_1 + idx_2, h1*h2, subtracted);
+        }
+    }
+    end_accumulate(acc, subtracted);
+
+    if (view1 != NULL) {
+        free_real(view1);
+    }
+    if (view2 != NULL) {
+        free_real(view2);
+    }
+}
+
+void fma_with_sig(struct Real* acc, struct Real* r1, struct Real* r2,
+                  ssize_t min_sig_word_idx) {
+    multiply_accumulate(acc, r1, r2, min_sig_word_idx, 0);
+}
+
+void fms_with_sig(struct Real* acc, struct Real* r1, struct Real* r2,
+                  ssize_t min_sig_word_idx) {
+    multiply_accumulate(acc, r1, r2, min_sig_word_idx, 1);
+}
+
+void axpy(struct Real* acc, word alpha, struct Real* x) {
+    struct Real* view = NULL;
+    if (x == acc) {
+        view = view_real(acc, get_min_word_idx(acc), get_max_word_idx(acc));
+        x = view;
+    }
+
+    int subtracted = begin_accumulate(acc, get_sign(x), get_min_word_idx(x),
+                                      get_max_word_idx(x) + 1);
+
+    word alpha_low = (hword) alpha;
+    word alpha_high = alpha >> (sizeof(hword)*8);
+    ssize_t hword_idx;
+    word h;
+    for (hword_idx = 2*get_min_word_idx(x);
+         hword_idx < 2*get_max_word_idx(x); hword_idx++) {
+        h = (word) get_half_word(x, hword_idx);
+        accumulate_hword_product(acc, hword_idx, h*alpha_low, subtracted);
+        accumulate_hword_product(acc, hword_idx + 1, h*alpha_high,
+                                 subtracted);
+    }
+    end_accumulate(acc, subtracted);
+
+    if (view != NULL) {
+        free_real(view);
     }
-    return s;
 }
 
 struct Real* div_with_sig(struct Real* r, word divisor,
@@ -266,12 +713,380 @@ struct Real* div_with_sig(struct Real* r, word divisor,
     return q;
 }
 
+void divide_by_word(struct Real* r, word divisor, ssize_t min_sig_word_idx) {
+    // The same as `div_with_sig`, dividing each half-word in place from
+    // the top down.
+    if (get_max_word_idx(r) <= min_sig_word_idx) {
+        resize_real(r, 0, 1);
+        set_word(r, 0, 0);
+        set_sign(r, POSITIVE);
+        return;
+    }
+    resize_real(r, min_sig_word_idx, get_max_word_idx(r));
+
+    ssize_t hword_idx;
+    word h;
+    word remainder = 0;
+    for (hword_idx = 2*get_max_word_idx(r) - 1;
+         hword_idx >= 2*get_min_word_idx(r);
+         hword_idx--) {
+        h = (word) get_half_word(r, hword_idx);
+        h += remainder << (sizeof(hword)*8);
+        set_half_word(r, hword_idx, (hword) (h / divisor));
+        remainder = h % divisor;
+    }
+}
+
 struct Real* div_with_rel_sig(struct Real* r, word divisor,
                               int num_sig_words) {
     trim_most_significant_zeros(r);
     return div_with_sig(r, divisor, get_max_word_idx(r) - num_sig_words);
 }
 
+struct Real* shift_left_bits(struct Real* r, ssize_t num_bits) {
+    // Each word of the result is a funnel shift of 2 neighboring words of
+    // `r`.
+    ssize_t word_shift = floor_div(num_bits, WORD_BITS);
+    ssize_t bit_shift = num_bits - word_shift*WORD_BITS;
+    struct Real* rtn;
+    if (bit_shift == 0) {
+        rtn = copy_real(r);
+        shift_words(rtn, word_shift);
+        return rtn;
+    }
+
+    rtn = alloc_real(get_sign(r),
+                     get_min_word_idx(r) + word_shift,
+                     get_max_word_idx(r) + word_shift + 1);
+    ssize_t word_idx;
+    word low, high;
+    for (word_idx = get_min_word_idx(r);
+         word_idx <= get_max_word_idx(r);
+         word_idx++) {
+        high = get_word(r, word_idx);
+        low = get_word(r, word_idx - 1);
+        set_word(rtn, word_idx + word_shift,
+                 (high << bit_shift) | (low >> (WORD_BITS - bit_shift)));
+    }
+    trim_most_significant_zeros(rtn);
+    return rtn;
+}
+
+struct Real* shift_right_bits(struct Real* r, ssize_t num_bits) {
+    return shift_left_bits(r, -num_bits);
+}
+
+struct Real* word_times_pow2(enum sign_t sign, word w, ssize_t bit_idx) {
+    ssize_t word_idx = floor_div(bit_idx, WORD_BITS);
+    ssize_t bit_offset = bit_idx - word_idx*WORD_BITS;
+    word high = 0;
+    if (bit_offset != 0) {
+        high = w >> (WORD_BITS - bit_offset);
+    }
+    return fill_real(sign, word_idx, word_idx + 2, w << bit_offset, high);
+}
+
+double top_as_double(struct Real* r) {
+    ssize_t exponent = get_exponent(r);
+    ssize_t top_idx = floor_div(exponent - 1, WORD_BITS);
+    return (ldexp((double) get_word(r, top_idx),
+                  top_idx*WORD_BITS - exponent)
+            + ldexp((double) get_word(r, top_idx - 1),
+                    (top_idx - 1)*WORD_BITS - exponent));
+}
+
+word newton_steps(ssize_t bits, ssize_t target_bits, ssize_t loss) {
+    // Returns the number of Newton steps from `bits` correct bits to
+    // `target_bits`, if each step loses `loss` bits from the doubling.
+    word steps = 0;
+    while (bits < target_bits) {
+        bits = MIN(2*bits - loss, target_bits);
+        steps++;
+    }
+    return steps;
+}
+
+struct Real* reciprocal_with_sig(struct Real* d, ssize_t min_sig_word_idx) {
+    // Computes 1/d with Newton's method, y <- y + y(1 - d y), doubling the
+    // number of correct bits each step. Each step only uses as many words
+    // of `d` and `y` as its precision needs.
+    ssize_t exponent = get_exponent(d);
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+
+    // |1/d| is in (2^-exponent, 2^(1-exponent)], so this is the number of
+    // correct bits we need.
+    ssize_t target_bits = 1 - exponent - min_sig_word_idx*WORD_BITS;
+
+    // Start from a double-precision estimate, good to about 50 bits.
+    struct Real* y = word_times_pow2(get_sign(d),
+                                     (word) ldexp(1.0 / top_as_double(d), 61),
+                                     -exponent - 61);
+    ssize_t bits = 50;
+
+    struct Real* d_trunc;
+    struct Real* e;
+    struct Real* temp;
+    ssize_t y_sig_word_idx;
+    word step = 0;
+    begin_stage("reciprocal Newton step", newton_steps(bits, target_bits, 2));
+    while (bits < target_bits) {
+        if (checkpoint(step++)) {
+            end_stage();
+            free_real(one);
+            free_real(y);
+            return NULL;
+        }
+        bits = MIN(2*bits - 2, target_bits);
+        y_sig_word_idx = floor_div(-exponent - bits, WORD_BITS) - 1;
+
+        d_trunc = view_real(d, floor_div(exponent - bits, WORD_BITS) - 1,
+                            get_max_word_idx(d));
+        e = copy_real(one);
+        fms_with_sig(e, d_trunc, y, floor_div(-bits, WORD_BITS) - 1);
+        // `y` only has words above `y_sig_word_idx`, so this keeps it
+        // truncated there.
+        fma_with_sig(y, y, e, y_sig_word_idx);
+
+        free_real(d_trunc);
+        free_real(e);
+    }
+    end_stage();
+    free_real(one);
+
+    temp = div_with_sig(y, 1, min_sig_word_idx);
+    free_real(y);
+    return temp;
+}
+
+typedef unsigned __int128 dword;
+
+void long_div_words(word* u, ssize_t num_u_words, word* v, ssize_t num_v_words,
+                    word* q) {
+    // Knuth's algorithm D: sets the `num_u_words - num_v_words + 1` words
+    // of `q` to floor(u / v). `v`'s top word must have its top bit set,
+    // and `u` must have a spare 0 word at `num_u_words`. `u` is left
+    // holding the remainder.
+    ssize_t n = num_v_words;
+    ssize_t i, j;
+    for (j = num_u_words - n; j >= 0; j--) {
+        // Estimate the quotient word from the top 2 words of what's left
+        // and the top word of `v`. This is at most 2 too big.
+        dword num = ((dword) u[j + n] << WORD_BITS) | u[j + n - 1];
+        dword q_hat = num / v[n - 1];
+        dword r_hat = num % v[n - 1];
+        while ((q_hat >> WORD_BITS) ||
+               (n >= 2 &&
+                q_hat * v[n - 2] > ((r_hat << WORD_BITS) | u[j + n - 2]))) {
+            q_hat--;
+            r_hat += v[n - 1];
+            if (r_hat >> WORD_BITS) {
+                break;
+            }
+        }
+
+        // Subtract q_hat * v from the top of `u`.
+        word carry = 0, borrow = 0;
+        word sub, diff;
+        dword product;
+        for (i = 0; i <= n; i++) {
+            if (i < n) {
+                product = q_hat * v[i] + carry;
+                carry = (word) (product >> WORD_BITS);
+                sub = (word) product;
+            } else {
+                sub = carry;
+            }
+            diff = u[i + j] - sub - borrow;
+            borrow = (u[i + j] < sub) || (u[i + j] - sub < borrow);
+            u[i + j] = diff;
+        }
+
+        if (borrow) {
+            // q_hat was still 1 too big, so add v back.
+            q_hat--;
+            carry = 0;
+            for (i = 0; i < n; i++) {
+                product = (dword) u[i + j] + v[i] + carry;
+                u[i + j] = (word) product;
+                carry = (word) (product >> WORD_BITS);
+            }
+            u[j + n] += carry;
+        }
+        q[j] = (word) q_hat;
+    }
+}
+
+struct Real* long_div_with_sig(struct Real* r1, struct Real* r2,
+                               ssize_t min_sig_word_idx) {
+    // Divides `r1` by `r2` with schoolbook long division, truncating the
+    // quotient at `min_sig_word_idx`. The result is exact up to that
+    // truncation.
+    enum sign_t sign = (get_sign(r1) == get_sign(r2)) ? POSITIVE : NEGATIVE;
+
+    ssize_t min_v_idx = get_min_word_idx(r2);
+    ssize_t max_v_idx = get_max_word_idx(r2);
+    while (get_word(r2, max_v_idx - 1) == 0) {
+        max_v_idx--;
+    }
+    while (get_word(r2, min_v_idx) == 0) {
+        min_v_idx++;
+    }
+
+    // With r2 = v * 2^(64 * min_v_idx), the quotient words are those of
+    // floor(u / v), where u is `r1` shifted down by
+    // `min_sig_word_idx + min_v_idx` words and truncated.
+    ssize_t u_shift = min_sig_word_idx + min_v_idx;
+    ssize_t num_u_words = get_max_word_idx(r1) - u_shift;
+    ssize_t num_v_words = max_v_idx - min_v_idx;
+    if (num_u_words < num_v_words) {
+        return fill_real(POSITIVE, 0, 1, 0);
+    }
+
+    // Normalize so that the top bit of `v` is set.
+    int norm = __builtin_clzl(get_word(r2, max_v_idx - 1));
+    word* u = malloc((num_u_words + 1) * sizeof(word));
+    word* v = malloc(num_v_words * sizeof(word));
+    word* q = malloc((num_u_words - num_v_words + 1) * sizeof(word));
+    ssize_t i;
+    word w, lower;
+    for (i = 0; i <= num_u_words; i++) {
+        w = (i < num_u_words) ? get_word(r1, i + u_shift) : 0;
+        lower = (i > 0) ? get_word(r1, i - 1 + u_shift) : 0;
+        u[i] = norm ? (w << norm) | (lower >> (WORD_BITS - norm)) : w;
+    }
+    for (i = 0; i < num_v_words; i++) {
+        w = get_word(r2, i + min_v_idx);
+        lower = (i > 0) ? get_word(r2, i - 1 + min_v_idx) : 0;
+        v[i] = norm ? (w << norm) | (lower >> (WORD_BITS - norm)) : w;
+    }
+
+    long_div_words(u, num_u_words, v, num_v_words, q);
+
+    struct Real* rtn = alloc_real(sign, min_sig_word_idx,
+                                  min_sig_word_idx + num_u_words
+                                  - num_v_words + 1);
+    for (i = 0; i <= num_u_words - num_v_words; i++) {
+        set_word(rtn, min_sig_word_idx + i, q[i]);
+    }
+    trim_most_significant_zeros(rtn);
+
+    free(u);
+    free(v);
+    free(q);
+    return rtn;
+}
+
+struct Real* div_real_with_sig(struct Real* r1, struct Real* r2,
+                               ssize_t min_sig_word_idx) {
+    if (is_zero(r2)) {
+        puts("Division by zero!");
+        return NULL;
+    } else if (is_zero(r1)) {
+        return fill_real(POSITIVE, 0, 1, 0);
+    }
+
+    if (get_max_word_idx(r2) - get_min_word_idx(r2)
+        < thresholds.newton_div_min_words) {
+        return long_div_with_sig(r1, r2, min_sig_word_idx);
+    }
+
+    // The error in `1/r2` gets multiplied by `r1`, so we need enough extra
+    // words in the reciprocal to cover the size of `r1`.
+    ssize_t recip_sig_word_idx = floor_div(min_sig_word_idx*WORD_BITS
+                                           - get_exponent(r1),
+                                           WORD_BITS) - 1;
+    struct Real* recip = reciprocal_with_sig(r2, recip_sig_word_idx);
+    if (recip == NULL) {
+        return NULL;
+    }
+    struct Real* q = mul_with_sig(r1, recip, min_sig_word_idx - 1);
+    struct Real* rtn = div_with_sig(q, 1, min_sig_word_idx);
+    trim_most_significant_zeros(rtn);
+    free_real(recip);
+    free_real(q);
+    return rtn;
+}
+
+struct Real* sqrt_with_sig(struct Real* r, ssize_t min_sig_word_idx) {
+    if (is_zero(r)) {
+        return fill_real(POSITIVE, 0, 1, 0);
+    } else if (get_sign(r) == NEGATIVE) {
+        puts("Square root of negative number!");
+        return NULL;
+    }
+
+    // Write r = m * 2^even_exponent with m in [0.25, 1), so that
+    // 1/sqrt(r) = 1/sqrt(m) * 2^(-even_exponent/2).
+    ssize_t exponent = get_exponent(r);
+    double m = top_as_double(r);
+    ssize_t even_exponent = exponent;
+    if (even_exponent & 1) {
+        even_exponent++;
+        m /= 2;
+    }
+    ssize_t half_exponent = even_exponent / 2;
+
+    // Computes z = 1/sqrt(r) with Newton's method,
+    // z <- z + z(1 - r z^2)/2, and then sqrt(r) = r z.
+    // The error in `z` gets multiplied by `r`.
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    ssize_t z_target_sig_word_idx = floor_div(min_sig_word_idx*WORD_BITS
+                                              - exponent,
+                                              WORD_BITS) - 1;
+    ssize_t target_bits = (1 - half_exponent
+                           - z_target_sig_word_idx*WORD_BITS);
+
+    struct Real* z = word_times_pow2(POSITIVE,
+                                     (word) ldexp(1.0 / sqrt(m), 61),
+                                     -half_exponent - 61);
+    ssize_t bits = 50;
+
+    struct Real* r_trunc;
+    struct Real* z_squared;
+    struct Real* e;
+    struct Real* half_e;
+    ssize_t z_sig_word_idx;
+    word step = 0;
+    begin_stage("sqrt Newton step", newton_steps(bits, target_bits, 3));
+    while (bits < target_bits) {
+        if (checkpoint(step++)) {
+            end_stage();
+            free_real(one);
+            free_real(z);
+            return NULL;
+        }
+        bits = MIN(2*bits - 3, target_bits);
+        z_sig_word_idx = floor_div(-half_exponent - bits, WORD_BITS) - 1;
+
+        r_trunc = view_real(r, floor_div(exponent - bits, WORD_BITS) - 1,
+                            get_max_word_idx(r));
+        z_squared = mul_with_sig(z, z,
+                                 floor_div(-even_exponent - bits,
+                                           WORD_BITS) - 2);
+        trim_most_significant_zeros(z_squared);
+        e = copy_real(one);
+        fms_with_sig(e, r_trunc, z_squared, floor_div(-bits, WORD_BITS) - 1);
+        half_e = shift_right_bits(e, 1);
+        // `z` only has words above `z_sig_word_idx`, so this keeps it
+        // truncated there.
+        fma_with_sig(z, z, half_e, z_sig_word_idx);
+
+        free_real(r_trunc);
+        free_real(z_squared);
+        free_real(e);
+        free_real(half_e);
+    }
+    end_stage();
+    free_real(one);
+
+    struct Real* s = mul_with_sig(r, z, min_sig_word_idx - 1);
+    struct Real* rtn = div_with_sig(s, 1, min_sig_word_idx);
+    trim_most_significant_zeros(rtn);
+    free_real(s);
+    free_real(z);
+    return rtn;
+}
+
 void negate(struct Real* r) {
     if (get_sign(r) == POSITIVE) {
         set_sign(r, NEGATIVE);
@@ -294,3 +1109,140 @@ int is_zero(struct Real* r) {
     }
     return rtn;
 }
+
+ssize_t get_exponent(struct Real* r) {
+    ssize_t word_idx;
+    word w;
+    for (word_idx = get_max_word_idx(r) - 1;
+         word_idx >= get_min_word_idx(r);
+         word_idx--) {
+        w = get_word(r, word_idx);
+        if (w != 0) {
+            return word_idx*WORD_BITS + WORD_BITS - __builtin_clzl(w);
+        }
+    }
+    return 0;
+}
+
+struct Real* pow_mul(struct Real* r1, struct Real* r2, int exact,
+                     ssize_t min_sig_word_idx) {
+    struct Real* rtn;
+    if (exact) {
+        rtn = multiply(r1, r2);
+    } else {
+        rtn = mul_with_sig(r1, r2, min_sig_word_idx);
+    }
+    trim_zeros(rtn);
+    return rtn;
+}
+
+struct Real* sliding_window_pow(struct Real* r, word e, int exact,
+                                ssize_t min_sig_word_idx) {
+    // Computes r^e with left-to-right sliding-window exponentiation: scan
+    // the bits of `e` from the top, squaring once per bit and multiplying
+    // by a precomputed odd power r^u once per window of up to `w` bits
+    // ending in a 1. This takes about log2(e) squarings and
+    // log2(e) / (w + 1) other products.
+    if (e == 0) {
+        return fill_real(POSITIVE, 0, 1, 1);
+    }
+
+    int num_bits = WORD_BITS - __builtin_clzl(e);
+    int w = 1;
+    if (num_bits > 240) {
+        w = 5;
+    } else if (num_bits > 80) {
+        w = 4;
+    } else if (num_bits > 24) {
+        w = 3;
+    } else if (num_bits > 6) {
+        w = 2;
+    }
+
+    // odd_powers[i] = r^(2i + 1)
+    struct Real* odd_powers[1 << 4];
+    int num_odd_powers = 1 << (w - 1);
+    odd_powers[0] = copy_real(r);
+    trim_zeros(odd_powers[0]);
+    int i;
+    if (num_odd_powers > 1) {
+        struct Real* r_squared = pow_mul(r, r, exact, min_sig_word_idx);
+        for (i = 1; i < num_odd_powers; i++) {
+            odd_powers[i] = pow_mul(odd_powers[i - 1], r_squared,
+                                    exact, min_sig_word_idx);
+        }
+        free_real(r_squared);
+    }
+
+    struct Real* rtn = NULL;
+    struct Real* temp;
+    int bit_idx = num_bits - 1;
+    int low_bit_idx;
+    word window;
+    while (bit_idx >= 0) {
+        if (((e >> bit_idx) & 1) == 0) {
+            temp = pow_mul(rtn, rtn, exact, min_sig_word_idx);
+            free_real(rtn);
+            rtn = temp;
+            bit_idx--;
+            continue;
+        }
+
+        // Take the longest window of at most `w` bits that ends in a 1.
+        low_bit_idx = MAX(bit_idx - w + 1, 0);
+        while (((e >> low_bit_idx) & 1) == 0) {
+            low_bit_idx++;
+        }
+        window = (e >> low_bit_idx) & (((word) 1 << (bit_idx - low_bit_idx
+                                                      + 1)) - 1);
+
+        if (rtn == NULL) {
+            rtn = copy_real(odd_powers[window / 2]);
+        } else {
+            for (i = 0; i < bit_idx - low_bit_idx + 1; i++) {
+                temp = pow_mul(rtn, rtn, exact, min_sig_word_idx);
+                free_real(rtn);
+                rtn = temp;
+            }
+            temp = pow_mul(rtn, odd_powers[window / 2], exact,
+                           min_sig_word_idx);
+            free_real(rtn);
+            rtn = temp;
+        }
+        bit_idx = low_bit_idx - 1;
+    }
+
+    for (i = 0; i < num_odd_powers; i++) {
+        free_real(odd_powers[i]);
+    }
+    return rtn;
+}
+
+struct Real* pow_word(word base, word e) {
+    struct Real* r = fill_real(POSITIVE, 0, 1, base);
+    struct Real* rtn = sliding_window_pow(r, e, 1, 0);
+    free_real(r);
+    return rtn;
+}
+
+struct Real* pow_real(struct Real* r, word e, ssize_t min_sig_word_idx) {
+    if (e == 0) {
+        return fill_real(POSITIVE, 0, 1, 1);
+    }
+
+    // The truncation error of each product is multiplied by about
+    // e |r|^(e-1) by the time it reaches the result, so work with enough
+    // extra words to cover that.
+    ssize_t growth_bits = WORD_BITS - __builtin_clzl(e);
+    if (get_exponent(r) > 0) {
+        growth_bits += (e - 1) * get_exponent(r);
+    }
+    ssize_t work = (min_sig_word_idx
+                    - (growth_bits + WORD_BITS - 1) / WORD_BITS - 1);
+
+    struct Real* p = sliding_window_pow(r, e, 0, work);
+    struct Real* rtn = div_with_sig(p, 1, min_sig_word_idx);
+    trim_most_significant_zeros(rtn);
+    free_real(p);
+    return rtn;
+}
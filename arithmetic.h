@@ -2,16 +2,83 @@
 #define ARITHMETIC_H
 
 #include "real.h"
+#include "thresholds.h"
+
+// Additions and subtractions of at least
+// `thresholds.parallel_add_min_words` words are split into blocks that
+// are added on up to `parallel_add_threads` threads (0 means one per
+// CPU). The results are the same either way.
+#define MAX_ADD_THREADS 64
+extern int parallel_add_threads;
 
 struct Real* add(struct Real* r1, struct Real* r2);
 struct Real* subtract(struct Real* r1, struct Real* r2);
 struct Real* multiply(struct Real* r1, struct Real* r2);
 
+// Add or subtract `r` into `acc` in-place.
+//
+// `acc` grows to cover the words of `r` (plus a carry), but it only
+// reallocates when its buffer runs out of room, so accumulating many
+// terms into the same struct Real doesn't allocate for each one.
+// `r` may be `acc` itself.
+void add_to(struct Real* acc, struct Real* r);
+void subtract_from(struct Real* acc, struct Real* r);
+
+// Fused multiply-add and multiply-subtract: acc += r1 * r2 and
+// acc -= r1 * r2, in-place.
+//
+// The product is the same as `mul_with_sig`'s. When either operand is
+// shorter than `thresholds.karatsuba_min_words`, it's accumulated
+// straight into `acc` without being stored anywhere else; longer ones
+// are multiplied with Karatsuba and then added in. Words of `acc` below
+// `min_sig_word_idx` are kept. `r1` and `r2` may be `acc` itself.
+void fma_with_sig(struct Real* acc, struct Real* r1, struct Real* r2,
+                  ssize_t min_sig_word_idx);
+void fms_with_sig(struct Real* acc, struct Real* r1, struct Real* r2,
+                  ssize_t min_sig_word_idx);
+
+// acc += alpha * x exactly, in-place. `x` may be `acc` itself.
+void axpy(struct Real* acc, word alpha, struct Real* x);
+
 struct Real* mul_with_sig(struct Real* r1, struct Real* r2,
                           ssize_t min_sig_word_idx);
+
+// `divisor` must be below 2^32, since the quotient is worked out a
+// half-word at a time and each remainder has to fit in a half-word. Use
+// `div_real_with_sig` for larger divisors.
 struct Real* div_with_sig(struct Real* r, word divisor,
                           ssize_t min_sig_word_idx);
 
+// r = r / divisor in-place, with the same result as `div_with_sig`, so
+// `divisor` must be below 2^32 here too. This only reallocates if `r`
+// has to grow down to `min_sig_word_idx` and its buffer has no room
+// there.
+void divide_by_word(struct Real* r, word divisor, ssize_t min_sig_word_idx);
+
+// Divides `r1` by `r2` using Newton's method for the reciprocal of `r2`,
+// or long division if `r2` is shorter than
+// `thresholds.newton_div_min_words`.
+//
+// The result is accurate to within a few units of the word at
+// `min_sig_word_idx`. Returns NULL if `r2` is 0, or if the computation
+// is cancelled (see progress.h).
+struct Real* div_real_with_sig(struct Real* r1, struct Real* r2,
+                               ssize_t min_sig_word_idx);
+
+// Divides `r1` by a non-zero `r2` with schoolbook long division. The
+// quotient is truncated towards 0 at `min_sig_word_idx`, but is otherwise
+// exact, so this divides integers exactly.
+struct Real* long_div_with_sig(struct Real* r1, struct Real* r2,
+                               ssize_t min_sig_word_idx);
+
+// Computes the square root of `r` using Newton's method for the inverse
+// square root.
+//
+// The result is accurate to within a few units of the word at
+// `min_sig_word_idx`. Returns NULL if `r` is negative, or if the
+// computation is cancelled.
+struct Real* sqrt_with_sig(struct Real* r, ssize_t min_sig_word_idx);
+
 struct Real* mul_with_rel_sig(struct Real* r1, struct Real* r2,
                               int num_sig_words);
 struct Real* div_with_rel_sig(struct Real* r, word divisor,
@@ -23,4 +90,31 @@ int greater_abs(struct Real* r1, struct Real* r2);
 
 int is_zero(struct Real* r);
 
+// Return r * 2^num_bits and r / 2^num_bits exactly. `num_bits` may be
+// negative. These are O(n) funnel shifts rather than multiplies; use
+// `shift_words` to shift by whole words in O(1).
+struct Real* shift_left_bits(struct Real* r, ssize_t num_bits);
+struct Real* shift_right_bits(struct Real* r, ssize_t num_bits);
+
+// Returns base^e exactly.
+//
+// Both this and `pow_real` use left-to-right sliding-window
+// exponentiation, so they take O(log e) products.
+struct Real* pow_word(word base, word e);
+
+// Returns r^e, accurate to within a few units of the word at
+// `min_sig_word_idx`.
+struct Real* pow_real(struct Real* r, word e, ssize_t min_sig_word_idx);
+
+// Returns (+/-) w * 2^bit_idx exactly.
+struct Real* word_times_pow2(enum sign_t sign, word w, ssize_t bit_idx);
+
+// Returns |r| / 2^get_exponent(r), which is in [0.5, 1), computed from
+// the top 2 words of `r`. This is for seeding iterative methods.
+double top_as_double(struct Real* r);
+
+// Returns the exponent of `r`: the value `e` such that
+// 2^(e-1) <= |r| < 2^e. The exponent of 0 is defined as 0.
+ssize_t get_exponent(struct Real* r);
+
 #endif
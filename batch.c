@@ -0,0 +1,355 @@
+#include "batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "real.h"
+
+
+// The kernels go through the numbers this many at a time, so the
+// per-number carries stay in L1.
+#define BATCH_BLOCK 256
+
+typedef unsigned __int128 dword;
+
+struct RealBatch {
+    size_t count;
+    ssize_t min_word_idx;
+    ssize_t max_word_idx;
+    // The word at index `word_idx` of number `i` is at
+    // `(word_idx - min_word_idx) * count + i`.
+    word* words;
+};
+
+struct RealBatch* alloc_batch(size_t count, ssize_t min_word_idx,
+                              ssize_t max_word_idx) {
+    if (max_word_idx <= min_word_idx || count == 0) {
+        puts("Trying to alloc an empty batch!");
+        return NULL;
+    }
+    struct RealBatch* b = malloc(sizeof(struct RealBatch));
+    b->count = count;
+    b->min_word_idx = min_word_idx;
+    b->max_word_idx = max_word_idx;
+    b->words = calloc((max_word_idx - min_word_idx) * count, sizeof(word));
+    return b;
+}
+
+void free_batch(struct RealBatch* b) {
+    free(b->words);
+    free(b);
+}
+
+size_t get_batch_count(struct RealBatch* b) {
+    return b->count;
+}
+
+ssize_t batch_num_words(struct RealBatch* b) {
+    return b->max_word_idx - b->min_word_idx;
+}
+
+word* batch_row(struct RealBatch* b, ssize_t k) {
+    // Returns the `k`th word from the bottom of all of the numbers.
+    return b->words + k * b->count;
+}
+
+int check_batches(struct RealBatch* a, struct RealBatch* b) {
+    if (a->count != b->count ||
+        a->min_word_idx != b->min_word_idx ||
+        a->max_word_idx != b->max_word_idx) {
+        puts("Batches don't match!");
+        return -1;
+    }
+    return 0;
+}
+
+int set_batch_real(struct RealBatch* b, size_t i, struct Real* r) {
+    if (i >= b->count) {
+        return -1;
+    }
+    // The top bit of the batch's top word is the sign.
+    ssize_t word_idx;
+    for (word_idx = b->max_word_idx; word_idx < get_max_word_idx(r);
+         word_idx++) {
+        if (get_word(r, word_idx) != 0) {
+            return -1;
+        }
+    }
+    if (get_word(r, b->max_word_idx - 1) >> (WORD_BITS - 1)) {
+        return -1;
+    }
+
+    // Negating in two's complement is inverting and adding 1.
+    word mask = (get_sign(r) == NEGATIVE) ? ~((word) 0) : 0;
+    word carry = mask & 1;
+    word w;
+    ssize_t k;
+    for (k = 0; k < batch_num_words(b); k++) {
+        w = (get_word(r, b->min_word_idx + k) ^ mask) + carry;
+        carry = (w < carry);
+        batch_row(b, k)[i] = w;
+    }
+    return 0;
+}
+
+struct Real* get_batch_real(struct RealBatch* b, size_t i) {
+    ssize_t n = batch_num_words(b);
+    word mask = (batch_row(b, n - 1)[i] >> (WORD_BITS - 1)) ? ~((word) 0) : 0;
+    struct Real* r = alloc_real(mask ? NEGATIVE : POSITIVE,
+                                b->min_word_idx, b->max_word_idx);
+    word carry = mask & 1;
+    word w;
+    ssize_t k;
+    for (k = 0; k < n; k++) {
+        w = (batch_row(b, k)[i] ^ mask) + carry;
+        carry = (w < carry);
+        set_word(r, b->min_word_idx + k, w);
+    }
+    return r;
+}
+
+
+// The kernels. Each one goes through the numbers a block at a time, and
+// through a block's words from the bottom up, with the numbers in the
+// innermost loop.
+//
+// Baseline x86-64 (SSE2) has no 64-bit compares, so the carries are
+// worked out from the top bits of the operands and the result instead of
+// with `<`, which leaves the inner loops vectorizable everywhere.
+
+word carry_out(word x, word y, word s) {
+    // The carry out of s = x + y + c, for a carry c of 0 or 1.
+    return ((x & y) | ((x | y) & ~s)) >> (WORD_BITS - 1);
+}
+
+word borrow_out(word x, word y, word d) {
+    // The borrow out of d = x - y - b, for a borrow b of 0 or 1.
+    return ((~x & y) | (~(x ^ y) & d)) >> (WORD_BITS - 1);
+}
+
+int add_or_subtract_batches(struct RealBatch* s, struct RealBatch* a,
+                            struct RealBatch* b, int subtracting) {
+    if (check_batches(s, a) != 0 || check_batches(a, b) != 0) {
+        return -1;
+    }
+    size_t count = a->count;
+    word carries[BATCH_BLOCK];
+    size_t start, end, i;
+    ssize_t k;
+    word* x;
+    word* y;
+    word* z;
+    word w;
+    for (start = 0; start < count; start += BATCH_BLOCK) {
+        end = MIN(start + BATCH_BLOCK, count);
+        memset(carries, 0, sizeof(carries));
+        for (k = 0; k < batch_num_words(a); k++) {
+            x = batch_row(a, k);
+            y = batch_row(b, k);
+            z = batch_row(s, k);
+            if (subtracting) {
+                for (i = start; i < end; i++) {
+                    w = x[i] - y[i] - carries[i - start];
+                    carries[i - start] = borrow_out(x[i], y[i], w);
+                    z[i] = w;
+                }
+            } else {
+                for (i = start; i < end; i++) {
+                    w = x[i] + y[i] + carries[i - start];
+                    carries[i - start] = carry_out(x[i], y[i], w);
+                    z[i] = w;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int batch_add(struct RealBatch* s, struct RealBatch* a, struct RealBatch* b) {
+    return add_or_subtract_batches(s, a, b, 0);
+}
+
+int batch_subtract(struct RealBatch* d, struct RealBatch* a,
+                   struct RealBatch* b) {
+    return add_or_subtract_batches(d, a, b, 1);
+}
+
+int batch_mul_word(struct RealBatch* p, struct RealBatch* a, word w) {
+    // Multiplying modulo 2^(64 n) works the same for two's complement
+    // numbers as for unsigned ones.
+    if (check_batches(p, a) != 0) {
+        return -1;
+    }
+    size_t count = a->count;
+    word carries[BATCH_BLOCK];
+    size_t start, end, i;
+    ssize_t k;
+    word* x;
+    word* z;
+    dword t;
+    for (start = 0; start < count; start += BATCH_BLOCK) {
+        end = MIN(start + BATCH_BLOCK, count);
+        memset(carries, 0, sizeof(carries));
+        for (k = 0; k < batch_num_words(a); k++) {
+            x = batch_row(a, k);
+            z = batch_row(p, k);
+            for (i = start; i < end; i++) {
+                t = (dword) x[i] * w + carries[i - start];
+                z[i] = (word) t;
+                carries[i - start] = (word) (t >> WORD_BITS);
+            }
+        }
+    }
+    return 0;
+}
+
+void negate_rows(word* dst, word* src, size_t src_stride, ssize_t num_words,
+                 size_t block_size, unsigned char* negative) {
+    // Copies `num_words` rows of `block_size` numbers, `src_stride` apart
+    // in `src`, to consecutive rows of `dst`, negating the numbers that
+    // are `negative`.
+    word carries[BATCH_BLOCK];
+    word masks[BATCH_BLOCK];
+    word v, w;
+    size_t i;
+    ssize_t k;
+    for (i = 0; i < block_size; i++) {
+        carries[i] = negative[i];
+        masks[i] = -(word) negative[i];
+    }
+    for (k = 0; k < num_words; k++) {
+        for (i = 0; i < block_size; i++) {
+            v = src[k*src_stride + i] ^ masks[i];
+            w = v + carries[i];
+            carries[i] = carry_out(v, 0, w);
+            dst[k*block_size + i] = w;
+        }
+    }
+}
+
+int batch_multiply(struct RealBatch* p, struct RealBatch* a,
+                   struct RealBatch* b) {
+    // The magnitudes are multiplied in full, and the words of the product
+    // in the batches' range are kept.
+    if (check_batches(p, a) != 0 || check_batches(a, b) != 0) {
+        return -1;
+    }
+    size_t count = a->count;
+    ssize_t n = batch_num_words(a);
+    // The word at index 2 `min_word_idx` + j of the full product is
+    // `product[j]`, so the word at `min_word_idx` + k is
+    // `product[k - min_word_idx]`.
+    ssize_t offset = -a->min_word_idx;
+
+    word* magnitude_a = malloc(n * BATCH_BLOCK * sizeof(word));
+    word* magnitude_b = malloc(n * BATCH_BLOCK * sizeof(word));
+    word* product = malloc(2 * n * BATCH_BLOCK * sizeof(word));
+    unsigned char negative_a[BATCH_BLOCK];
+    unsigned char negative_b[BATCH_BLOCK];
+    word carries[BATCH_BLOCK];
+
+    size_t start, size, i;
+    ssize_t ka, kb, k;
+    word* x;
+    word* y;
+    word* z;
+    dword t;
+    for (start = 0; start < count; start += BATCH_BLOCK) {
+        size = MIN(BATCH_BLOCK, count - start);
+        x = batch_row(a, n - 1) + start;
+        y = batch_row(b, n - 1) + start;
+        for (i = 0; i < size; i++) {
+            negative_a[i] = x[i] >> (WORD_BITS - 1);
+            negative_b[i] = y[i] >> (WORD_BITS - 1);
+        }
+        negate_rows(magnitude_a, a->words + start, count, n, size,
+                    negative_a);
+        negate_rows(magnitude_b, b->words + start, count, n, size,
+                    negative_b);
+
+        memset(product, 0, 2 * n * size * sizeof(word));
+        for (ka = 0; ka < n; ka++) {
+            memset(carries, 0, sizeof(carries));
+            x = magnitude_a + ka*size;
+            for (kb = 0; kb < n; kb++) {
+                y = magnitude_b + kb*size;
+                z = product + (ka + kb)*size;
+                for (i = 0; i < size; i++) {
+                    t = (dword) x[i] * y[i] + z[i] + carries[i];
+                    z[i] = (word) t;
+                    carries[i] = (word) (t >> WORD_BITS);
+                }
+            }
+            z = product + (ka + n)*size;
+            for (i = 0; i < size; i++) {
+                z[i] = carries[i];
+            }
+        }
+
+        // Move the kept words to the front, in the order that doesn't
+        // overwrite any before they're moved, then put the signs back on.
+        for (ka = 0; ka < n; ka++) {
+            k = (offset >= 0) ? ka : n - 1 - ka;
+            z = product + k*size;
+            if (k + offset >= 0 && k + offset < 2*n) {
+                memmove(z, product + (k + offset)*size, size * sizeof(word));
+            } else {
+                memset(z, 0, size * sizeof(word));
+            }
+        }
+        for (i = 0; i < size; i++) {
+            negative_a[i] ^= negative_b[i];
+        }
+        negate_rows(magnitude_a, product, size, n, size, negative_a);
+        for (k = 0; k < n; k++) {
+            memcpy(batch_row(p, k) + start, magnitude_a + k*size,
+                   size * sizeof(word));
+        }
+    }
+
+    free(magnitude_a);
+    free(magnitude_b);
+    free(product);
+    return 0;
+}
+
+int batch_compare(int* results, struct RealBatch* a, struct RealBatch* b) {
+    if (check_batches(a, b) != 0) {
+        return -1;
+    }
+    size_t count = a->count;
+    ssize_t n = batch_num_words(a);
+    // -1, 0 or 1 so far, as a word.
+    word order[BATCH_BLOCK];
+    size_t start, end, i;
+    ssize_t k;
+    word* x;
+    word* y;
+    word flip, undecided;
+    for (start = 0; start < count; start += BATCH_BLOCK) {
+        end = MIN(start + BATCH_BLOCK, count);
+        memset(order, 0, sizeof(order));
+        // From the top word down, since the lower words only matter when
+        // the ones above them are equal. Flipping the sign bit of the top
+        // words lets them be compared as unsigned.
+        for (k = n - 1; k >= 0; k--) {
+            x = batch_row(a, k);
+            y = batch_row(b, k);
+            flip = (k == n - 1) ? (word) 1 << (WORD_BITS - 1) : 0;
+            for (i = start; i < end; i++) {
+                undecided = ((order[i - start] | -order[i - start])
+                             >> (WORD_BITS - 1)) - 1;
+                order[i - start] |= undecided
+                    & (borrow_out(y[i] ^ flip, x[i] ^ flip,
+                                  (y[i] ^ flip) - (x[i] ^ flip))
+                       - borrow_out(x[i] ^ flip, y[i] ^ flip,
+                                    (x[i] ^ flip) - (y[i] ^ flip)));
+            }
+        }
+        for (i = start; i < end; i++) {
+            results[i] = (int) order[i - start];
+        }
+    }
+    return 0;
+}
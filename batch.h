@@ -0,0 +1,54 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "real.h"
+
+// Batches of many numbers with the same range of word indices, for
+// running one operation over all of them at once.
+//
+// The words are stored in structure-of-arrays order: all of the numbers'
+// words at the bottom index, then all of their words at the next index,
+// and so on. Numbers are fixed-point two's complement, so the top bit of
+// the top word is the sign, and adding and subtracting are the same
+// carry chain for every number. The kernels run that chain for a block
+// of numbers at a time with the numbers in the inner loop, and none of
+// them allocate per number. batch.o is built with -O3, at which the add,
+// subtract, negate and compare loops vectorize with plain SSE2; the word
+// multiplies need a 128-bit product, so they stay scalar.
+//
+// Results are truncated towards 0 at the bottom word, and anything that
+// doesn't fit in the range wraps around like an integer overflow. All of
+// the batches in an operation must have the same size and range, and a
+// result may be one of the operands.
+
+struct RealBatch;
+
+// Returns `count` zeros with words at indices in
+// [`min_word_idx`, `max_word_idx`).
+struct RealBatch* alloc_batch(size_t count, ssize_t min_word_idx,
+                              ssize_t max_word_idx);
+
+void free_batch(struct RealBatch* b);
+
+size_t get_batch_count(struct RealBatch* b);
+
+// Sets number `i` to `r`, dropping its words below the batch's range.
+// Returns -1, leaving number `i` as it was, if `r` doesn't fit.
+int set_batch_real(struct RealBatch* b, size_t i, struct Real* r);
+
+// Returns a copy of number `i`.
+struct Real* get_batch_real(struct RealBatch* b, size_t i);
+
+// These all return 0 on success and -1 if the batches don't match.
+int batch_add(struct RealBatch* s, struct RealBatch* a, struct RealBatch* b);
+int batch_subtract(struct RealBatch* d, struct RealBatch* a,
+                   struct RealBatch* b);
+int batch_mul_word(struct RealBatch* p, struct RealBatch* a, word w);
+int batch_multiply(struct RealBatch* p, struct RealBatch* a,
+                   struct RealBatch* b);
+
+// Sets `results[i]` to -1, 0 or 1 as number `i` of `a` is less than,
+// equal to or greater than number `i` of `b`.
+int batch_compare(int* results, struct RealBatch* a, struct RealBatch* b);
+
+#endif
@@ -0,0 +1,119 @@
+#include "bbp.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "real.h"
+
+
+#define MAX_BBP_THREADS 64
+
+typedef unsigned __int128 dword;
+
+word mul_mod(word a, word b, word m) {
+    return (word) (((dword) a * b) % m);
+}
+
+word pow16_mod(word e, word m) {
+    // Returns 16^e mod m.
+    word result = 1 % m;
+    word base = 16 % m;
+    while (e > 0) {
+        if (e & 1) {
+            result = mul_mod(result, base, m);
+        }
+        base = mul_mod(base, base, m);
+        e >>= 1;
+    }
+    return result;
+}
+
+dword fraction_128(word num, word den) {
+    // Returns num / den as a 128-bit fixed-point fraction, for num < den.
+    dword high = ((dword) num << 64) / den;
+    dword rem = ((dword) num << 64) % den;
+    dword low = (rem << 64) / den;
+    return (high << 64) | low;
+}
+
+dword bbp_series(word n, word j) {
+    // Returns the fractional part of sum_k 16^(n-k) / (8k+j), as a 128-bit
+    // fixed-point fraction.
+    //
+    // For k <= n, only 16^(n-k) mod (8k+j) matters to the fractional part.
+    // Past that, the terms shrink by 16 each, so 32 of them are enough.
+    dword sum = 0;
+    word k;
+    word m;
+    for (k = 0; k <= n; k++) {
+        m = 8*k + j;
+        sum += fraction_128(pow16_mod(n - k, m), m);
+    }
+    int shift;
+    for (shift = 124; shift > 0; shift -= 4) {
+        m = 8*k + j;
+        sum += ((dword) 1 << shift) / m;
+        k++;
+    }
+    return sum;
+}
+
+word pi_hex_word(word position) {
+    // Everything wraps modulo 1, so the integer parts just fall off.
+    dword frac = 4*bbp_series(position, 1) - 2*bbp_series(position, 4)
+        - bbp_series(position, 5) - bbp_series(position, 6);
+    return (word) (frac >> 64);
+}
+
+struct BBPJob {
+    word position;
+    size_t num_digits;
+    int thread_idx;
+    int num_threads;
+    char* digits;
+};
+
+void* pi_hex_digits_thread(void* arg) {
+    struct BBPJob* job = arg;
+
+    // Threads take every `num_threads`th word so they all get a similar
+    // mix of cheap and expensive positions.
+    size_t word_idx, digit_idx;
+    char hex[17];
+    for (word_idx = job->thread_idx; 16*word_idx < job->num_digits;
+         word_idx += job->num_threads) {
+        snprintf(hex, sizeof(hex), "%016lx",
+                 pi_hex_word(job->position + 16*word_idx));
+        for (digit_idx = 0;
+             digit_idx < 16 && 16*word_idx + digit_idx < job->num_digits;
+             digit_idx++) {
+            job->digits[16*word_idx + digit_idx] = hex[digit_idx];
+        }
+    }
+    return NULL;
+}
+
+void pi_hex_digits(word position, size_t num_digits, int num_threads,
+                   char* digits) {
+    if (num_threads <= 0) {
+        num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    num_threads = MAX(1, MIN(num_threads, MAX_BBP_THREADS));
+
+    struct BBPJob jobs[MAX_BBP_THREADS];
+    pthread_t threads[MAX_BBP_THREADS];
+    int i;
+    for (i = 0; i < num_threads; i++) {
+        jobs[i].position = position;
+        jobs[i].num_digits = num_digits;
+        jobs[i].thread_idx = i;
+        jobs[i].num_threads = num_threads;
+        jobs[i].digits = digits;
+        pthread_create(&threads[i], NULL, pi_hex_digits_thread, &jobs[i]);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    digits[num_digits] = 0;
+}
@@ -0,0 +1,29 @@
+#ifndef BBP_H
+#define BBP_H
+
+#include "real.h"
+
+// Hex digits of pi from the Bailey-Borwein-Plouffe formula,
+//
+//   pi = sum_k 16^-k (4/(8k+1) - 2/(8k+4) - 1/(8k+5) - 1/(8k+6)),
+//
+// which gives the digits at any position without computing the ones
+// before it, in O(n log n) time and O(1) memory. This is meant for
+// spot-checking the tail of a long computation against `print_real`.
+
+// Returns the 16 hex digits of pi starting `position` digits after the
+// hexadecimal point, so position 0 gives 0x243f6a8885a308d3.
+//
+// The sums are kept to 128 bits, and each of their terms is truncated,
+// so at position n the result can be off by up to 8(n + 32) 2^-128,
+// which is about 2^-85 at position 2^40. The digits are exact unless
+// the 64 bits that follow them are within that of a carry.
+word pi_hex_word(word position);
+
+// Writes `num_digits` hex digits of pi, starting `position` digits after
+// the hexadecimal point, to `digits` followed by a 0. The 16-digit words
+// are spread across `num_threads` threads (0 means one per CPU).
+void pi_hex_digits(word position, size_t num_digits, int num_threads,
+                   char* digits);
+
+#endif
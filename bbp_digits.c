@@ -0,0 +1,27 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bbp.h"
+
+// Prints hex digits of pi starting at a given position after the
+// hexadecimal point, e.g. to check the tail of `newton_pi`'s output:
+//
+//   bbp_digits <position> [num_digits] [num_threads]
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 4) {
+        puts("usage: bbp_digits <position> [num_digits] [num_threads]");
+        return 1;
+    }
+
+    word position = strtoul(argv[1], NULL, 0);
+    size_t num_digits = (argc > 2) ? strtoul(argv[2], NULL, 0) : 16;
+    int num_threads = (argc > 3) ? atoi(argv[3]) : 0;
+
+    char* digits = malloc(num_digits + 1);
+    pi_hex_digits(position, num_digits, num_threads, digits);
+    printf("%s\n", digits);
+    free(digits);
+
+    return 0;
+}
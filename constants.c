@@ -0,0 +1,181 @@
+#include "constants.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "exp_log.h"
+
+
+#define CACHE_FILE_MAGIC "RCONST01"
+
+
+struct CachedConstant {
+    pthread_mutex_t lock;
+    // NULL if nothing has been computed yet.
+    struct Real* value;
+    ssize_t min_sig_word_idx;
+};
+
+struct CachedConstant constant_cache[NUM_CONSTANTS] = {
+    {PTHREAD_MUTEX_INITIALIZER, NULL, 1},
+    {PTHREAD_MUTEX_INITIALIZER, NULL, 1},
+    {PTHREAD_MUTEX_INITIALIZER, NULL, 1},
+};
+
+struct Real* compute_constant(enum constant_t c, ssize_t min_sig_word_idx) {
+    struct Real* rtn = NULL;
+    struct Real* one;
+    switch (c) {
+    case CONSTANT_PI:
+        rtn = pi_with_sig(min_sig_word_idx);
+        break;
+    case CONSTANT_LN2:
+        rtn = ln2_with_sig(min_sig_word_idx);
+        break;
+    case CONSTANT_E:
+        one = fill_real(POSITIVE, 0, 1, 1);
+        rtn = exp_with_sig(one, min_sig_word_idx);
+        free_real(one);
+        break;
+    default:
+        break;
+    }
+    return rtn;
+}
+
+struct Real* get_constant(enum constant_t c, ssize_t min_sig_word_idx) {
+    struct CachedConstant* entry = &constant_cache[c];
+
+    // Holding the lock while computing means concurrent requests for the
+    // same constant wait for one computation instead of all doing it.
+    pthread_mutex_lock(&entry->lock);
+    if (entry->value == NULL || entry->min_sig_word_idx > min_sig_word_idx) {
+        ssize_t new_sig_word_idx = min_sig_word_idx;
+        if (entry->value != NULL) {
+            new_sig_word_idx = MIN(min_sig_word_idx,
+                                   2*entry->min_sig_word_idx);
+        }
+        struct Real* value = compute_constant(c, new_sig_word_idx);
+        if (value == NULL) {
+            // The computation was cancelled, so keep what we had.
+            pthread_mutex_unlock(&entry->lock);
+            return NULL;
+        }
+        if (entry->value != NULL) {
+            free_real(entry->value);
+        }
+        entry->value = value;
+        entry->min_sig_word_idx = new_sig_word_idx;
+    }
+    struct Real* rtn = div_with_sig(entry->value, 1, min_sig_word_idx);
+    pthread_mutex_unlock(&entry->lock);
+
+    return rtn;
+}
+
+ssize_t get_constant_precision(enum constant_t c) {
+    struct CachedConstant* entry = &constant_cache[c];
+    pthread_mutex_lock(&entry->lock);
+    ssize_t rtn = entry->min_sig_word_idx;
+    pthread_mutex_unlock(&entry->lock);
+    return rtn;
+}
+
+void clear_constant_cache(void) {
+    int c;
+    for (c = 0; c < NUM_CONSTANTS; c++) {
+        pthread_mutex_lock(&constant_cache[c].lock);
+        if (constant_cache[c].value != NULL) {
+            free_real(constant_cache[c].value);
+            constant_cache[c].value = NULL;
+        }
+        constant_cache[c].min_sig_word_idx = 1;
+        pthread_mutex_unlock(&constant_cache[c].lock);
+    }
+}
+
+// The cache file is the magic string, followed by an entry for each
+// stored constant: its id and `min_sig_word_idx` as 64-bit integers and
+// then the value in the `write_real` format.
+
+int save_constant_cache(char* path) {
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) {
+        return -1;
+    }
+
+    int rtn = 0;
+    if (fwrite(CACHE_FILE_MAGIC, 1, strlen(CACHE_FILE_MAGIC), f)
+        != strlen(CACHE_FILE_MAGIC)) {
+        rtn = -1;
+    }
+
+    int c;
+    int64_t header[2];
+    for (c = 0; c < NUM_CONSTANTS && rtn == 0; c++) {
+        pthread_mutex_lock(&constant_cache[c].lock);
+        if (constant_cache[c].value != NULL) {
+            header[0] = c;
+            header[1] = constant_cache[c].min_sig_word_idx;
+            if (fwrite(header, sizeof(int64_t), 2, f) != 2 ||
+                write_real(f, constant_cache[c].value) != 0) {
+                rtn = -1;
+            }
+        }
+        pthread_mutex_unlock(&constant_cache[c].lock);
+    }
+
+    if (fclose(f) != 0) {
+        rtn = -1;
+    }
+    return rtn;
+}
+
+int load_constant_cache(char* path) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return -1;
+    }
+
+    char magic[sizeof(CACHE_FILE_MAGIC)] = {0};
+    if (fread(magic, 1, strlen(CACHE_FILE_MAGIC), f)
+        != strlen(CACHE_FILE_MAGIC) ||
+        strcmp(magic, CACHE_FILE_MAGIC) != 0) {
+        fclose(f);
+        return -1;
+    }
+
+    int rtn = 0;
+    int64_t header[2];
+    struct Real* value;
+    struct CachedConstant* entry;
+    while (fread(header, sizeof(int64_t), 2, f) == 2) {
+        value = read_real(f);
+        if (value == NULL || header[0] < 0 || header[0] >= NUM_CONSTANTS) {
+            if (value != NULL) {
+                free_real(value);
+            }
+            rtn = -1;
+            break;
+        }
+
+        entry = &constant_cache[header[0]];
+        pthread_mutex_lock(&entry->lock);
+        if (entry->value == NULL || entry->min_sig_word_idx > header[1]) {
+            if (entry->value != NULL) {
+                free_real(entry->value);
+            }
+            entry->value = value;
+            entry->min_sig_word_idx = header[1];
+        } else {
+            free_real(value);
+        }
+        pthread_mutex_unlock(&entry->lock);
+    }
+
+    fclose(f);
+    return rtn;
+}
@@ -0,0 +1,43 @@
+#ifndef CONSTANTS_H
+#define CONSTANTS_H
+
+#include "real.h"
+
+// A process-wide cache of mathematical constants.
+//
+// Each constant is stored at the highest precision computed so far, and
+// a request for fewer words is answered by truncating the stored value.
+// When the stored value isn't precise enough, it's recomputed with at
+// least twice as many words, so a sequence of slowly-growing requests
+// only recomputes O(log n) times.
+//
+// All functions here are thread-safe.
+
+enum constant_t {
+    CONSTANT_PI,
+    CONSTANT_LN2,
+    CONSTANT_E,
+    NUM_CONSTANTS
+};
+
+// Returns the constant `c`, keeping only words at or above
+// `min_sig_word_idx`. The caller owns the result.
+//
+// Returns NULL, leaving the stored value as it was, if computing it is
+// cancelled (see progress.h).
+struct Real* get_constant(enum constant_t c, ssize_t min_sig_word_idx);
+
+// Returns the `min_sig_word_idx` of the stored value of `c`, or 1 if
+// nothing is stored yet.
+ssize_t get_constant_precision(enum constant_t c);
+
+// Frees all of the stored constants.
+void clear_constant_cache(void);
+
+// Save the cache to `path`, or load it from there. Loaded values only
+// replace stored ones that are less precise.
+// Both return 0 on success and -1 on error.
+int save_constant_cache(char* path);
+int load_constant_cache(char* path);
+
+#endif
@@ -4,9 +4,11 @@
 #include <stdarg.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 #include "real.h"
 #include "arithmetic.h"
+#include "thresholds.h"
 
 
 // Flexible string stuff to make dynamically-handling the decimal string
@@ -14,6 +16,7 @@
 struct String {
     char* buf;
     size_t size;
+    size_t len;
 };
 
 void sprintf_append(struct String* s, char* fmt, ...)
@@ -21,7 +24,8 @@ void sprintf_append(struct String* s, char* fmt, ...)
 
 struct String* create_string(char* initial_string) {
     struct String* s = malloc(sizeof(struct String));
-    s->size = strlen(initial_string) + 1;
+    s->len = strlen(initial_string);
+    s->size = s->len + 1;
     s->buf = strdup(initial_string);
     return s;
 }
@@ -40,16 +44,71 @@ void sprintf_append(struct String* s, char* fmt, ...) {
     // This returns the number of characters that will be written.
     int chars_to_write = vsnprintf(NULL, 0, fmt, ap1);
 
-    if (strlen(s->buf) + chars_to_write + 1 > s->size) {
-        s->size = strlen(s->buf) + chars_to_write + 1;
+    if (s->len + chars_to_write + 1 > s->size) {
+        // Grow geometrically so that appending many short pieces is
+        // linear overall.
+        s->size = MAX(s->len + chars_to_write + 1, 2*s->size);
         s->buf = realloc(s->buf, s->size);
-        vsnprintf(s->buf + strlen(s->buf), chars_to_write + 1, fmt, ap2);
     }
+    vsnprintf(s->buf + s->len, chars_to_write + 1, fmt, ap2);
+    s->len += chars_to_write;
 
     va_end(ap1);
     va_end(ap2);
 }
 
+
+// Powers of ten.
+
+// Small numbers are converted 9 digits at a time, since `div_with_sig`
+// only takes 32-bit divisors.
+#define CHUNK_DIGITS 9
+#define CHUNK_RADIX 1000000000ul
+
+// The largest power of ten is 10^(19 * 2^(MAX_POWERS - 1)).
+#define MAX_POWERS 48
+
+pthread_mutex_t power_table_lock = PTHREAD_MUTEX_INITIALIZER;
+struct Real* power_table[MAX_POWERS];
+
+struct Real* get_power_of_ten(int k) {
+    // Each entry is the square of the one before, so getting entry `k`
+    // costs at most `k` products the first time and nothing after.
+    if (k < 0 || k >= MAX_POWERS) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&power_table_lock);
+    int i;
+    for (i = 0; i <= k; i++) {
+        if (power_table[i] != NULL) {
+            continue;
+        }
+        if (i == 0) {
+            power_table[i] = fill_real(POSITIVE, 0, 1, WORD_RADIX);
+        } else {
+            power_table[i] = multiply(power_table[i - 1], power_table[i - 1]);
+            trim_zeros(power_table[i]);
+        }
+    }
+    struct Real* rtn = power_table[k];
+    pthread_mutex_unlock(&power_table_lock);
+    return rtn;
+}
+
+void divmod_integer(struct Real* n, struct Real* d,
+                    struct Real** q, struct Real** r) {
+    // Sets `q` and `r` to the quotient and remainder of the non-negative
+    // integers `n` and `d`. Long division is exact, so the quotient needs
+    // no correcting, and it can't be cancelled.
+    *q = long_div_with_sig(n, d, 0);
+    *r = copy_real(n);
+    fms_with_sig(*r, *q, d, 0);
+    trim_zeros(*q);
+    trim_zeros(*r);
+}
+
+
 // Real to decimal string.
 
 void print_decimal(struct Real* r) {
@@ -58,73 +117,227 @@ void print_decimal(struct Real* r) {
     free(decimal_str);
 }
 
-char* get_positive_integer_decimal_digits(struct Real* r_int) {
-    struct String* rev_s = create_string("");
-
-    r_int = copy_real(r_int);
-    set_sign(r_int, POSITIVE);
-    struct Real* next_int;
-    struct Real* ten = fill_real(POSITIVE, 0, 1, 10);
-    struct Real* to_subtract;
-    struct Real* digit;
+void append_small_integer_digits(struct String* s, struct Real* n,
+                                 size_t width) {
+    // Appends the decimal digits of the non-negative integer `n` by
+    // repeatedly dividing out 10^9, padded with 0s to `width` digits.
+    // This is quadratic, but it's faster than splitting for small `n`.
+    //
+    // A chunk of 9 digits needs more than 29 bits.
+    size_t max_chunks = get_max_word_idx(n)*WORD_BITS/29 + 1;
+    word* chunks = malloc(max_chunks * sizeof(word));
+    size_t num_chunks = 0;
+
+    struct Real* q = copy_real(n);
+    struct Real* next;
+    while (!is_zero(q)) {
+        next = div_with_sig(q, CHUNK_RADIX, 0);
+        // The remainder is less than 10^9, so its low word is all of it.
+        chunks[num_chunks] = get_word(q, 0) - CHUNK_RADIX*get_word(next, 0);
+        num_chunks++;
+        free_real(q);
+        q = next;
+        trim_most_significant_zeros(q);
+    }
+    free_real(q);
+
+    char top[CHUNK_DIGITS + 1];
+    snprintf(top, sizeof(top), "%lu",
+             (num_chunks > 0) ? chunks[num_chunks - 1] : 0);
+    size_t num_digits = strlen(top) + CHUNK_DIGITS*MAX(num_chunks, 1)
+        - CHUNK_DIGITS;
+    if (width > num_digits) {
+        sprintf_append(s, "%0*d", (int) (width - num_digits), 0);
+    }
+    sprintf_append(s, "%s", top);
+    size_t chunk_idx;
+    for (chunk_idx = num_chunks - 1; chunk_idx > 0 && num_chunks > 0;
+         chunk_idx--) {
+        sprintf_append(s, "%0*lu", CHUNK_DIGITS, chunks[chunk_idx - 1]);
+    }
+    free(chunks);
+}
 
-    while (1) {
-        next_int = div_with_sig(r_int, 10, 0);
-        to_subtract = multiply(next_int, ten);
-        digit = subtract(r_int, to_subtract);
+void append_integer_digits(struct String* s, struct Real* n, size_t width) {
+    // Appends the decimal digits of the non-negative integer `n`. If
+    // `width` is not 0, the digits are padded with 0s to exactly `width`.
+    //
+    // Large numbers are split in 2 by dividing by a power of ten with
+    // about half as many digits, so the conversion takes O(log n) levels
+    // of divisions of balanced sizes instead of one division per digit.
+    if (get_max_word_idx(n) <= 1 ||
+        get_max_word_idx(n) < thresholds.decimal_split_min_words) {
+        append_small_integer_digits(s, n, width);
+        return;
+    }
 
-        sprintf_append(rev_s, "%ld", get_word(digit, 0));
+    int k = 0;
+    while (k + 1 < MAX_POWERS &&
+           get_exponent(get_power_of_ten(k + 1))
+           <= (get_exponent(n) + 1) / 2 + 1) {
+        k++;
+    }
+    size_t low_width = (size_t) WORD_DIGITS << k;
+
+    struct Real* q;
+    struct Real* r;
+    divmod_integer(n, get_power_of_ten(k), &q, &r);
+    append_integer_digits(s, q, (width > 0) ? width - low_width : 0);
+    append_integer_digits(s, r, low_width);
+    free_real(q);
+    free_real(r);
+}
 
-        free_real(to_subtract);
-        free_real(digit);
-        free_real(r_int);
-        r_int = next_int;
+typedef unsigned __int128 dword;
+
+void small_integer_to_radix_words(struct Real* n, word* limbs,
+                                  size_t num_limbs) {
+    // Repeatedly divides the words of `n` by 10^19 with 128-bit
+    // arithmetic. This is quadratic, like `append_small_integer_digits`.
+    ssize_t num_words = get_max_word_idx(n);
+    word* w = malloc(MAX(num_words, 1) * sizeof(word));
+    ssize_t i;
+    for (i = 0; i < num_words; i++) {
+        w[i] = get_word(n, i);
+    }
 
-        if (is_zero(r_int) == 1) {
-            break;
+    size_t limb_idx;
+    dword current;
+    word rem;
+    for (limb_idx = num_limbs; limb_idx > 0; limb_idx--) {
+        rem = 0;
+        for (i = num_words - 1; i >= 0; i--) {
+            current = ((dword) rem << WORD_BITS) | w[i];
+            w[i] = (word) (current / WORD_RADIX);
+            rem = (word) (current % WORD_RADIX);
+        }
+        limbs[limb_idx - 1] = rem;
+        while (num_words > 0 && w[num_words - 1] == 0) {
+            num_words--;
         }
     }
-    free_real(r_int);
-    free_real(ten);
+    free(w);
+}
+
+void integer_to_radix_words(struct Real* n, word* limbs, size_t num_limbs) {
+    // Splits the same way as `append_integer_digits`, but always on a
+    // power-of-two number of limbs, so the low part's limbs are exactly
+    // those of one of the shared powers of ten.
+    if (num_limbs <= 1 || get_max_word_idx(n) <= 1 ||
+        get_max_word_idx(n) < thresholds.decimal_split_min_words) {
+        small_integer_to_radix_words(n, limbs, num_limbs);
+        return;
+    }
 
-    char* rev_chars = free_string(rev_s);
+    int k = 0;
+    while (((size_t) 2 << k) < num_limbs) {
+        k++;
+    }
+    size_t num_low_limbs = (size_t) 1 << k;
+
+    struct Real* q;
+    struct Real* r;
+    divmod_integer(n, get_power_of_ten(k), &q, &r);
+    integer_to_radix_words(q, limbs, num_limbs - num_low_limbs);
+    integer_to_radix_words(r, limbs + num_limbs - num_low_limbs,
+                           num_low_limbs);
+    free_real(q);
+    free_real(r);
+}
 
-    struct String* rtn_s = create_string("");
+struct Real* radix_words_to_integer(const word* limbs, size_t num_limbs) {
+    // The inverse of `integer_to_radix_words`, split the same way.
+    if (num_limbs <= 1 ||
+        (ssize_t) num_limbs < thresholds.decimal_split_min_words) {
+        // Horner's method, a limb at a time.
+        struct Real* r = fill_real(POSITIVE, 0, 1, 0);
+        struct Real* next;
+        size_t i;
+        for (i = 0; i < num_limbs; i++) {
+            next = fill_real(POSITIVE, 0, 1, limbs[i]);
+            axpy(next, WORD_RADIX, r);
+            free_real(r);
+            r = next;
+        }
+        trim_most_significant_zeros(r);
+        return r;
+    }
 
-    int c_idx;
-    for (c_idx = strlen(rev_chars) - 1; c_idx >= 0; c_idx--) {
-        sprintf_append(rtn_s, "%c", rev_chars[c_idx]);
+    int k = 0;
+    while (((size_t) 2 << k) < num_limbs) {
+        k++;
     }
-    free(rev_chars);
+    size_t num_low_limbs = (size_t) 1 << k;
+
+    struct Real* high = radix_words_to_integer(limbs,
+                                               num_limbs - num_low_limbs);
+    struct Real* low = radix_words_to_integer(limbs + num_limbs
+                                              - num_low_limbs,
+                                              num_low_limbs);
+    fma_with_sig(low, high, get_power_of_ten(k), 0);
+    trim_zeros(low);
+    free_real(high);
+    return low;
+}
 
-    return free_string(rtn_s);
+word* fraction_to_radix_words(struct Real* fraction, size_t num_words) {
+    // Returns the first 19 * `num_words` digits of the non-negative
+    // `fraction` < 1, packed 19 to a word: the integer part of
+    // fraction * 10^(19 n) = fraction * 5^(19 n) * 2^(19 n).
+    size_t num_digits = WORD_DIGITS * num_words;
+    struct Real* five_pow = pow_word(5, num_digits);
+    struct Real* scaled = multiply(fraction, five_pow);
+    struct Real* shifted = shift_left_bits(scaled, num_digits);
+    struct Real* n = div_with_sig(shifted, 1, 0);
+    trim_zeros(n);
+
+    word* words = malloc(MAX(num_words, 1) * sizeof(word));
+    integer_to_radix_words(n, words, num_words);
+
+    free_real(five_pow);
+    free_real(scaled);
+    free_real(shifted);
+    free_real(n);
+    return words;
+}
+
+char* get_positive_integer_decimal_digits(struct Real* r_int) {
+    struct String* s = create_string("");
+    r_int = copy_real(r_int);
+    set_sign(r_int, POSITIVE);
+    trim_zeros(r_int);
+    append_integer_digits(s, r_int, 0);
+    free_real(r_int);
+    return free_string(s);
 }
 
 char* get_positive_fractional_decimal_digits(struct Real* r) {
+    // A fraction with D fractional bits has exactly D decimal digits:
+    // r = F / 2^D, so r 10^D = F 5^D is an integer with those digits.
     struct String* s = create_string("");
 
     r = copy_real(r);
-    struct Real* temp;
-    struct Real* ten = fill_real(POSITIVE, 0, 1, 10);
-
-    while (1) {
-        trim_zeros(r);
-        if (is_zero(r)) {
-            // We're done.
-            break;
-        }
-
-        temp = multiply(r, ten);
+    trim_zeros(r);
+    if (is_zero(r) || get_min_word_idx(r) >= 0) {
         free_real(r);
-        r = temp;
-        sprintf_append(s, "%ld", get_word(r, 0));
-        if (get_word(r, 0) != 0) {
-            set_word(r, 0, 0);
-        }
+        return free_string(s);
     }
 
+    ssize_t num_digits = -get_min_word_idx(r)*WORD_BITS;
+    shift_words(r, -get_min_word_idx(r));
+    struct Real* five_pow = pow_word(5, num_digits);
+    struct Real* n = multiply(r, five_pow);
+    trim_zeros(n);
+    append_integer_digits(s, n, num_digits);
+    free_real(five_pow);
+    free_real(n);
     free_real(r);
-    free_real(ten);
+
+    // The expansion is exact, so drop its trailing zeros.
+    while (s->len > 0 && s->buf[s->len - 1] == '0') {
+        s->len--;
+    }
+    s->buf[s->len] = 0;
 
     return free_string(s);
 }
@@ -161,29 +374,106 @@ char* real_to_decimal_str(struct Real* r) {
 
 // Decimal string to real.
 
+struct Real* digits_to_integer(char* digits, size_t num_digits) {
+    // Returns the integer with the given decimal digits, splitting it the
+    // same way as `append_integer_digits`.
+    if ((ssize_t) num_digits
+        <= WORD_DIGITS*thresholds.decimal_split_min_words ||
+        num_digits <= WORD_DIGITS) {
+        // Horner's method, 19 digits at a time.
+        struct Real* r = fill_real(POSITIVE, 0, 1, 0);
+        struct Real* next;
+        word w;
+        size_t idx = 0;
+        size_t chunk_end = (num_digits - 1) % WORD_DIGITS + 1;
+        while (idx < num_digits) {
+            w = 0;
+            for (; idx < chunk_end; idx++) {
+                w = 10*w + (digits[idx] - '0');
+            }
+            next = fill_real(POSITIVE, 0, 1, w);
+            axpy(next, WORD_RADIX, r);
+            free_real(r);
+            r = next;
+            chunk_end += WORD_DIGITS;
+        }
+        trim_most_significant_zeros(r);
+        return r;
+    }
+
+    int k = 0;
+    while (((size_t) WORD_DIGITS << (k + 1)) < num_digits) {
+        k++;
+    }
+    size_t low_width = (size_t) WORD_DIGITS << k;
+
+    struct Real* high = digits_to_integer(digits, num_digits - low_width);
+    struct Real* low = digits_to_integer(digits + num_digits - low_width,
+                                         low_width);
+    fma_with_sig(low, high, get_power_of_ten(k), 0);
+    trim_zeros(low);
+    free_real(high);
+    return low;
+}
+
 struct Real* decimal_str_to_real(char* decimal_str) {
     enum sign_t sign = POSITIVE;
+    char* int_digits = decimal_str;
+    if (int_digits[0] == '-') {
+        sign = NEGATIVE;
+        int_digits++;
+    }
 
-    struct Real* r = fill_real(POSITIVE, 0, 1, 0);
-    //struct Real* temp;
-    //struct Real* place_value = fill_real(POSITIVE, 0, 1, 1);
-    //struct Real* to_add;
-
-    int fractional = 0;
-
-    int idx;
-    for (idx = 0; decimal_str[idx] != 0; idx++) {
-        if (idx == 0 && decimal_str[idx] == '-') {
-            sign = NEGATIVE;
-        } else if (decimal_str[idx] == '.') {
-            fractional = 1;
-        } else if ('0' <= decimal_str[idx] && decimal_str[idx] <= '9') {
-            if (fractional) {
-                continue;
-            }
+    size_t num_int_digits = strspn(int_digits, "0123456789");
+    char* frac_digits = int_digits + num_int_digits;
+    size_t num_frac_digits = 0;
+    if (frac_digits[0] == '.') {
+        frac_digits++;
+        num_frac_digits = strspn(frac_digits, "0123456789");
+    }
+    if (frac_digits[num_frac_digits] != 0 ||
+        num_int_digits + num_frac_digits == 0) {
+        puts("Invalid decimal string!");
+        return NULL;
+    }
+
+    struct Real* r = digits_to_integer(int_digits, num_int_digits);
+
+    if (num_frac_digits > 0) {
+        // The fraction is I / 10^L = I / (5^L 2^L), which is exact in
+        // binary when 5^L divides I. Otherwise, keep enough words for all
+        // of its digits (log2(10) < 3.33) and then some.
+        struct Real* numerator = digits_to_integer(frac_digits,
+                                                   num_frac_digits);
+        struct Real* five_pow = pow_word(5, num_frac_digits);
+        struct Real* q;
+        struct Real* rem;
+        struct Real* fraction;
+        divmod_integer(numerator, five_pow, &q, &rem);
+        if (is_zero(rem)) {
+            fraction = shift_right_bits(q, num_frac_digits);
+        } else {
+            ssize_t min_sig_word_idx = -((ssize_t) (num_frac_digits*333/100)
+                                         / WORD_BITS) - 2;
+            struct Real* denominator = pow_word(10, num_frac_digits);
+            fraction = div_real_with_sig(numerator, denominator,
+                                         min_sig_word_idx);
+            free_real(denominator);
+        }
+        free_real(numerator);
+        free_real(five_pow);
+        free_real(q);
+        free_real(rem);
+        if (fraction == NULL) {
+            // Cancelled.
+            free_real(r);
+            return NULL;
         }
+        add_to(r, fraction);
+        free_real(fraction);
     }
 
+    trim_zeros(r);
     if (sign == NEGATIVE) {
         negate(r);
     }
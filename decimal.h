@@ -3,10 +3,42 @@
 
 #include "real.h"
 
+// The largest power of 10 that fits in a word is 10^19, so words of
+// decimal digits are base 10^19 and hold 19 digits each.
+#define WORD_DIGITS 19
+#define WORD_RADIX 10000000000000000000ul
+
+// Returns 10^(19 * 2^k), the powers of ten used to split numbers when
+// converting to and from decimal. They are computed once, on first use,
+// and shared; the caller must not modify or free them.
+struct Real* get_power_of_ten(int k);
+
+// Sets `limbs` to the last `num_limbs` base 10^19 digits of the
+// non-negative integer `n`, most significant first, so that each word
+// holds 19 decimal digits.
+void integer_to_radix_words(struct Real* n, word* limbs, size_t num_limbs);
+
+// Returns the integer whose base 10^19 digits are the `num_limbs` words
+// of `limbs`, most significant first. This is the inverse of
+// `integer_to_radix_words`.
+struct Real* radix_words_to_integer(const word* limbs, size_t num_limbs);
+
+// Returns the first 19 * `num_words` decimal digits of the non-negative
+// `fraction` < 1, in the same form as `integer_to_radix_words`. The last
+// word is truncated, not rounded. The caller frees the result.
+word* fraction_to_radix_words(struct Real* fraction, size_t num_words);
+
 void print_decimal(struct Real* r);
 
+// Only uses exact integer division, so unlike most long computations it
+// runs to the end even if it's cancelled (see progress.h), and never
+// returns NULL.
 char* real_to_decimal_str(struct Real* r);
 
+// Parses an optionally negative decimal string like "-12.375". A
+// fraction that isn't exact in binary is kept to at least as many bits as
+// its digits need. Returns NULL if the string isn't a decimal number, or
+// if the division for such a fraction is cancelled.
 struct Real* decimal_str_to_real(char* decimal_str);
 
 #endif
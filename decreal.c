@@ -0,0 +1,666 @@
+#include "decreal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "decimal.h"
+#include "progress.h"
+#include "thresholds.h"
+
+
+typedef unsigned __int128 dword;
+
+// A limb holds a little over 63 bits: 2^63 < 10^19 < 2^64.
+#define LIMB_BITS 63
+
+struct DecReal {
+    enum sign_t sign;
+    ssize_t min_limb_idx;
+    ssize_t max_limb_idx;
+    // `limbs[i]` is the limb at index `min_limb_idx + i`. It points into
+    // `buffer`, so dropping limbs from the bottom doesn't move the rest.
+    word* limbs;
+    word* buffer;
+};
+
+
+// Allocating and accessing.
+
+struct DecReal* alloc_dec_real(enum sign_t sign,
+                               ssize_t min_limb_idx,
+                               ssize_t max_limb_idx) {
+    if (max_limb_idx <= min_limb_idx) {
+        printf("Trying to alloc dec real with min = %ld, max = %ld\n",
+               min_limb_idx, max_limb_idx);
+        printf("Returning NULL\n");
+        return NULL;
+    }
+    struct DecReal* d = malloc(sizeof(struct DecReal));
+    d->sign = sign;
+    d->min_limb_idx = min_limb_idx;
+    d->max_limb_idx = max_limb_idx;
+    d->buffer = calloc(max_limb_idx - min_limb_idx, sizeof(word));
+    d->limbs = d->buffer;
+    return d;
+}
+
+struct DecReal* fill_dec_real(enum sign_t sign,
+                              ssize_t min_limb_idx,
+                              ssize_t max_limb_idx,
+                              ...) {
+    struct DecReal* d = alloc_dec_real(sign, min_limb_idx, max_limb_idx);
+
+    va_list ap;
+    va_start(ap, max_limb_idx);
+    ssize_t limb_idx;
+    for (limb_idx = min_limb_idx; limb_idx < max_limb_idx; limb_idx++) {
+        set_limb(d, limb_idx, va_arg(ap, word));
+    }
+    va_end(ap);
+
+    return d;
+}
+
+struct DecReal* copy_dec_real(struct DecReal* d) {
+    struct DecReal* copy = alloc_dec_real(d->sign, d->min_limb_idx,
+                                          d->max_limb_idx);
+    memcpy(copy->limbs, d->limbs,
+           (d->max_limb_idx - d->min_limb_idx) * sizeof(word));
+    return copy;
+}
+
+void free_dec_real(struct DecReal* d) {
+    free(d->buffer);
+    free(d);
+}
+
+enum sign_t get_dec_sign(struct DecReal* d) {
+    return d->sign;
+}
+
+void set_dec_sign(struct DecReal* d, enum sign_t sign) {
+    d->sign = sign;
+}
+
+ssize_t get_min_limb_idx(struct DecReal* d) {
+    return d->min_limb_idx;
+}
+
+ssize_t get_max_limb_idx(struct DecReal* d) {
+    return d->max_limb_idx;
+}
+
+word get_limb(struct DecReal* d, ssize_t limb_idx) {
+    if (limb_idx < d->min_limb_idx || limb_idx >= d->max_limb_idx) {
+        return 0;
+    }
+    return d->limbs[limb_idx - d->min_limb_idx];
+}
+
+void set_limb(struct DecReal* d, ssize_t limb_idx, word limb) {
+    d->limbs[limb_idx - d->min_limb_idx] = limb;
+}
+
+int is_dec_zero(struct DecReal* d) {
+    ssize_t limb_idx;
+    for (limb_idx = d->min_limb_idx; limb_idx < d->max_limb_idx;
+         limb_idx++) {
+        if (get_limb(d, limb_idx) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void set_dec_zero(struct DecReal* d) {
+    // Keeps just the units limb, like `trim_zeros` does for 0.
+    d->limbs = d->buffer;
+    d->limbs[0] = 0;
+    d->min_limb_idx = 0;
+    d->max_limb_idx = 1;
+    d->sign = POSITIVE;
+}
+
+void trim_dec_zeros(struct DecReal* d) {
+    // This only narrows the range, so it never reallocates.
+    if (is_dec_zero(d)) {
+        set_dec_zero(d);
+        return;
+    }
+    while (get_limb(d, d->max_limb_idx - 1) == 0) {
+        d->max_limb_idx--;
+    }
+    while (get_limb(d, d->min_limb_idx) == 0) {
+        d->limbs++;
+        d->min_limb_idx++;
+    }
+}
+
+void truncate_dec_real(struct DecReal* d, ssize_t min_sig_limb_idx) {
+    if (d->max_limb_idx <= min_sig_limb_idx) {
+        set_dec_zero(d);
+    } else if (d->min_limb_idx < min_sig_limb_idx) {
+        d->limbs += min_sig_limb_idx - d->min_limb_idx;
+        d->min_limb_idx = min_sig_limb_idx;
+    }
+}
+
+void negate_dec(struct DecReal* d) {
+    // 0 stays positive.
+    if (!is_dec_zero(d)) {
+        d->sign = (d->sign == POSITIVE) ? NEGATIVE : POSITIVE;
+    }
+}
+
+
+// Adding and subtracting.
+
+int compare_dec_magnitudes(struct DecReal* d1, struct DecReal* d2) {
+    ssize_t limb_idx;
+    word w1, w2;
+    for (limb_idx = MAX(d1->max_limb_idx, d2->max_limb_idx) - 1;
+         limb_idx >= MIN(d1->min_limb_idx, d2->min_limb_idx);
+         limb_idx--) {
+        w1 = get_limb(d1, limb_idx);
+        w2 = get_limb(d2, limb_idx);
+        if (w1 != w2) {
+            return (w1 < w2) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+struct DecReal* add_signed(struct DecReal* d1, struct DecReal* d2,
+                           enum sign_t d2_sign) {
+    // Returns d1 + d2, taking `d2` to have the sign `d2_sign`. Different
+    // signs subtract the smaller magnitude from the larger one.
+    int subtracting = (d1->sign != d2_sign);
+    struct DecReal* big = d1;
+    struct DecReal* small = d2;
+    enum sign_t sign = d1->sign;
+    if (subtracting && compare_dec_magnitudes(d1, d2) < 0) {
+        big = d2;
+        small = d1;
+        sign = d2_sign;
+    }
+
+    ssize_t min_limb_idx = MIN(d1->min_limb_idx, d2->min_limb_idx);
+    ssize_t max_limb_idx = MAX(d1->max_limb_idx, d2->max_limb_idx) + 1;
+    struct DecReal* s = alloc_dec_real(sign, min_limb_idx, max_limb_idx);
+
+    word carry = 0;
+    word x, y;
+    dword t;
+    ssize_t limb_idx;
+    for (limb_idx = min_limb_idx; limb_idx < max_limb_idx; limb_idx++) {
+        x = get_limb(big, limb_idx);
+        y = get_limb(small, limb_idx) + carry;
+        if (!subtracting) {
+            t = (dword) x + y;
+            carry = (t >= WORD_RADIX);
+            set_limb(s, limb_idx, (word) (t - (dword) carry * WORD_RADIX));
+        } else if (x >= y) {
+            set_limb(s, limb_idx, x - y);
+            carry = 0;
+        } else {
+            set_limb(s, limb_idx, x + (WORD_RADIX - y));
+            carry = 1;
+        }
+    }
+    trim_dec_zeros(s);
+    return s;
+}
+
+struct DecReal* dec_add(struct DecReal* d1, struct DecReal* d2) {
+    return add_signed(d1, d2, d2->sign);
+}
+
+struct DecReal* dec_subtract(struct DecReal* d1, struct DecReal* d2) {
+    return add_signed(d1, d2, (d2->sign == POSITIVE) ? NEGATIVE : POSITIVE);
+}
+
+
+// Multiplying. These work on bare arrays of limbs, least significant
+// first.
+
+void add_limbs(word* dst, size_t num_dst, const word* src, size_t num_src) {
+    // dst += src, where the sum fits in `num_dst` limbs.
+    word carry = 0;
+    dword t;
+    size_t i;
+    for (i = 0; i < num_dst && (i < num_src || carry); i++) {
+        t = (dword) dst[i] + ((i < num_src) ? src[i] : 0) + carry;
+        carry = (t >= WORD_RADIX);
+        dst[i] = (word) (t - (dword) carry * WORD_RADIX);
+    }
+}
+
+void subtract_limbs(word* dst, size_t num_dst, const word* src,
+                    size_t num_src) {
+    // dst -= src, where the difference isn't negative.
+    word borrow = 0;
+    word y;
+    size_t i;
+    for (i = 0; i < num_dst && (i < num_src || borrow); i++) {
+        y = ((i < num_src) ? src[i] : 0) + borrow;
+        if (dst[i] >= y) {
+            dst[i] -= y;
+            borrow = 0;
+        } else {
+            dst[i] += WORD_RADIX - y;
+            borrow = 1;
+        }
+    }
+}
+
+void mul_limbs_schoolbook(const word* a, size_t num_a, const word* b,
+                          size_t num_b, word* p, ssize_t skip) {
+    // p = a * b, ignoring the partial products a_i b_j with i + j < `skip`.
+    // `p` has `num_a + num_b` limbs, which start at 0.
+    size_t i, j;
+    word carry, q;
+    dword t;
+    for (i = 0; i < num_a; i++) {
+        j = (skip > (ssize_t) i) ? skip - i : 0;
+        if (j >= num_b) {
+            continue;
+        }
+        // (10^19 - 1)^2 + 2 (10^19 - 1) < 2^128, so nothing overflows.
+        carry = 0;
+        for (; j < num_b; j++) {
+            t = (dword) a[i] * b[j] + p[i + j] + carry;
+            q = (word) (t / WORD_RADIX);
+            p[i + j] = (word) (t - (dword) q * WORD_RADIX);
+            carry = q;
+        }
+        p[i + num_b] = carry;
+    }
+}
+
+void mul_limbs(const word* a, size_t num_a, const word* b, size_t num_b,
+               word* p, ssize_t skip) {
+    // Like `mul_limbs_schoolbook`, but with Karatsuba for long operands,
+    // which computes every partial product.
+    // Below 4 limbs the sums are as long as the operands, so Karatsuba
+    // wouldn't make them any shorter.
+    size_t n = MIN(num_a, num_b);
+    if ((ssize_t) n < MAX(thresholds.karatsuba_min_words, 4)) {
+        mul_limbs_schoolbook(a, num_a, b, num_b, p, skip);
+        return;
+    }
+
+    // a = a0 + a1 10^(19 h) and b = b0 + b1 10^(19 h), so
+    // a b = z0 + (z1 - z0 - z2) 10^(19 h) + z2 10^(38 h), where
+    // z0 = a0 b0, z2 = a1 b1 and z1 = (a0 + a1)(b0 + b1).
+    size_t h = n / 2;
+    size_t num_sum_a = MAX(h, num_a - h) + 1;
+    size_t num_sum_b = MAX(h, num_b - h) + 1;
+    size_t num_z1 = num_sum_a + num_sum_b;
+    size_t num_z2 = num_a + num_b - 2*h;
+    word* sum_a = calloc(num_sum_a, sizeof(word));
+    word* sum_b = calloc(num_sum_b, sizeof(word));
+    word* z1 = calloc(num_z1, sizeof(word));
+
+    memcpy(sum_a, a, h * sizeof(word));
+    add_limbs(sum_a, num_sum_a, a + h, num_a - h);
+    memcpy(sum_b, b, h * sizeof(word));
+    add_limbs(sum_b, num_sum_b, b + h, num_b - h);
+    mul_limbs(sum_a, num_sum_a, sum_b, num_sum_b, z1, 0);
+
+    // z0 and z2 go straight into the bottom and top of `p`.
+    memset(p, 0, (num_a + num_b) * sizeof(word));
+    mul_limbs(a, h, b, h, p, 0);
+    mul_limbs(a + h, num_a - h, b + h, num_b - h, p + 2*h, 0);
+    subtract_limbs(z1, num_z1, p, 2*h);
+    subtract_limbs(z1, num_z1, p + 2*h, num_z2);
+
+    // The middle term is less than a b / 10^(19 h), so its limbs past
+    // the end of `p` are 0.
+    add_limbs(p + h, num_a + num_b - h, z1, MIN(num_z1, num_a + num_b - h));
+
+    free(sum_a);
+    free(sum_b);
+    free(z1);
+}
+
+struct DecReal* dec_mul_with_sig(struct DecReal* d1, struct DecReal* d2,
+                                 ssize_t min_sig_limb_idx) {
+    ssize_t min_limb_idx = d1->min_limb_idx + d2->min_limb_idx;
+    ssize_t max_limb_idx = d1->max_limb_idx + d2->max_limb_idx;
+    if (max_limb_idx <= min_sig_limb_idx) {
+        return alloc_dec_real(POSITIVE, 0, 1);
+    }
+
+    struct DecReal* p = alloc_dec_real(
+        (d1->sign == d2->sign) ? POSITIVE : NEGATIVE,
+        min_limb_idx, max_limb_idx);
+    // Keep the partial products at `min_sig_limb_idx - 1`, whose carries
+    // reach the lowest kept limb.
+    mul_limbs(d1->limbs, d1->max_limb_idx - d1->min_limb_idx,
+              d2->limbs, d2->max_limb_idx - d2->min_limb_idx,
+              p->limbs, min_sig_limb_idx - 1 - min_limb_idx);
+    truncate_dec_real(p, min_sig_limb_idx);
+    trim_dec_zeros(p);
+    return p;
+}
+
+struct DecReal* dec_multiply(struct DecReal* d1, struct DecReal* d2) {
+    return dec_mul_with_sig(d1, d2, d1->min_limb_idx + d2->min_limb_idx);
+}
+
+
+// Dividing.
+
+struct DecReal* dec_div_with_sig(struct DecReal* d, word divisor,
+                                 ssize_t min_sig_limb_idx) {
+    if (divisor == 0) {
+        puts("Division by zero!");
+        return NULL;
+    }
+    if (d->max_limb_idx <= min_sig_limb_idx) {
+        return alloc_dec_real(POSITIVE, 0, 1);
+    }
+
+    // Long division from the top, a limb at a time. The remainder is
+    // below `divisor`, so each quotient limb is below 10^19.
+    struct DecReal* q = alloc_dec_real(d->sign, min_sig_limb_idx,
+                                       d->max_limb_idx);
+    word remainder = 0;
+    word quotient;
+    dword t;
+    ssize_t limb_idx;
+    for (limb_idx = d->max_limb_idx - 1; limb_idx >= min_sig_limb_idx;
+         limb_idx--) {
+        t = (dword) remainder * WORD_RADIX + get_limb(d, limb_idx);
+        quotient = (word) (t / divisor);
+        remainder = (word) (t - (dword) quotient * divisor);
+        set_limb(q, limb_idx, quotient);
+    }
+    trim_dec_zeros(q);
+    return q;
+}
+
+
+// Cosine.
+
+ssize_t get_dec_exponent(struct DecReal* d) {
+    // Returns an `e` with |d| < 2^e, which is at most 2 more than
+    // `get_exponent` of the same number. The exponent of 0 is 0.
+    ssize_t limb_idx;
+    word limb;
+    for (limb_idx = d->max_limb_idx - 1; limb_idx >= d->min_limb_idx;
+         limb_idx--) {
+        limb = get_limb(d, limb_idx);
+        if (limb != 0) {
+            return (ssize_t) floor(log2((double) limb)
+                                   + limb_idx * WORD_DIGITS * log2(10.0)) + 2;
+        }
+    }
+    return 0;
+}
+
+struct DecReal* dec_cos_with_sig(struct DecReal* theta,
+                                 ssize_t min_sig_limb_idx) {
+    // This follows `cos_with_sig`: divide the argument by 2^k so that it's
+    // below 2^-r, sum the series for 1 - cos, which doesn't lose
+    // precision to cancellation, and then take k double-angle steps.
+    ssize_t target_bits = MAX(-min_sig_limb_idx * LIMB_BITS, WORD_BITS);
+    ssize_t r = (ssize_t) sqrt(target_bits / 2.0) + 1;
+    ssize_t k = MAX(0, get_dec_exponent(theta) + r);
+
+    // Each double-angle step can multiply the absolute error by 4, so
+    // keep 2 extra bits per step.
+    ssize_t guard_limbs = (2*k + LIMB_BITS - 1) / LIMB_BITS + 1;
+    ssize_t work = min_sig_limb_idx - guard_limbs;
+
+    // y = theta / 2^k, at most 63 bits at a time.
+    struct DecReal* y = copy_dec_real(theta);
+    struct DecReal* next;
+    ssize_t bits_left = k;
+    ssize_t num_bits;
+    do {
+        num_bits = MIN(bits_left, LIMB_BITS);
+        next = dec_div_with_sig(y, (word) 1 << num_bits, work);
+        free_dec_real(y);
+        y = next;
+        bits_left -= num_bits;
+    } while (bits_left > 0);
+    struct DecReal* y_squared = dec_mul_with_sig(y, y, work);
+    free_dec_real(y);
+
+    // 1 - cos(y) = y^2/2 - y^4/4! + ..., where each term is the one
+    // before times -y^2 / ((m-1) m). The terms are truncated, so they
+    // reach 0.
+    struct DecReal* c = dec_div_with_sig(y_squared, 2, work);
+    struct DecReal* term = copy_dec_real(c);
+    word m;
+    begin_stage("series term", 0);
+    for (m = 4; !is_dec_zero(term); m += 2) {
+        if (checkpoint(m/2 - 2)) {
+            break;
+        }
+        next = dec_mul_with_sig(term, y_squared, work);
+        free_dec_real(term);
+        term = dec_div_with_sig(next, (m - 1) * m, work);
+        free_dec_real(next);
+        negate_dec(term);
+
+        next = dec_add(c, term);
+        free_dec_real(c);
+        c = next;
+    }
+    end_stage();
+    free_dec_real(term);
+    free_dec_real(y_squared);
+
+    // 1 - cos(2y) = 2 (2 (1 - cos(y)) - (1 - cos(y))^2).
+    struct DecReal* c_squared;
+    ssize_t step;
+    begin_stage("double-angle step", k);
+    for (step = 0; step < k; step++) {
+        // Once cancelled, this stays cancelled, which covers the series
+        // having stopped early.
+        if (checkpoint(step)) {
+            break;
+        }
+        c_squared = dec_mul_with_sig(c, c, work);
+        next = dec_add(c, c);
+        free_dec_real(c);
+        c = dec_subtract(next, c_squared);
+        free_dec_real(next);
+        free_dec_real(c_squared);
+        next = dec_add(c, c);
+        free_dec_real(c);
+        c = next;
+    }
+    end_stage();
+
+    if (is_cancelled()) {
+        free_dec_real(c);
+        return NULL;
+    }
+
+    struct DecReal* one = fill_dec_real(POSITIVE, 0, 1, 1);
+    struct DecReal* diff = dec_subtract(one, c);
+    struct DecReal* rtn = dec_div_with_sig(diff, 1, min_sig_limb_idx);
+    free_dec_real(one);
+    free_dec_real(c);
+    free_dec_real(diff);
+    return rtn;
+}
+
+
+// Converting to and from struct Real.
+
+struct DecReal* real_to_dec_real(struct Real* r, ssize_t min_sig_limb_idx) {
+    struct Real* integer = div_with_sig(r, 1, 0);
+    struct Real* fraction = subtract(r, integer);
+    set_sign(integer, POSITIVE);
+    set_sign(fraction, POSITIVE);
+    trim_zeros(integer);
+
+    // A word holds less than 64/63 of a limb.
+    ssize_t num_int_words = get_max_word_idx(integer);
+    ssize_t num_int_limbs = num_int_words + num_int_words/64 + 1;
+    ssize_t num_frac_limbs = MAX(0, -min_sig_limb_idx);
+    struct DecReal* d = alloc_dec_real(get_sign(r), -num_frac_limbs,
+                                       num_int_limbs);
+
+    // Both come most significant first.
+    word* limbs = malloc(num_int_limbs * sizeof(word));
+    integer_to_radix_words(integer, limbs, num_int_limbs);
+    ssize_t i;
+    for (i = 0; i < num_int_limbs; i++) {
+        set_limb(d, num_int_limbs - 1 - i, limbs[i]);
+    }
+    free(limbs);
+    if (num_frac_limbs > 0) {
+        limbs = fraction_to_radix_words(fraction, num_frac_limbs);
+        for (i = 0; i < num_frac_limbs; i++) {
+            set_limb(d, -1 - i, limbs[i]);
+        }
+        free(limbs);
+    }
+
+    free_real(integer);
+    free_real(fraction);
+    truncate_dec_real(d, min_sig_limb_idx);
+    trim_dec_zeros(d);
+    return d;
+}
+
+struct Real* dec_real_to_real(struct DecReal* d, ssize_t min_sig_word_idx) {
+    // d = I 10^(19 m), for the integer I made of all of its limbs and its
+    // bottom limb index m.
+    ssize_t num_limbs = d->max_limb_idx - d->min_limb_idx;
+    word* limbs = malloc(num_limbs * sizeof(word));
+    ssize_t i;
+    for (i = 0; i < num_limbs; i++) {
+        limbs[i] = get_limb(d, d->max_limb_idx - 1 - i);
+    }
+    struct Real* integer = radix_words_to_integer(limbs, num_limbs);
+    free(limbs);
+
+    struct Real* r;
+    struct Real* scale;
+    if (d->min_limb_idx >= 0) {
+        scale = pow_word(10, WORD_DIGITS * d->min_limb_idx);
+        struct Real* product = multiply(integer, scale);
+        r = div_with_sig(product, 1, min_sig_word_idx);
+        free_real(product);
+    } else {
+        scale = pow_word(10, WORD_DIGITS * -d->min_limb_idx);
+        r = div_real_with_sig(integer, scale, min_sig_word_idx);
+    }
+    free_real(scale);
+    free_real(integer);
+
+    if (r != NULL && !is_zero(r)) {
+        set_sign(r, d->sign);
+    }
+    return r;
+}
+
+
+// Decimal strings. No conversion is needed: each limb is printed or
+// parsed as 19 digits.
+
+char* dec_real_to_decimal_str(struct DecReal* d) {
+    ssize_t top = MAX(d->max_limb_idx - 1, 0);
+    while (top > 0 && get_limb(d, top) == 0) {
+        top--;
+    }
+    ssize_t bottom = MIN(d->min_limb_idx, 0);
+    while (bottom < 0 && get_limb(d, bottom) == 0) {
+        bottom++;
+    }
+
+    // The sign, the digits, the point and the terminating 0.
+    char* s = malloc((top + 1 - bottom) * WORD_DIGITS + 3);
+    char* end = s;
+    if (d->sign == NEGATIVE && !is_dec_zero(d)) {
+        *end++ = '-';
+    }
+    end += sprintf(end, "%lu", get_limb(d, top));
+    ssize_t limb_idx;
+    for (limb_idx = top - 1; limb_idx >= 0; limb_idx--) {
+        end += sprintf(end, "%019lu", get_limb(d, limb_idx));
+    }
+    if (bottom < 0) {
+        *end++ = '.';
+        for (limb_idx = -1; limb_idx >= bottom; limb_idx--) {
+            end += sprintf(end, "%019lu", get_limb(d, limb_idx));
+        }
+        while (end[-1] == '0') {
+            end--;
+        }
+        *end = 0;
+    }
+    return s;
+}
+
+word parse_limb(char* digits, size_t num_digits) {
+    word w = 0;
+    size_t i;
+    for (i = 0; i < num_digits; i++) {
+        w = 10*w + (digits[i] - '0');
+    }
+    return w;
+}
+
+struct DecReal* decimal_str_to_dec_real(char* decimal_str) {
+    enum sign_t sign = POSITIVE;
+    char* int_digits = decimal_str;
+    if (int_digits[0] == '-') {
+        sign = NEGATIVE;
+        int_digits++;
+    }
+
+    size_t num_int_digits = strspn(int_digits, "0123456789");
+    char* frac_digits = int_digits + num_int_digits;
+    size_t num_frac_digits = 0;
+    if (frac_digits[0] == '.') {
+        frac_digits++;
+        num_frac_digits = strspn(frac_digits, "0123456789");
+    }
+    if (frac_digits[num_frac_digits] != 0 ||
+        num_int_digits + num_frac_digits == 0) {
+        puts("Invalid decimal string!");
+        return NULL;
+    }
+
+    ssize_t num_int_limbs = MAX(1, (num_int_digits + WORD_DIGITS - 1)
+                                / WORD_DIGITS);
+    ssize_t num_frac_limbs = (num_frac_digits + WORD_DIGITS - 1) / WORD_DIGITS;
+    struct DecReal* d = alloc_dec_real(sign, -num_frac_limbs, num_int_limbs);
+
+    // Integer limbs are grouped from the point up, and fractional ones
+    // from the point down, padded with zeros at the end.
+    ssize_t limb_idx;
+    size_t end, start;
+    for (limb_idx = 0; limb_idx < num_int_limbs; limb_idx++) {
+        end = num_int_digits - MIN(num_int_digits,
+                                   (size_t) limb_idx * WORD_DIGITS);
+        start = end - MIN(end, WORD_DIGITS);
+        set_limb(d, limb_idx, parse_limb(int_digits + start, end - start));
+    }
+    word limb;
+    size_t i;
+    for (limb_idx = -1; limb_idx >= -num_frac_limbs; limb_idx--) {
+        start = (-1 - limb_idx) * WORD_DIGITS;
+        end = MIN(start + WORD_DIGITS, num_frac_digits);
+        limb = parse_limb(frac_digits + start, end - start);
+        for (i = end - start; i < WORD_DIGITS; i++) {
+            limb *= 10;
+        }
+        set_limb(d, limb_idx, limb);
+    }
+
+    trim_dec_zeros(d);
+    return d;
+}
@@ -0,0 +1,92 @@
+#ifndef DECREAL_H
+#define DECREAL_H
+
+#include "real.h"
+
+// Reals in base 10^19, for work whose results are printed in decimal.
+//
+// A struct DecReal is laid out like a struct Real, except that each of
+// its words, called limbs here, is a base 10^19 digit: the value is the
+// sum of limb_i * 10^(19 i) over its range of limb indices, so limb 0 is
+// the units and limb -1 holds the first 19 digits after the point.
+// Converting one to a decimal string is just printing its limbs, with
+// none of the divide-and-conquer of `real_to_decimal_str`.
+//
+// The functions mirror the struct Real ones in arithmetic.h, with the
+// same truncation towards 0 at `min_sig_limb_idx`. They are slower per
+// digit than the binary ones, since every carry is a division by 10^19,
+// so code that mostly computes and rarely prints should convert with
+// `real_to_dec_real` and `dec_real_to_real` instead.
+
+struct DecReal;
+
+// Returns 0 with limbs at indices in [`min_limb_idx`, `max_limb_idx`),
+// or NULL if the range is empty.
+struct DecReal* alloc_dec_real(enum sign_t sign,
+                               ssize_t min_limb_idx,
+                               ssize_t max_limb_idx);
+
+// Like `fill_real`: the varargs are the limbs, least significant first,
+// and there must be `max_limb_idx - min_limb_idx` of them.
+struct DecReal* fill_dec_real(enum sign_t sign,
+                              ssize_t min_limb_idx,
+                              ssize_t max_limb_idx,
+                              ...);
+
+struct DecReal* copy_dec_real(struct DecReal* d);
+void free_dec_real(struct DecReal* d);
+
+enum sign_t get_dec_sign(struct DecReal* d);
+void set_dec_sign(struct DecReal* d, enum sign_t sign);
+ssize_t get_min_limb_idx(struct DecReal* d);
+ssize_t get_max_limb_idx(struct DecReal* d);
+
+// Returns 0 for indices outside the range of `d`.
+word get_limb(struct DecReal* d, ssize_t limb_idx);
+// `limb_idx` must be in the range of `d`, and `limb` below 10^19.
+void set_limb(struct DecReal* d, ssize_t limb_idx, word limb);
+
+int is_dec_zero(struct DecReal* d);
+
+// Narrows the range of `d` to its non-zero limbs, in-place.
+void trim_dec_zeros(struct DecReal* d);
+
+// Drops the limbs of `d` below `min_sig_limb_idx`, in-place.
+void truncate_dec_real(struct DecReal* d, ssize_t min_sig_limb_idx);
+
+struct DecReal* dec_add(struct DecReal* d1, struct DecReal* d2);
+struct DecReal* dec_subtract(struct DecReal* d1, struct DecReal* d2);
+struct DecReal* dec_multiply(struct DecReal* d1, struct DecReal* d2);
+
+// Ignores the partial products below `min_sig_limb_idx`, like
+// `mul_with_sig`. Operands at least `thresholds.karatsuba_min_words`
+// limbs long are multiplied with Karatsuba.
+struct DecReal* dec_mul_with_sig(struct DecReal* d1, struct DecReal* d2,
+                                 ssize_t min_sig_limb_idx);
+
+// Unlike `div_with_sig`, `divisor` can be any non-zero word. Returns NULL
+// if it's 0.
+struct DecReal* dec_div_with_sig(struct DecReal* d, word divisor,
+                                 ssize_t min_sig_limb_idx);
+
+// The same argument reduction and double-angle steps as `cos_with_sig`.
+// Returns NULL if the computation is cancelled (see progress.h).
+struct DecReal* dec_cos_with_sig(struct DecReal* theta,
+                                 ssize_t min_sig_limb_idx);
+
+// Conversions. `real_to_dec_real` is truncated towards 0 at
+// `min_sig_limb_idx`; `dec_real_to_real` is accurate to within a few
+// units of the word at `min_sig_word_idx`, and returns NULL if it's
+// cancelled.
+struct DecReal* real_to_dec_real(struct Real* r, ssize_t min_sig_limb_idx);
+struct Real* dec_real_to_real(struct DecReal* d, ssize_t min_sig_word_idx);
+
+// The same format as `real_to_decimal_str`, without trailing zeros after
+// the point. The caller frees the result.
+char* dec_real_to_decimal_str(struct DecReal* d);
+
+// Parses the same strings as `decimal_str_to_real`, exactly. Returns NULL
+// if the string isn't a decimal number.
+struct DecReal* decimal_str_to_dec_real(char* decimal_str);
+
+#endif
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "digitfile.h"
+
+// Prints digits after the point from a digit file, e.g. one written by
+// `newton_pi -D`:
+//
+//   digit_range <digit_file> <position> [num_digits]
+//
+// Position 0 is the first digit after the point. Only the blocks that
+// hold the digits are read.
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 4) {
+        puts("usage: digit_range <digit_file> <position> [num_digits]");
+        return 1;
+    }
+
+    struct DigitFile* f = open_digit_file(argv[1]);
+    if (f == NULL) {
+        printf("Can't open digit file %s!\n", argv[1]);
+        return 1;
+    }
+    size_t position = strtoul(argv[2], NULL, 0);
+    size_t num_digits = (argc > 3) ? strtoul(argv[3], NULL, 0) : 50;
+
+    char* digits = malloc(num_digits + 1);
+    int rtn = 0;
+    if (read_digits(f, position, num_digits, digits) == 0) {
+        printf("%s\n", digits);
+    } else {
+        printf("Can't read %zu digits at %zu of %zu!\n", num_digits,
+               position, get_num_digits(f));
+        rtn = 1;
+    }
+    free(digits);
+    close_digit_file(f);
+
+    return rtn;
+}
@@ -0,0 +1,300 @@
+#include "digitfile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "decimal.h"
+
+
+#define DIGIT_FILE_MAGIC "RDIGIT01"
+
+#define MAX_INTEGER_DIGITS 64
+
+struct DigitFileHeader {
+    char magic[8];
+    uint64_t num_digits;
+    uint64_t num_words;
+    uint64_t block_words;
+    uint64_t num_blocks;
+    uint64_t index_checksum;
+    // With a "-" for negative numbers, and 0-terminated.
+    char integer_digits[MAX_INTEGER_DIGITS];
+};
+
+struct DigitBlock {
+    // The position of the block's words in the file, in bytes.
+    uint64_t offset;
+    uint64_t checksum;
+};
+
+enum block_state_t {
+    BLOCK_UNCHECKED,
+    BLOCK_OK,
+    BLOCK_CORRUPT
+};
+
+struct DigitFile {
+    void* map;
+    size_t map_size;
+    struct DigitFileHeader* header;
+    struct DigitBlock* index;
+    // An `enum block_state_t` for each block. These are only ever set
+    // from BLOCK_UNCHECKED to the same answer, so threads can share them.
+    unsigned char* block_states;
+};
+
+uint64_t checksum_words(const uint64_t* words, size_t num_words) {
+    // FNV-1a, a word at a time.
+    uint64_t h = 0xcbf29ce484222325ul;
+    size_t i;
+    for (i = 0; i < num_words; i++) {
+        h ^= words[i];
+        h *= 0x100000001b3ul;
+    }
+    return h;
+}
+
+size_t block_num_words(struct DigitFileHeader* header, size_t block_idx) {
+    size_t start = block_idx * header->block_words;
+    return MIN(header->block_words, header->num_words - start);
+}
+
+
+// Writing.
+
+int write_digit_file(char* path, struct Real* r, size_t num_digits) {
+    struct DigitFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DIGIT_FILE_MAGIC, sizeof(header.magic));
+
+    struct Real* integer = div_with_sig(r, 1, 0);
+    struct Real* fraction = subtract(r, integer);
+    set_sign(fraction, POSITIVE);
+    set_sign(integer, POSITIVE);
+    char* integer_digits = real_to_decimal_str(integer);
+    int negative = (get_sign(r) == NEGATIVE && !is_zero(r));
+    free_real(integer);
+    if (strlen(integer_digits) + negative >= MAX_INTEGER_DIGITS) {
+        puts("Integer part too long for a digit file!");
+        free(integer_digits);
+        free_real(fraction);
+        return -1;
+    }
+    snprintf(header.integer_digits, MAX_INTEGER_DIGITS, "%s%s",
+             negative ? "-" : "", integer_digits);
+    free(integer_digits);
+
+    header.num_digits = num_digits;
+    header.num_words = (num_digits + WORD_DIGITS - 1) / WORD_DIGITS;
+    header.block_words = DIGIT_BLOCK_WORDS;
+    header.num_blocks = ((header.num_words + DIGIT_BLOCK_WORDS - 1)
+                         / DIGIT_BLOCK_WORDS);
+
+    word* words = fraction_to_radix_words(fraction, header.num_words);
+    free_real(fraction);
+
+    // Truncate to exactly `num_digits` digits, so the file doesn't
+    // depend on how many extra digits we happened to compute.
+    size_t extra_digits = WORD_DIGITS*header.num_words - num_digits;
+    word unit = 1;
+    size_t i;
+    for (i = 0; i < extra_digits; i++) {
+        unit *= 10;
+    }
+    if (header.num_words > 0) {
+        words[header.num_words - 1] -= words[header.num_words - 1] % unit;
+    }
+
+    struct DigitBlock* index = malloc(MAX(header.num_blocks, 1)
+                                      * sizeof(struct DigitBlock));
+    uint64_t offset = (sizeof(header)
+                       + header.num_blocks * sizeof(struct DigitBlock));
+    for (i = 0; i < header.num_blocks; i++) {
+        index[i].offset = offset;
+        index[i].checksum = checksum_words(words + i*DIGIT_BLOCK_WORDS,
+                                           block_num_words(&header, i));
+        offset += block_num_words(&header, i) * sizeof(word);
+    }
+    header.index_checksum = checksum_words((uint64_t*) index,
+                                           header.num_blocks * 2);
+
+    int rtn = 0;
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) {
+        rtn = -1;
+    } else {
+        if (fwrite(&header, sizeof(header), 1, f) != 1 ||
+            fwrite(index, sizeof(struct DigitBlock), header.num_blocks, f)
+            != header.num_blocks ||
+            fwrite(words, sizeof(word), header.num_words, f)
+            != header.num_words) {
+            rtn = -1;
+        }
+        if (fclose(f) != 0) {
+            rtn = -1;
+        }
+    }
+
+    free(index);
+    free(words);
+    return rtn;
+}
+
+
+// Reading.
+
+int check_header(struct DigitFile* f) {
+    // Returns 0 if the header and the index are consistent with each
+    // other and with the size of the file, and -1 otherwise.
+    // The sizes are rounded up without adding first, which could wrap
+    // around for a corrupt header.
+    struct DigitFileHeader* header = f->header;
+    if (f->map_size < sizeof(struct DigitFileHeader) ||
+        memcmp(header->magic, DIGIT_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        memchr(header->integer_digits, 0, MAX_INTEGER_DIGITS) == NULL ||
+        header->block_words == 0 ||
+        header->num_words != (header->num_digits / WORD_DIGITS
+                              + (header->num_digits % WORD_DIGITS != 0)) ||
+        header->num_blocks != (header->num_words / header->block_words
+                               + (header->num_words % header->block_words
+                                  != 0))) {
+        return -1;
+    }
+    // The index and the words both have to fit in the file.
+    size_t map_words = (f->map_size - sizeof(struct DigitFileHeader))
+        / sizeof(word);
+    if (header->num_blocks > map_words / 2 ||
+        header->num_words > map_words - 2*header->num_blocks) {
+        return -1;
+    }
+    if (checksum_words((uint64_t*) f->index, header->num_blocks * 2)
+        != header->index_checksum) {
+        return -1;
+    }
+
+    size_t i;
+    struct DigitBlock* block;
+    for (i = 0; i < header->num_blocks; i++) {
+        block = &f->index[i];
+        if (block->offset % sizeof(word) != 0 ||
+            block->offset > f->map_size ||
+            (f->map_size - block->offset) / sizeof(word)
+            < block_num_words(header, i)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+struct DigitFile* open_digit_file(char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // The mapping stays valid after the file is closed.
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    struct DigitFile* f = malloc(sizeof(struct DigitFile));
+    f->map = map;
+    f->map_size = st.st_size;
+    f->header = (struct DigitFileHeader*) map;
+    f->index = (struct DigitBlock*) ((char*) map
+                                     + sizeof(struct DigitFileHeader));
+    f->block_states = NULL;
+    if (check_header(f) != 0) {
+        close_digit_file(f);
+        return NULL;
+    }
+    f->block_states = calloc(MAX(f->header->num_blocks, 1), 1);
+    return f;
+}
+
+void close_digit_file(struct DigitFile* f) {
+    munmap(f->map, f->map_size);
+    free(f->block_states);
+    free(f);
+}
+
+char* get_integer_digits(struct DigitFile* f) {
+    return f->header->integer_digits;
+}
+
+size_t get_num_digits(struct DigitFile* f) {
+    return f->header->num_digits;
+}
+
+const word* get_block_words(struct DigitFile* f, size_t block_idx) {
+    // Returns the words of a block, or NULL if it's corrupt or past the
+    // end.
+    if (block_idx >= f->header->num_blocks) {
+        return NULL;
+    }
+    const word* words = (const word*) ((char*) f->map
+                                       + f->index[block_idx].offset);
+    unsigned char state = __atomic_load_n(&f->block_states[block_idx],
+                                          __ATOMIC_RELAXED);
+    if (state == BLOCK_UNCHECKED) {
+        state = (checksum_words(words, block_num_words(f->header, block_idx))
+                 == f->index[block_idx].checksum) ? BLOCK_OK : BLOCK_CORRUPT;
+        __atomic_store_n(&f->block_states[block_idx], state,
+                         __ATOMIC_RELAXED);
+    }
+    return (state == BLOCK_OK) ? words : NULL;
+}
+
+int read_digits(struct DigitFile* f, size_t position, size_t num_digits,
+                char* digits) {
+    if (position > f->header->num_digits ||
+        num_digits > f->header->num_digits - position) {
+        return -1;
+    }
+
+    size_t block_words = f->header->block_words;
+    size_t word_idx = position / WORD_DIGITS;
+    size_t digit_idx = position % WORD_DIGITS;
+    size_t written = 0;
+    size_t block_idx = (size_t) -1;
+    const word* block = NULL;
+    char word_digits[WORD_DIGITS];
+    word w;
+    int i;
+    while (written < num_digits) {
+        if (word_idx / block_words != block_idx) {
+            block_idx = word_idx / block_words;
+            block = get_block_words(f, block_idx);
+            if (block == NULL) {
+                return -1;
+            }
+        }
+
+        w = block[word_idx % block_words];
+        for (i = WORD_DIGITS - 1; i >= 0; i--) {
+            word_digits[i] = '0' + w % 10;
+            w /= 10;
+        }
+        for (; digit_idx < WORD_DIGITS && written < num_digits; digit_idx++) {
+            digits[written++] = word_digits[digit_idx];
+        }
+        digit_idx = 0;
+        word_idx++;
+    }
+    digits[written] = 0;
+    return 0;
+}
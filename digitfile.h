@@ -0,0 +1,50 @@
+#ifndef DIGITFILE_H
+#define DIGITFILE_H
+
+#include "real.h"
+
+// On-disk stores of the decimal digits of a number, for answering "digits
+// n through n+k" without converting or loading the whole thing.
+//
+// The file starts with a header holding the integer part as text and the
+// number of digits after the point. Those digits follow packed 19 to a
+// word, most significant first, in blocks of DIGIT_BLOCK_WORDS words. A
+// block index between the header and the digits has a checksum for each
+// block, and the header has a checksum of the index. Everything is in
+// native byte order.
+//
+// Readers mmap the file, so any number of processes can share it through
+// the page cache, and a query only touches the blocks it needs.
+
+#define DIGIT_BLOCK_WORDS 1024
+
+struct DigitFile;
+
+// Writes the integer part and the first `num_digits` digits after the
+// point of `r` (truncated, not rounded) to `path`. Returns 0 on success
+// and -1 on error.
+int write_digit_file(char* path, struct Real* r, size_t num_digits);
+
+// Opens and maps a file written by `write_digit_file`. Returns NULL if it
+// can't be opened or isn't a valid digit file.
+struct DigitFile* open_digit_file(char* path);
+
+void close_digit_file(struct DigitFile* f);
+
+// Returns the integer part, with a "-" if the number is negative. It
+// belongs to `f`.
+char* get_integer_digits(struct DigitFile* f);
+
+// Returns the number of digits after the point.
+size_t get_num_digits(struct DigitFile* f);
+
+// Copies the `num_digits` digits after the point starting at `position`
+// (where 0 is the first one) into `digits`, followed by a 0 byte.
+//
+// Each block is checked against its checksum the first time it's read.
+// Returns 0 on success and -1 if the range is out of bounds or a block
+// is corrupt.
+int read_digits(struct DigitFile* f, size_t position, size_t num_digits,
+                char* digits);
+
+#endif
@@ -0,0 +1,480 @@
+#include "exp_log.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "constants.h"
+#include "progress.h"
+
+
+// Binary splitting.
+
+struct Series {
+    // Sets `p` and `q` such that term `k` of the series is term `k-1`
+    // times p/q. Term 0 is always 1.
+    void (*ratio)(void* params, word k, struct Real** p, struct Real** q);
+    void* params;
+};
+
+void binary_split(struct Series* series, word a, word b,
+                  struct Real** p, struct Real** q, struct Real** t) {
+    // Computes P = p(a)...p(b-1), Q = q(a)...q(b-1) and T such that T/Q
+    // is the sum of terms `a` through `b-1`, relative to term `a-1`.
+    // All of the arithmetic is exact.
+    if (b - a == 1) {
+        series->ratio(series->params, a, p, q);
+        *t = copy_real(*p);
+        checkpoint(a);
+        return;
+    }
+
+    word mid = a + (b - a) / 2;
+    struct Real* p_left = NULL;
+    struct Real* q_left;
+    struct Real* t_left;
+    struct Real* p_right;
+    struct Real* q_right;
+    struct Real* t_right;
+    if (!is_cancelled()) {
+        binary_split(series, a, mid, &p_left, &q_left, &t_left);
+        binary_split(series, mid, b, &p_right, &q_right, &t_right);
+    }
+    if (is_cancelled()) {
+        // Unwind without the big products; `sum_split_series` throws all
+        // of this away.
+        *p = fill_real(POSITIVE, 0, 1, 1);
+        *q = fill_real(POSITIVE, 0, 1, 1);
+        *t = fill_real(POSITIVE, 0, 1, 0);
+        if (p_left == NULL) {
+            return;
+        }
+    } else {
+        // T = T_left Q_right + P_left T_right
+        *t = multiply(t_left, q_right);
+        fma_with_sig(*t, p_left, t_right,
+                     get_min_word_idx(p_left) + get_min_word_idx(t_right));
+
+        *p = multiply(p_left, p_right);
+        *q = multiply(q_left, q_right);
+
+        // Exact products of short fractions carry a lot of zero words.
+        trim_zeros(*p);
+        trim_zeros(*q);
+        trim_zeros(*t);
+    }
+
+    free_real(p_left);
+    free_real(q_left);
+    free_real(t_left);
+    free_real(p_right);
+    free_real(q_right);
+    free_real(t_right);
+}
+
+struct Real* sum_split_series(struct Series* series, word num_terms,
+                              ssize_t min_sig_word_idx) {
+    // Returns the sum of terms 0 through `num_terms`, or NULL if the
+    // computation is cancelled.
+    struct Real* p;
+    struct Real* q;
+    struct Real* t;
+    begin_stage("series term", num_terms);
+    binary_split(series, 1, num_terms + 1, &p, &q, &t);
+    end_stage();
+
+    struct Real* quotient = NULL;
+    if (!is_cancelled()) {
+        quotient = div_real_with_sig(t, q, min_sig_word_idx);
+    }
+    free_real(p);
+    free_real(q);
+    free_real(t);
+    if (quotient == NULL) {
+        return NULL;
+    }
+
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* rtn = add(one, quotient);
+    free_real(one);
+    free_real(quotient);
+    return rtn;
+}
+
+word series_length(ssize_t bits_per_power, ssize_t target_bits) {
+    // Returns the number of terms needed so that the first omitted term
+    // x^m/m! is below 2^-target_bits, given |x| < 2^-bits_per_power.
+    // Summing floor(log2(j)) gives a lower bound for log2(m!), so the
+    // result is conservative.
+    ssize_t log2_factorial = 0;
+    word m = 1;
+    while ((ssize_t) m * bits_per_power + log2_factorial <= target_bits) {
+        m++;
+        log2_factorial += WORD_BITS - 1 - __builtin_clzl(m);
+    }
+    return m;
+}
+
+
+// Constants.
+
+void ln2_ratio(void* params, word k, struct Real** p, struct Real** q) {
+    // ln(2) = 3/4 sum_k (-1)^k (k!)^2 / (2^k (2k+1)!), so the ratio
+    // between consecutive terms is -k / (4 (2k+1)).
+    (void) params;
+    *p = fill_real(NEGATIVE, 0, 1, k);
+    *q = fill_real(POSITIVE, 0, 1, 4 * (2*k + 1));
+}
+
+struct Real* ln2_with_sig(ssize_t min_sig_word_idx) {
+    // Each term is at least 3 bits smaller than the one before.
+    ssize_t target_bits = -min_sig_word_idx*WORD_BITS + WORD_BITS;
+    struct Series series = {ln2_ratio, NULL};
+    struct Real* s = sum_split_series(&series, target_bits / 3 + 2,
+                                      min_sig_word_idx - 1);
+    if (s == NULL) {
+        return NULL;
+    }
+    // 3s/4 = (2s + s)/4
+    struct Real* temp = shift_left_bits(s, 1);
+    add_to(temp, s);
+    struct Real* rtn = shift_right_bits(temp, 2);
+    truncate_real(rtn, min_sig_word_idx);
+
+    free_real(s);
+    free_real(temp);
+    return rtn;
+}
+
+struct Real* halve(struct Real* r, ssize_t min_sig_word_idx) {
+    struct Real* rtn = shift_right_bits(r, 1);
+    truncate_real(rtn, min_sig_word_idx);
+    return rtn;
+}
+
+int agm_step(struct Real** a, struct Real** b, ssize_t min_sig_word_idx) {
+    // (a, b) <- ((a + b)/2, sqrt(a b))
+    // Returns -1, with `b` set to NULL, if the computation is cancelled.
+    struct Real* sum = add(*a, *b);
+    struct Real* product = mul_with_sig(*a, *b, min_sig_word_idx - 1);
+    free_real(*a);
+    free_real(*b);
+    *a = halve(sum, min_sig_word_idx);
+    *b = sqrt_with_sig(product, min_sig_word_idx);
+    free_real(sum);
+    free_real(product);
+    return (*b == NULL) ? -1 : 0;
+}
+
+word agm_steps(ssize_t target_bits) {
+    // The AGM roughly doubles the number of correct bits each step, so
+    // this estimates how many steps it takes.
+    word steps = 1;
+    while (((ssize_t) 2 << steps) < target_bits) {
+        steps++;
+    }
+    return steps;
+}
+
+int agm_converged(struct Real* a, struct Real* b, ssize_t min_sig_word_idx) {
+    // The AGM converges quadratically, so once |a - b| is below the square
+    // root of the precision, one more step is enough.
+    struct Real* diff = subtract(a, b);
+    int rtn = is_zero(diff) || get_exponent(diff) <= min_sig_word_idx*32;
+    free_real(diff);
+    return rtn;
+}
+
+struct Real* pi_with_sig(ssize_t min_sig_word_idx) {
+    // a = 1, b = 1/sqrt(2), t = 1/4, and then for k = 0, 1, ...
+    //   a' = (a + b)/2, b' = sqrt(a b), t' = t - 2^k (a - a')^2
+    // and pi ~ (a + b)^2 / (4 t).
+    ssize_t sig = min_sig_word_idx - 1;
+
+    struct Real* a = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* half = fill_real(POSITIVE, -1, 0, (word) 1 << (WORD_BITS - 1));
+    struct Real* b = sqrt_with_sig(half, sig);
+    struct Real* t = fill_real(POSITIVE, -1, 0, (word) 1 << (WORD_BITS - 2));
+    free_real(half);
+
+    struct Real* old_a;
+    struct Real* diff;
+    struct Real* diff_squared;
+    struct Real* temp;
+    ssize_t k = 0;
+    int last_step = 0;
+    begin_stage("AGM step", agm_steps(-sig*WORD_BITS));
+    while (b != NULL) {
+        if (checkpoint(k)) {
+            free_real(b);
+            b = NULL;
+            break;
+        }
+        if (agm_converged(a, b, sig)) {
+            last_step = 1;
+        }
+
+        old_a = copy_real(a);
+        if (agm_step(&a, &b, sig) != 0) {
+            free_real(old_a);
+            break;
+        }
+
+        diff = subtract(old_a, a);
+        diff_squared = mul_with_sig(diff, diff, sig - 1);
+        temp = shift_left_bits(diff_squared, k);
+        truncate_real(temp, sig);
+        subtract_from(t, temp);
+
+        free_real(old_a);
+        free_real(diff);
+        free_real(diff_squared);
+        free_real(temp);
+
+        k++;
+        if (last_step) {
+            break;
+        }
+    }
+    end_stage();
+    if (b == NULL) {
+        free_real(a);
+        free_real(t);
+        return NULL;
+    }
+
+    struct Real* sum = add(a, b);
+    struct Real* sum_squared = mul_with_sig(sum, sum, sig);
+    struct Real* four_t = shift_left_bits(t, 2);
+    struct Real* rtn = div_real_with_sig(sum_squared, four_t,
+                                         min_sig_word_idx);
+
+    free_real(a);
+    free_real(b);
+    free_real(t);
+    free_real(sum);
+    free_real(sum_squared);
+    free_real(four_t);
+    return rtn;
+}
+
+
+// Exponential.
+
+void exp_ratio(void* params, word k, struct Real** p, struct Real** q) {
+    // The ratio between consecutive terms of e^x is x/k.
+    *p = copy_real((struct Real*) params);
+    *q = fill_real(POSITIVE, 0, 1, k);
+}
+
+struct Real* extract_bits(struct Real* r, ssize_t low_bit_idx,
+                          ssize_t high_bit_idx) {
+    // Returns the part of `r` made of the bits at indices `low_bit_idx`
+    // through `high_bit_idx - 1`, with no extra zero words.
+    ssize_t low_word_idx = floor_div(low_bit_idx, WORD_BITS);
+    ssize_t high_word_idx = floor_div(high_bit_idx - 1, WORD_BITS) + 1;
+    struct Real* rtn = alloc_real(get_sign(r), low_word_idx, high_word_idx);
+
+    ssize_t word_idx;
+    word w;
+    for (word_idx = low_word_idx; word_idx < high_word_idx; word_idx++) {
+        w = get_word(r, word_idx);
+        if (word_idx == low_word_idx) {
+            w &= ~(((word) 1 << (low_bit_idx - word_idx*WORD_BITS)) - 1);
+        }
+        if (word_idx == high_word_idx - 1 &&
+            high_bit_idx - word_idx*WORD_BITS < WORD_BITS) {
+            w &= ((word) 1 << (high_bit_idx - word_idx*WORD_BITS)) - 1;
+        }
+        set_word(rtn, word_idx, w);
+    }
+    trim_zeros(rtn);
+    return rtn;
+}
+
+struct Real* exp_reduced(struct Real* r, ssize_t min_sig_word_idx) {
+    // Computes e^r for |r| < 1/2.
+    // Split r into pieces r_j made of the fractional bits 2^-i for
+    // 2^j <= i < 2^(j+1). Then |r_j| < 2^-(2^j - 1) and r_j has 2^j bits,
+    // so the series for e^(r_j) needs fewer terms the more bits r_j has,
+    // the numbers in its binary splitting stay about as big as the
+    // result, and every piece costs O(M(n) log n).
+    ssize_t target_bits = -min_sig_word_idx*WORD_BITS;
+    struct Real* rtn = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* piece;
+    struct Real* factor;
+    struct Real* temp;
+    struct Series series;
+
+    ssize_t j;
+    ssize_t num_pieces = 0;
+    while (((ssize_t) 1 << num_pieces) <= target_bits) {
+        num_pieces++;
+    }
+    begin_stage("exp factor", num_pieces);
+    for (j = 0; j < num_pieces; j++) {
+        if (checkpoint(j)) {
+            free_real(rtn);
+            rtn = NULL;
+            break;
+        }
+        piece = extract_bits(r,
+                             MAX(-((ssize_t) 1 << (j + 1)) + 1,
+                                 min_sig_word_idx*WORD_BITS),
+                             -((ssize_t) 1 << j) + 1);
+
+        if (!is_zero(piece)) {
+            series.ratio = exp_ratio;
+            series.params = piece;
+            factor = sum_split_series(&series,
+                                      series_length(((ssize_t) 1 << j) - 1,
+                                                    target_bits),
+                                      min_sig_word_idx - 1);
+            if (factor == NULL) {
+                free_real(piece);
+                free_real(rtn);
+                rtn = NULL;
+                break;
+            }
+            temp = mul_with_sig(rtn, factor, min_sig_word_idx - 1);
+            free_real(rtn);
+            free_real(factor);
+            rtn = temp;
+            trim_most_significant_zeros(rtn);
+        }
+        free_real(piece);
+    }
+    end_stage();
+    return rtn;
+}
+
+struct Real* exp_with_sig(struct Real* x, ssize_t min_sig_word_idx) {
+    if (is_zero(x)) {
+        return fill_real(POSITIVE, 0, 1, 1);
+    } else if (get_exponent(x) > WORD_BITS / 2) {
+        puts("Argument to exp is too large!");
+        return NULL;
+    }
+
+    // x = n ln(2) + r
+    double x_approx = ldexp(top_as_double(x), get_exponent(x));
+    if (get_sign(x) == NEGATIVE) {
+        x_approx = -x_approx;
+    }
+    ssize_t n = (ssize_t) llround(x_approx / M_LN2);
+    word abs_n = (n < 0) ? -n : n;
+
+    // The result gets multiplied by 2^n, and so does the error in e^r.
+    ssize_t work = (min_sig_word_idx - (MAX(0, n) + WORD_BITS - 1) / WORD_BITS
+                    - 2);
+
+    // The error in ln(2) gets multiplied by n.
+    struct Real* ln2 = get_constant(CONSTANT_LN2, work - 2);
+    if (ln2 == NULL) {
+        return NULL;
+    }
+    struct Real* n_real = fill_real(n < 0 ? NEGATIVE : POSITIVE, 0, 1, abs_n);
+    struct Real* n_ln2 = multiply(ln2, n_real);
+    struct Real* temp = subtract(x, n_ln2);
+    struct Real* r = div_with_sig(temp, 1, work);
+    free_real(ln2);
+    free_real(n_real);
+    free_real(n_ln2);
+    free_real(temp);
+
+    struct Real* e_r = exp_reduced(r, work);
+    free_real(r);
+    if (e_r == NULL) {
+        return NULL;
+    }
+    struct Real* rtn = shift_left_bits(e_r, n);
+    truncate_real(rtn, min_sig_word_idx);
+
+    free_real(e_r);
+    return rtn;
+}
+
+
+// Logarithm.
+
+struct Real* log_with_sig(struct Real* x, ssize_t min_sig_word_idx) {
+    if (is_zero(x) || get_sign(x) == NEGATIVE) {
+        puts("Logarithm of non-positive number!");
+        return NULL;
+    }
+
+    ssize_t work = min_sig_word_idx - 2;
+    ssize_t target_bits = MAX(-work*WORD_BITS, WORD_BITS);
+
+    // ln(s) = pi / (2 AGM(1, 4/s)) + O(ln(s) / s^2), so make s = x 2^m
+    // bigger than 2^(target_bits/2), with room for the ln(s) factor.
+    ssize_t m = target_bits / 2 + WORD_BITS / 2 - get_exponent(x);
+    struct Real* s = shift_left_bits(x, m);
+
+    // The first AGM steps work with numbers as small as 4/s, which need
+    // as many extra words as s has to keep their relative precision.
+    ssize_t agm_work = work - (get_exponent(s) + WORD_BITS - 1) / WORD_BITS;
+
+    struct Real* a = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* four = fill_real(POSITIVE, 0, 1, 4);
+    struct Real* b = div_real_with_sig(four, s, agm_work);
+    free_real(four);
+    free_real(s);
+
+    // The AGM first has to bring b up from 4/s to about a.
+    word step = 0;
+    int last_step = 0;
+    begin_stage("AGM step", agm_steps(target_bits) + agm_steps(m) + 1);
+    while (b != NULL) {
+        if (checkpoint(step++)) {
+            free_real(b);
+            b = NULL;
+            break;
+        }
+        if (agm_converged(a, b, agm_work)) {
+            last_step = 1;
+        }
+        if (agm_step(&a, &b, agm_work) != 0 || last_step) {
+            break;
+        }
+    }
+    end_stage();
+    if (b == NULL) {
+        free_real(a);
+        return NULL;
+    }
+
+    // ln(x) = ln(s) - m ln(2)
+    struct Real* pi = get_constant(CONSTANT_PI, work);
+    struct Real* two_agm = add(a, b);
+    struct Real* ln_s = NULL;
+    if (pi != NULL) {
+        ln_s = div_real_with_sig(pi, two_agm, work);
+        free_real(pi);
+    }
+    free_real(two_agm);
+    free_real(a);
+    free_real(b);
+    if (ln_s == NULL) {
+        return NULL;
+    }
+
+    word abs_m = (m < 0) ? -m : m;
+    struct Real* ln2 = get_constant(CONSTANT_LN2, work - 1);
+    if (ln2 == NULL) {
+        free_real(ln_s);
+        return NULL;
+    }
+    struct Real* m_real = fill_real(m < 0 ? NEGATIVE : POSITIVE, 0, 1, abs_m);
+    struct Real* m_ln2 = multiply(ln2, m_real);
+    struct Real* diff = subtract(ln_s, m_ln2);
+    struct Real* rtn = div_with_sig(diff, 1, min_sig_word_idx);
+
+    free_real(ln_s);
+    free_real(ln2);
+    free_real(m_real);
+    free_real(m_ln2);
+    free_real(diff);
+    return rtn;
+}
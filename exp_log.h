@@ -0,0 +1,42 @@
+#ifndef EXP_LOG_H
+#define EXP_LOG_H
+
+#include "real.h"
+
+// Exponentials, logarithms and the constants they need, keeping only
+// words at or above `min_sig_word_idx`.
+//
+// All results are accurate to within a few units of the word at
+// `min_sig_word_idx`. They all report their progress, and return NULL if
+// the computation is cancelled (see progress.h).
+
+// Computes e^x.
+//
+// The argument is reduced to x = n ln(2) + r with |r| < 0.36, and e^r is
+// split into a product of e^(r_j), where each r_j holds twice as many
+// bits as the one before. Each factor is summed with binary splitting,
+// so the total cost is O(M(n) log n) rather than O(n) full-precision
+// multiplies. Returns NULL if |x| is too large for the result to be
+// represented.
+struct Real* exp_with_sig(struct Real* x, ssize_t min_sig_word_idx);
+
+// Computes ln(x) with the arithmetic-geometric mean:
+// ln(s) ~ pi / (2 AGM(1, 4/s)) for large s = x 2^m.
+// pi and ln(2) come from the constant cache.
+//
+// Returns NULL if `x` is not positive.
+struct Real* log_with_sig(struct Real* x, ssize_t min_sig_word_idx);
+
+// Computes pi with the Gauss-Legendre (AGM) iteration.
+//
+// This always computes pi from scratch; use `get_constant` from
+// constants.h for a cached value.
+struct Real* pi_with_sig(ssize_t min_sig_word_idx);
+
+// Computes ln(2) by binary splitting.
+//
+// This always computes ln(2) from scratch; use `get_constant` from
+// constants.h for a cached value.
+struct Real* ln2_with_sig(ssize_t min_sig_word_idx);
+
+#endif
@@ -0,0 +1,402 @@
+#include "expr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "trig.h"
+#include "exp_log.h"
+#include "constants.h"
+
+
+// Values that still can't be told apart from 0 this many words below
+// the requested precision are treated as 0.
+#define MAX_EXTRA_WORDS 64
+
+
+enum expr_kind_t {
+    EXPR_CONST,
+    EXPR_PI,
+    EXPR_NEG,
+    EXPR_ADD,
+    EXPR_SUB,
+    EXPR_MUL,
+    EXPR_DIV,
+    EXPR_SQRT,
+    EXPR_EXP,
+    EXPR_LOG,
+    EXPR_COS,
+    EXPR_SIN
+};
+
+struct Expr {
+    enum expr_kind_t kind;
+    struct Expr* args[2];
+    int refcount;
+
+    // The best approximation so far, or NULL. It is within
+    // 2^(64 * approx_sig_word_idx) of the exact value.
+    struct Real* approx;
+    ssize_t approx_sig_word_idx;
+};
+
+
+struct Expr* new_expr(enum expr_kind_t kind,
+                      struct Expr* a, struct Expr* b) {
+    struct Expr* e = malloc(sizeof(struct Expr));
+    e->kind = kind;
+    e->args[0] = (a != NULL) ? retain_expr(a) : NULL;
+    e->args[1] = (b != NULL) ? retain_expr(b) : NULL;
+    e->refcount = 1;
+    e->approx = NULL;
+    e->approx_sig_word_idx = 1;
+    return e;
+}
+
+struct Expr* const_expr(struct Real* r) {
+    struct Expr* e = new_expr(EXPR_CONST, NULL, NULL);
+    e->approx = copy_real(r);
+    // The value is exact, so any index below its words is a valid bound
+    // on the error.
+    e->approx_sig_word_idx = get_min_word_idx(r) - 1;
+    return e;
+}
+
+struct Expr* pi_expr(void) {
+    return new_expr(EXPR_PI, NULL, NULL);
+}
+
+struct Expr* neg_expr(struct Expr* a) {
+    return new_expr(EXPR_NEG, a, NULL);
+}
+
+struct Expr* add_expr(struct Expr* a, struct Expr* b) {
+    return new_expr(EXPR_ADD, a, b);
+}
+
+struct Expr* sub_expr(struct Expr* a, struct Expr* b) {
+    return new_expr(EXPR_SUB, a, b);
+}
+
+struct Expr* mul_expr(struct Expr* a, struct Expr* b) {
+    return new_expr(EXPR_MUL, a, b);
+}
+
+struct Expr* div_expr(struct Expr* a, struct Expr* b) {
+    return new_expr(EXPR_DIV, a, b);
+}
+
+struct Expr* sqrt_expr(struct Expr* a) {
+    return new_expr(EXPR_SQRT, a, NULL);
+}
+
+struct Expr* exp_expr(struct Expr* a) {
+    return new_expr(EXPR_EXP, a, NULL);
+}
+
+struct Expr* log_expr(struct Expr* a) {
+    return new_expr(EXPR_LOG, a, NULL);
+}
+
+struct Expr* cos_expr(struct Expr* a) {
+    return new_expr(EXPR_COS, a, NULL);
+}
+
+struct Expr* sin_expr(struct Expr* a) {
+    return new_expr(EXPR_SIN, a, NULL);
+}
+
+struct Expr* retain_expr(struct Expr* e) {
+    e->refcount++;
+    return e;
+}
+
+void release_expr(struct Expr* e) {
+    e->refcount--;
+    if (e->refcount > 0) {
+        return;
+    }
+
+    int i;
+    for (i = 0; i < 2; i++) {
+        if (e->args[i] != NULL) {
+            release_expr(e->args[i]);
+        }
+    }
+    if (e->approx != NULL) {
+        free_real(e->approx);
+    }
+    free(e);
+}
+
+ssize_t get_expr_precision(struct Expr* e) {
+    return e->approx_sig_word_idx;
+}
+
+
+int refine(struct Expr* e, ssize_t min_sig_word_idx);
+
+ssize_t bit_to_word_idx(ssize_t bit_idx) {
+    // Returns the largest word index whose unit is at most 2^bit_idx.
+    return floor_div(bit_idx, WORD_BITS);
+}
+
+int upper_exponent(struct Expr* e, ssize_t min_sig_word_idx,
+                   ssize_t* exponent) {
+    // Finds an `exponent` with |e| < 2^exponent. Any cached approximation
+    // is good enough for this.
+    if (e->approx == NULL && refine(e, min_sig_word_idx) != 0) {
+        return -1;
+    }
+
+    ssize_t error_exponent = e->approx_sig_word_idx*WORD_BITS;
+    if (is_zero(e->approx)) {
+        *exponent = error_exponent + 1;
+    } else {
+        *exponent = MAX(get_exponent(e->approx), error_exponent) + 1;
+    }
+    return 0;
+}
+
+int lower_exponent(struct Expr* e, ssize_t min_sig_word_idx,
+                   ssize_t* exponent) {
+    // Finds an `exponent` with |e| >= 2^exponent, refining `e` until its
+    // approximation is at least twice its error.
+    ssize_t sig = min_sig_word_idx;
+    ssize_t approx_exponent;
+    while (1) {
+        if (refine(e, sig) != 0) {
+            return -1;
+        }
+
+        approx_exponent = get_exponent(e->approx);
+        if (!is_zero(e->approx) &&
+            approx_exponent >= e->approx_sig_word_idx*WORD_BITS + 2) {
+            *exponent = approx_exponent - 2;
+            return 0;
+        }
+
+        if (sig < min_sig_word_idx - MAX_EXTRA_WORDS) {
+            puts("Expression is indistinguishable from 0!");
+            return -1;
+        }
+        sig = MIN(2*sig - 1, sig - 1);
+    }
+}
+
+struct Real* compute_mul(struct Expr* a, struct Expr* b,
+                         ssize_t min_sig_word_idx) {
+    // |a'b' - ab| <= |a| |b' - b| + |b'| |a' - a|, so each error needs
+    // to be small relative to the size of the other factor.
+    ssize_t a_exponent, b_exponent;
+    if (upper_exponent(a, min_sig_word_idx, &a_exponent) != 0 ||
+        upper_exponent(b, min_sig_word_idx, &b_exponent) != 0) {
+        return NULL;
+    }
+
+    ssize_t bit_idx = min_sig_word_idx*WORD_BITS;
+    if (refine(a, bit_to_word_idx(bit_idx - b_exponent - 3)) != 0 ||
+        refine(b, bit_to_word_idx(bit_idx - a_exponent - 3)) != 0) {
+        return NULL;
+    }
+
+    return mul_with_sig(a->approx, b->approx, min_sig_word_idx - 2);
+}
+
+struct Real* compute_div(struct Expr* a, struct Expr* b,
+                         ssize_t min_sig_word_idx) {
+    // With |b| >= 2^L and |b'| >= 2^(L-1),
+    // |a'/b' - a/b| <= |a' - a| 2^(1-L) + |a| |b' - b| 2^(1-2L).
+    ssize_t a_exponent, b_exponent;
+    if (lower_exponent(b, min_sig_word_idx, &b_exponent) != 0 ||
+        upper_exponent(a, min_sig_word_idx, &a_exponent) != 0) {
+        return NULL;
+    }
+
+    ssize_t bit_idx = min_sig_word_idx*WORD_BITS;
+    ssize_t b_sig = MIN(bit_to_word_idx(bit_idx + 2*b_exponent
+                                        - a_exponent - 3),
+                        bit_to_word_idx(b_exponent - 1));
+    if (refine(a, bit_to_word_idx(bit_idx + b_exponent - 3)) != 0 ||
+        refine(b, b_sig) != 0) {
+        return NULL;
+    }
+
+    return div_real_with_sig(a->approx, b->approx, min_sig_word_idx - 1);
+}
+
+struct Real* compute_sqrt(struct Expr* a, ssize_t min_sig_word_idx) {
+    // |sqrt(a') - sqrt(a)| <= sqrt(|a' - a|), which holds even near 0.
+    if (refine(a, 2*min_sig_word_idx - 1) != 0) {
+        return NULL;
+    }
+
+    if (get_sign(a->approx) == NEGATIVE && !is_zero(a->approx)) {
+        if (get_exponent(a->approx) > a->approx_sig_word_idx*WORD_BITS) {
+            puts("Square root of a negative expression!");
+            return NULL;
+        }
+        // `a` is within the error of 0.
+        return fill_real(POSITIVE, 0, 1, 0);
+    }
+    return sqrt_with_sig(a->approx, min_sig_word_idx - 1);
+}
+
+struct Real* compute_exp(struct Expr* a, ssize_t min_sig_word_idx) {
+    // |e^a' - e^a| <= e^a |e^(a' - a) - 1| <= 2 e^a |a' - a|,
+    // so we need an upper bound on a.
+    if (a->approx == NULL && refine(a, min_sig_word_idx) != 0) {
+        return NULL;
+    }
+
+    double upper = ldexp(1.0, a->approx_sig_word_idx*WORD_BITS);
+    if (!is_zero(a->approx)) {
+        double approx = ldexp(top_as_double(a->approx),
+                              get_exponent(a->approx));
+        upper += (get_sign(a->approx) == NEGATIVE) ? -approx : approx;
+    }
+    if (upper > ldexp(1.0, WORD_BITS / 2)) {
+        puts("Argument to exp is too large!");
+        return NULL;
+    }
+
+    // e^a < 2^result_exponent
+    ssize_t result_exponent = (ssize_t) ceil(upper * M_LOG2E) + 1;
+    ssize_t bit_idx = min_sig_word_idx*WORD_BITS;
+    if (refine(a, bit_to_word_idx(bit_idx - result_exponent - 2)) != 0) {
+        return NULL;
+    }
+
+    return exp_with_sig(a->approx, min_sig_word_idx - 1);
+}
+
+struct Real* compute_log(struct Expr* a, ssize_t min_sig_word_idx) {
+    // With a, a' >= 2^(L-1), |ln(a') - ln(a)| <= |a' - a| 2^(1-L).
+    ssize_t a_exponent;
+    if (lower_exponent(a, min_sig_word_idx, &a_exponent) != 0) {
+        return NULL;
+    }
+    if (get_sign(a->approx) == NEGATIVE) {
+        puts("Log of a negative expression!");
+        return NULL;
+    }
+
+    ssize_t bit_idx = min_sig_word_idx*WORD_BITS;
+    ssize_t a_sig = MIN(bit_to_word_idx(bit_idx + a_exponent - 2),
+                        bit_to_word_idx(a_exponent - 1));
+    if (refine(a, a_sig) != 0) {
+        return NULL;
+    }
+
+    return log_with_sig(a->approx, min_sig_word_idx - 1);
+}
+
+struct Real* compute(struct Expr* e, ssize_t min_sig_word_idx) {
+    // Computes `e` to within 2^(64 * min_sig_word_idx), or returns NULL.
+    // Library functions are called one word below that, so their own
+    // rounding error is negligible.
+    struct Expr* a = e->args[0];
+    struct Expr* b = e->args[1];
+    struct Real* rtn = NULL;
+
+    switch (e->kind) {
+    case EXPR_CONST:
+        // Constants are always exact and never get here.
+        break;
+    case EXPR_PI:
+        rtn = get_constant(CONSTANT_PI, min_sig_word_idx - 1);
+        break;
+    case EXPR_NEG:
+        if (refine(a, min_sig_word_idx) == 0) {
+            rtn = copy_real(a->approx);
+            negate(rtn);
+        }
+        break;
+    case EXPR_ADD:
+    case EXPR_SUB:
+        if (refine(a, min_sig_word_idx - 1) == 0 &&
+            refine(b, min_sig_word_idx - 1) == 0) {
+            if (e->kind == EXPR_ADD) {
+                rtn = add(a->approx, b->approx);
+            } else {
+                rtn = subtract(a->approx, b->approx);
+            }
+        }
+        break;
+    case EXPR_MUL:
+        rtn = compute_mul(a, b, min_sig_word_idx);
+        break;
+    case EXPR_DIV:
+        rtn = compute_div(a, b, min_sig_word_idx);
+        break;
+    case EXPR_SQRT:
+        rtn = compute_sqrt(a, min_sig_word_idx);
+        break;
+    case EXPR_EXP:
+        rtn = compute_exp(a, min_sig_word_idx);
+        break;
+    case EXPR_LOG:
+        rtn = compute_log(a, min_sig_word_idx);
+        break;
+    case EXPR_COS:
+    case EXPR_SIN:
+        // Both are 1-Lipschitz.
+        if (refine(a, min_sig_word_idx - 1) == 0) {
+            if (e->kind == EXPR_COS) {
+                rtn = cos_with_sig(a->approx, min_sig_word_idx - 1);
+            } else {
+                rtn = sin_with_sig(a->approx, min_sig_word_idx - 1);
+            }
+        }
+        break;
+    }
+
+    if (rtn != NULL) {
+        trim_zeros(rtn);
+    }
+    return rtn;
+}
+
+int refine(struct Expr* e, ssize_t min_sig_word_idx) {
+    // Makes sure `e`'s cached approximation is at least as precise as
+    // `min_sig_word_idx`. Returns 0 on success and -1 on failure.
+    if (e->approx != NULL &&
+        (e->kind == EXPR_CONST ||
+         e->approx_sig_word_idx <= min_sig_word_idx)) {
+        return 0;
+    }
+
+    // If we've been here before, go to at least twice as many words so a
+    // sequence of slowly-increasing requests doesn't recompute every time.
+    ssize_t sig = min_sig_word_idx;
+    if (e->approx != NULL) {
+        sig = MIN(min_sig_word_idx, 2*e->approx_sig_word_idx - 1);
+    }
+
+    struct Real* r = compute(e, sig);
+    if (r == NULL) {
+        return -1;
+    }
+    if (e->approx != NULL) {
+        free_real(e->approx);
+    }
+    e->approx = r;
+    e->approx_sig_word_idx = sig;
+    return 0;
+}
+
+struct Real* eval_expr(struct Expr* e, ssize_t min_sig_word_idx) {
+    if (refine(e, min_sig_word_idx) != 0) {
+        return NULL;
+    }
+
+    // The cache may be far more precise than what was asked for. Cutting
+    // it off one word down keeps the total error below 2^(64 * sig).
+    if (e->kind != EXPR_CONST &&
+        e->approx_sig_word_idx >= min_sig_word_idx - 1) {
+        return copy_real(e->approx);
+    }
+    return div_with_sig(e->approx, 1, min_sig_word_idx - 1);
+}
@@ -0,0 +1,60 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include "real.h"
+
+// Lazily-evaluated exact real expressions.
+//
+// An expression is a DAG of nodes that is built without doing any
+// arithmetic. Evaluating a node to some `min_sig_word_idx` works out how
+// precise each of its children need to be and evaluates them first, so
+// the caller only ever picks the precision of the final result.
+//
+// Every node caches its best approximation so far. A query at or below
+// the cached precision is answered from the cache, and a query above it
+// recomputes the node at (at least) twice the cached number of words.
+//
+// Nodes are reference counted. The constructors take their own
+// references to their arguments, so the caller still has to release
+// every node it creates. None of this is thread-safe.
+
+struct Expr;
+
+// A node with the value of `r`. `r` is copied.
+struct Expr* const_expr(struct Real* r);
+
+// A node with the value pi.
+struct Expr* pi_expr(void);
+
+struct Expr* neg_expr(struct Expr* a);
+struct Expr* add_expr(struct Expr* a, struct Expr* b);
+struct Expr* sub_expr(struct Expr* a, struct Expr* b);
+struct Expr* mul_expr(struct Expr* a, struct Expr* b);
+struct Expr* div_expr(struct Expr* a, struct Expr* b);
+
+struct Expr* sqrt_expr(struct Expr* a);
+struct Expr* exp_expr(struct Expr* a);
+struct Expr* log_expr(struct Expr* a);
+struct Expr* cos_expr(struct Expr* a);
+struct Expr* sin_expr(struct Expr* a);
+
+// Takes another reference to `e` and returns it.
+struct Expr* retain_expr(struct Expr* e);
+
+// Drops a reference to `e`, freeing it (and releasing its arguments)
+// when none are left.
+void release_expr(struct Expr* e);
+
+// Returns a value within 2^(64 * min_sig_word_idx) of the exact value of
+// `e`. The caller owns the result.
+//
+// Returns NULL if the expression can't be evaluated, e.g. if it divides
+// by a value that is 0 (or too close to 0 to tell) or takes the log of
+// a non-positive value.
+struct Real* eval_expr(struct Expr* e, ssize_t min_sig_word_idx);
+
+// Returns the `min_sig_word_idx` of `e`'s cached approximation, or 1 if
+// it hasn't been evaluated.
+ssize_t get_expr_precision(struct Expr* e);
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef FIXED_REAL_HPP
+#define FIXED_REAL_HPP
+
+// Fixed-width reals for small precisions.
+//
+// `real::fixed::Real<N, F>` is a sign and N words on the stack, the
+// bottom F of which are after the point, so it holds the words of a
+// struct Real at indices [-F, N - F). There's no heap, no range of
+// indices to check and no half-word loops: the arithmetic works on
+// whole words with 128-bit products, in loops of fixed length that the
+// compiler unrolls when optimizing. Everything is constexpr, so
+// constants can be built at compile time:
+//
+//   constexpr real::fixed::Real<4> third = real::fixed::Real<4>(1) / 3;
+//
+// Results are truncated towards 0 at word -F, like `truncate_real`, and
+// anything that doesn't fit below word N - F is lost, like overflowing
+// an unsigned integer. Convert to and from struct Real at the edges of
+// the code that needs the speed.
+
+#include <cstddef>
+
+extern "C" {
+#include "real.h"
+}
+
+namespace real {
+namespace fixed {
+
+typedef unsigned __int128 dword;
+
+template <int N, int F = N - 1>
+class Real {
+    static_assert(N > 0 && F >= 0 && F <= N, "bad fixed-width layout");
+
+public:
+    constexpr Real() : sign_(POSITIVE), words_() {}
+    constexpr Real(word w, enum sign_t sign = POSITIVE)
+        : sign_(sign), words_() {
+        if (F < N) {
+            words_[F] = w;
+        }
+        normalize();
+    }
+
+    // The words at indices -F, -F + 1, ..., least significant first.
+    static constexpr Real from_words(enum sign_t sign,
+                                     const word (&words)[N]) {
+        Real r;
+        r.sign_ = sign;
+        for (int i = 0; i < N; i++) {
+            r.words_[i] = words[i];
+        }
+        r.normalize();
+        return r;
+    }
+
+    // Keeps the words of `r` in [-F, N - F).
+    static Real from_real(struct ::Real* r) {
+        Real rtn;
+        rtn.sign_ = get_sign(r);
+        for (int i = 0; i < N; i++) {
+            rtn.words_[i] = get_word(r, i - F);
+        }
+        rtn.normalize();
+        return rtn;
+    }
+
+    // The caller owns the result.
+    struct ::Real* to_real() const {
+        struct ::Real* r = alloc_real(sign_, -F, N - F);
+        for (int i = 0; i < N; i++) {
+            set_word(r, i - F, words_[i]);
+        }
+        return r;
+    }
+
+    constexpr word get_word_at(int word_idx) const {
+        return words_[word_idx + F];
+    }
+    constexpr enum sign_t sign() const { return sign_; }
+    constexpr bool is_zero() const {
+        for (int i = 0; i < N; i++) {
+            if (words_[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr Real operator-() const {
+        Real r = *this;
+        r.sign_ = (sign_ == POSITIVE) ? NEGATIVE : POSITIVE;
+        r.normalize();
+        return r;
+    }
+
+    friend constexpr Real operator+(const Real& a, const Real& b) {
+        return add(a, b, b.sign_);
+    }
+    friend constexpr Real operator-(const Real& a, const Real& b) {
+        return add(a, b, (b.sign_ == POSITIVE) ? NEGATIVE : POSITIVE);
+    }
+
+    friend constexpr Real operator*(const Real& a, const Real& b) {
+        // The whole 2N-word product, of which words F to F + N - 1 are
+        // kept.
+        word product[2*N] = {};
+        for (int i = 0; i < N; i++) {
+            word carry = 0;
+            for (int j = 0; j < N; j++) {
+                dword t = (dword) a.words_[i] * b.words_[j]
+                    + product[i + j] + carry;
+                product[i + j] = (word) t;
+                carry = (word) (t >> WORD_BITS);
+            }
+            product[i + N] = carry;
+        }
+        Real r;
+        r.sign_ = (a.sign_ == b.sign_) ? POSITIVE : NEGATIVE;
+        for (int i = 0; i < N; i++) {
+            r.words_[i] = product[i + F];
+        }
+        r.normalize();
+        return r;
+    }
+
+    friend constexpr Real operator/(const Real& a, word divisor) {
+        Real r;
+        r.sign_ = a.sign_;
+        dword remainder = 0;
+        for (int i = N - 1; i >= 0; i--) {
+            dword t = (remainder << WORD_BITS) | a.words_[i];
+            r.words_[i] = (word) (t / divisor);
+            remainder = t % divisor;
+        }
+        r.normalize();
+        return r;
+    }
+
+    constexpr Real& operator+=(const Real& b) { return *this = *this + b; }
+    constexpr Real& operator-=(const Real& b) { return *this = *this - b; }
+    constexpr Real& operator*=(const Real& b) { return *this = *this * b; }
+    constexpr Real& operator/=(word divisor) {
+        return *this = *this / divisor;
+    }
+
+    friend constexpr bool operator==(const Real& a, const Real& b) {
+        if (a.sign_ != b.sign_) {
+            return false;
+        }
+        for (int i = 0; i < N; i++) {
+            if (a.words_[i] != b.words_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    friend constexpr bool operator!=(const Real& a, const Real& b) {
+        return !(a == b);
+    }
+    friend constexpr bool operator<(const Real& a, const Real& b) {
+        if (a.sign_ != b.sign_) {
+            return a.sign_ == NEGATIVE;
+        }
+        int c = compare_magnitudes(a, b);
+        return (a.sign_ == POSITIVE) ? (c < 0) : (c > 0);
+    }
+
+private:
+    constexpr void normalize() {
+        // 0 is always positive, so `==` can compare signs.
+        if (is_zero()) {
+            sign_ = POSITIVE;
+        }
+    }
+
+    static constexpr int compare_magnitudes(const Real& a, const Real& b) {
+        for (int i = N - 1; i >= 0; i--) {
+            if (a.words_[i] != b.words_[i]) {
+                return (a.words_[i] < b.words_[i]) ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static constexpr Real add(const Real& a, const Real& b,
+                              enum sign_t b_sign) {
+        // a + b, taking `b` to have the sign `b_sign`.
+        Real r;
+        word carry = 0;
+        if (a.sign_ == b_sign) {
+            r.sign_ = a.sign_;
+            for (int i = 0; i < N; i++) {
+                dword t = (dword) a.words_[i] + b.words_[i] + carry;
+                r.words_[i] = (word) t;
+                carry = (word) (t >> WORD_BITS);
+            }
+        } else {
+            // Subtract the smaller magnitude from the larger one.
+            const Real* big = &a;
+            const Real* small = &b;
+            r.sign_ = a.sign_;
+            if (compare_magnitudes(a, b) < 0) {
+                big = &b;
+                small = &a;
+                r.sign_ = b_sign;
+            }
+            for (int i = 0; i < N; i++) {
+                word w = big->words_[i] - small->words_[i] - carry;
+                carry = (big->words_[i] < small->words_[i])
+                    || (big->words_[i] - small->words_[i] < carry);
+                r.words_[i] = w;
+            }
+        }
+        r.normalize();
+        return r;
+    }
+
+    enum sign_t sign_;
+    word words_[N];
+};
+
+}  // namespace fixed
+}  // namespace real
+
+#endif
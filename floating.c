@@ -0,0 +1,189 @@
+#include "floating.h"
+
+#include "real.h"
+#include "arithmetic.h"
+
+
+int get_bit(struct Real* r, ssize_t bit_idx) {
+    // Returns the bit of `r` at the absolute bit index `bit_idx`, where
+    // bit index 0 is the units bit.
+    ssize_t word_idx = floor_div(bit_idx, WORD_BITS);
+    return (get_word(r, word_idx) >> (bit_idx - word_idx*WORD_BITS)) & 1;
+}
+
+int any_bits_below(struct Real* r, ssize_t bit_idx) {
+    // Returns 1 if any bit of `r` strictly below `bit_idx` is set.
+    ssize_t word_idx = floor_div(bit_idx, WORD_BITS);
+    ssize_t bit_offset = bit_idx - word_idx*WORD_BITS;
+
+    word mask = ((word) 1 << bit_offset) - 1;
+    if (get_word(r, word_idx) & mask) {
+        return 1;
+    }
+
+    ssize_t idx;
+    for (idx = get_min_word_idx(r);
+         idx < MIN(word_idx, get_max_word_idx(r));
+         idx++) {
+        if (get_word(r, idx) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void round_with_sticky(struct Real* r, struct FloatContext* ctx,
+                       int sticky) {
+    // Rounds `r` in-place to the precision of `ctx`.
+    // `sticky` says whether the exact value has nonzero bits below the
+    // words stored in `r`. Callers passing `sticky` = 1 must make sure
+    // that `r` holds at least one bit below the rounding bit.
+    trim_most_significant_zeros(r);
+    if (is_zero(r)) {
+        trim_zeros(r);
+        return;
+    }
+
+    // `low_bit_idx` is the least-significant bit we keep.
+    ssize_t low_bit_idx = get_exponent(r) - (ssize_t) ctx->precision;
+    if (get_min_word_idx(r)*WORD_BITS >= low_bit_idx) {
+        // There's nothing below the precision to get rid of.
+        trim_zeros(r);
+        return;
+    }
+
+    int round_up = 0;
+    if (ctx->rounding == ROUND_NEAREST &&
+        get_bit(r, low_bit_idx - 1)) {
+        // We are at least half-way to the next representable value, so
+        // round up unless this is an exact tie and we're already even.
+        if (sticky ||
+            any_bits_below(r, low_bit_idx - 1) ||
+            get_bit(r, low_bit_idx)) {
+            round_up = 1;
+        }
+    }
+
+    // Copy out the words we're keeping, clearing the bits below
+    // `low_bit_idx`.
+    ssize_t low_word_idx = floor_div(low_bit_idx, WORD_BITS);
+    ssize_t low_bit_offset = low_bit_idx - low_word_idx*WORD_BITS;
+    struct Real* t = alloc_real(get_sign(r),
+                                low_word_idx,
+                                get_max_word_idx(r));
+    ssize_t word_idx;
+    for (word_idx = low_word_idx;
+         word_idx < get_max_word_idx(r);
+         word_idx++) {
+        set_word(t, word_idx, get_word(r, word_idx));
+    }
+    set_word(t, low_word_idx,
+             get_word(t, low_word_idx) & ~(((word) 1 << low_bit_offset) - 1));
+
+    if (round_up) {
+        // Add one unit in the last place. Since `ulp` has the same sign as
+        // `t`, this increases the magnitude.
+        struct Real* ulp = fill_real(get_sign(r),
+                                     low_word_idx, low_word_idx + 1,
+                                     (word) 1 << low_bit_offset);
+        struct Real* temp = add(t, ulp);
+        free_real(ulp);
+        free_real(t);
+        t = temp;
+    }
+
+    trim_zeros(t);
+    move_real(r, t);
+}
+
+void round_to_precision(struct Real* r, struct FloatContext* ctx) {
+    round_with_sticky(r, ctx, 0);
+}
+
+struct Real* float_copy(struct FloatContext* ctx, struct Real* r) {
+    struct Real* rtn = copy_real(r);
+    round_to_precision(rtn, ctx);
+    return rtn;
+}
+
+struct Real* float_add(struct FloatContext* ctx,
+                       struct Real* r1, struct Real* r2) {
+    struct Real* s;
+
+    if (is_zero(r1)) {
+        return float_copy(ctx, r2);
+    } else if (is_zero(r2)) {
+        return float_copy(ctx, r1);
+    }
+
+    struct Real* big = r1;
+    struct Real* small = r2;
+    if (get_exponent(r2) > get_exponent(r1)) {
+        big = r2;
+        small = r1;
+    }
+
+    // If `small` lies entirely below the rounding bit of the result, only
+    // its sign and the fact that it's nonzero matter. Replace it with a
+    // single bit just below every bit of `big` so that the exact sum
+    // doesn't need a word for every place in between.
+    ssize_t proxy_bit_idx = MIN(get_exponent(big)
+                                - (ssize_t) ctx->precision - 3,
+                                get_min_word_idx(big)*WORD_BITS - 1);
+    if (get_exponent(small) <= proxy_bit_idx) {
+        ssize_t proxy_word_idx = floor_div(proxy_bit_idx, WORD_BITS);
+        struct Real* proxy = fill_real(get_sign(small),
+                                       proxy_word_idx, proxy_word_idx + 1,
+                                       (word) 1 << (proxy_bit_idx
+                                                    - proxy_word_idx
+                                                    * WORD_BITS));
+        s = add(big, proxy);
+        free_real(proxy);
+    } else {
+        s = add(r1, r2);
+    }
+
+    round_to_precision(s, ctx);
+    return s;
+}
+
+struct Real* float_subtract(struct FloatContext* ctx,
+                            struct Real* r1, struct Real* r2) {
+    negate(r2);
+    struct Real* s = float_add(ctx, r1, r2);
+    negate(r2);
+    return s;
+}
+
+struct Real* float_multiply(struct FloatContext* ctx,
+                            struct Real* r1, struct Real* r2) {
+    // The operands are already bounded by the precision, so the exact
+    // product is too.
+    struct Real* p = multiply(r1, r2);
+    round_to_precision(p, ctx);
+    return p;
+}
+
+struct Real* float_div_word(struct FloatContext* ctx,
+                            struct Real* r, word divisor) {
+    if (is_zero(r)) {
+        return fill_real(POSITIVE, 0, 1, 0);
+    }
+
+    // The quotient has an exponent of at least `get_exponent(r) - 64`, so
+    // this keeps at least 2 bits below its rounding bit.
+    ssize_t min_sig_word_idx = floor_div(get_exponent(r) - WORD_BITS
+                                         - (ssize_t) ctx->precision - 2,
+                                         WORD_BITS);
+    struct Real* q = div_with_sig(r, divisor, min_sig_word_idx);
+
+    // The division is inexact iff `q * divisor` doesn't give back `r`.
+    struct Real* d = fill_real(POSITIVE, 0, 1, divisor);
+    struct Real* check = multiply(q, d);
+    int sticky = !check_equal(check, r);
+    free_real(check);
+    free_real(d);
+
+    round_with_sticky(q, ctx, sticky);
+    return q;
+}
@@ -0,0 +1,51 @@
+#ifndef FLOATING_H
+#define FLOATING_H
+
+#include <stddef.h>
+
+#include "real.h"
+
+
+// Fixed-precision floating-point arithmetic on top of struct Real.
+//
+// Every operation computes its result and then rounds it to the
+// `precision` of the supplied context, so the number of words in a
+// result never grows beyond `precision / 64 + 2`. This keeps memory and
+// time per operation bounded in long iterative computations.
+
+enum round_t {
+    ROUND_NEAREST,  // Round to nearest, ties to even.
+    ROUND_ZERO      // Truncate towards 0.
+};
+
+struct FloatContext {
+    // The number of significant bits kept in every result.
+    size_t precision;
+    enum round_t rounding;
+};
+
+// Rounds `r` in-place to the precision of `ctx`.
+//
+// On return `r` is normalized: it has no leading or trailing zero
+// words, and 0 is represented as a single zero word at index 0.
+void round_to_precision(struct Real* r, struct FloatContext* ctx);
+
+// Returns a copy of `r` rounded to the precision of `ctx`.
+struct Real* float_copy(struct FloatContext* ctx, struct Real* r);
+
+// Arithmetic operations. Each one returns a newly-allocated result equal
+// to the exact result rounded to the precision of `ctx`.
+//
+// The operands are expected to be rounded to the context precision
+// already (e.g. results of other float_* calls); wider operands still
+// give correctly-rounded results but cost proportionally more.
+struct Real* float_add(struct FloatContext* ctx,
+                       struct Real* r1, struct Real* r2);
+struct Real* float_subtract(struct FloatContext* ctx,
+                            struct Real* r1, struct Real* r2);
+struct Real* float_multiply(struct FloatContext* ctx,
+                            struct Real* r1, struct Real* r2);
+struct Real* float_div_word(struct FloatContext* ctx,
+                            struct Real* r, word divisor);
+
+#endif
@@ -0,0 +1,176 @@
+#include "job.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "progress.h"
+#include "trig.h"
+#include "exp_log.h"
+
+
+struct Job {
+    enum job_kind_t kind;
+    struct Real* x;
+    ssize_t min_sig_word_idx;
+    double start;
+
+    struct Progress progress;
+    pthread_t thread;
+
+    // These are protected by `lock`.
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+    enum job_status_t status;
+    struct Real* result;
+};
+
+struct Real* run_computation(struct Job* job) {
+    switch (job->kind) {
+    case JOB_PI:
+        return pi_with_sig(job->min_sig_word_idx);
+    case JOB_SQRT:
+        return sqrt_with_sig(job->x, job->min_sig_word_idx);
+    case JOB_EXP:
+        return exp_with_sig(job->x, job->min_sig_word_idx);
+    case JOB_LOG:
+        return log_with_sig(job->x, job->min_sig_word_idx);
+    case JOB_COS:
+        return cos_with_sig(job->x, job->min_sig_word_idx);
+    case JOB_SIN:
+        return sin_with_sig(job->x, job->min_sig_word_idx);
+    }
+    return NULL;
+}
+
+void* run_job(void* arg) {
+    struct Job* job = (struct Job*) arg;
+
+    set_thread_progress(&job->progress);
+    struct Real* result = run_computation(job);
+    // A NULL result is either a cancellation or a bad argument.
+    int cancelled = is_cancelled();
+    set_thread_progress(NULL);
+
+    pthread_mutex_lock(&job->lock);
+    job->result = result;
+    if (result != NULL) {
+        job->status = JOB_DONE;
+    } else if (cancelled) {
+        job->status = JOB_CANCELLED;
+    } else {
+        job->status = JOB_FAILED;
+    }
+    pthread_cond_broadcast(&job->finished);
+    pthread_mutex_unlock(&job->lock);
+    return NULL;
+}
+
+struct Job* real_job_start(enum job_kind_t kind, struct JobParams* params) {
+    struct Job* job = malloc(sizeof(struct Job));
+    job->kind = kind;
+    job->x = (params->x != NULL) ? copy_real(params->x) : NULL;
+    job->min_sig_word_idx = params->min_sig_word_idx;
+    job->start = monotonic_seconds();
+    init_progress(&job->progress,
+                  (params->timeout > 0) ? job->start + params->timeout : 0);
+
+    pthread_mutex_init(&job->lock, NULL);
+    // Waits with a timeout measure it on the same clock as deadlines.
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&job->finished, &attr);
+    pthread_condattr_destroy(&attr);
+    job->status = JOB_RUNNING;
+    job->result = NULL;
+
+    if (kind != JOB_PI && job->x == NULL) {
+        puts("This job needs an argument!");
+    } else if (pthread_create(&job->thread, NULL, run_job, job) == 0) {
+        return job;
+    }
+
+    pthread_cond_destroy(&job->finished);
+    pthread_mutex_destroy(&job->lock);
+    if (job->x != NULL) {
+        free_real(job->x);
+    }
+    free(job);
+    return NULL;
+}
+
+void real_job_progress(struct Job* job, struct JobProgress* progress) {
+    pthread_mutex_lock(&job->lock);
+    progress->status = job->status;
+    pthread_mutex_unlock(&job->lock);
+
+    progress->elapsed = monotonic_seconds() - job->start;
+    if (progress->status == JOB_RUNNING) {
+        progress->num_stages = get_stages(&job->progress, progress->stages);
+    } else {
+        progress->num_stages = 0;
+    }
+}
+
+int real_job_wait(struct Job* job, double timeout) {
+    struct timespec until;
+    if (timeout >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &until);
+        double whole = floor(timeout);
+        until.tv_sec += (time_t) whole;
+        until.tv_nsec += (long) ((timeout - whole) * 1e9);
+        if (until.tv_nsec >= 1000000000) {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000;
+        }
+    }
+
+    int rtn = 0;
+    pthread_mutex_lock(&job->lock);
+    while (job->status == JOB_RUNNING) {
+        if (timeout < 0) {
+            pthread_cond_wait(&job->finished, &job->lock);
+        } else if (pthread_cond_timedwait(&job->finished, &job->lock,
+                                          &until) != 0) {
+            // Timed out, unless it finished just in time.
+            rtn = (job->status == JOB_RUNNING) ? -1 : 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&job->lock);
+    return rtn;
+}
+
+void real_job_cancel(struct Job* job) {
+    cancel_progress(&job->progress);
+}
+
+struct Real* real_job_result(struct Job* job) {
+    struct Real* rtn = NULL;
+    pthread_mutex_lock(&job->lock);
+    if (job->status == JOB_DONE) {
+        rtn = copy_real(job->result);
+    }
+    pthread_mutex_unlock(&job->lock);
+    return rtn;
+}
+
+void real_job_free(struct Job* job) {
+    real_job_cancel(job);
+    pthread_join(job->thread, NULL);
+
+    if (job->result != NULL) {
+        free_real(job->result);
+    }
+    if (job->x != NULL) {
+        free_real(job->x);
+    }
+    pthread_cond_destroy(&job->finished);
+    pthread_mutex_destroy(&job->lock);
+    free(job);
+}
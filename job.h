@@ -0,0 +1,77 @@
+#ifndef JOB_H
+#define JOB_H
+
+#include "real.h"
+#include "progress.h"
+
+// Computations that run on their own thread.
+//
+// `real_job_start` returns straight away with a handle to the running
+// computation. The caller can then poll its progress, wait for it with a
+// timeout, or cancel it. Cancelling is cooperative: the computation
+// notices at its next safe point (between Newton steps, series terms,
+// AGM steps, ...), frees what it was working on and finishes without a
+// result. A multiply is never interrupted, so the wait is at most about
+// one full-precision multiply. A job can also be given a deadline, after
+// which it cancels itself.
+
+enum job_kind_t {
+    JOB_PI,
+    JOB_SQRT,
+    JOB_EXP,
+    JOB_LOG,
+    JOB_COS,
+    JOB_SIN,
+};
+
+enum job_status_t {
+    JOB_RUNNING,
+    JOB_DONE,
+    JOB_CANCELLED,
+    // The computation couldn't be done, e.g. the log of a negative number.
+    JOB_FAILED,
+};
+
+struct JobParams {
+    // The argument, for every kind but JOB_PI. It is copied.
+    struct Real* x;
+    ssize_t min_sig_word_idx;
+    // Seconds after the start at which to cancel the job, or 0 for no
+    // deadline.
+    double timeout;
+};
+
+struct JobProgress {
+    enum job_status_t status;
+    // Seconds since the job started.
+    double elapsed;
+    // The nested stages the computation is in, outermost first.
+    int num_stages;
+    struct Stage stages[MAX_STAGES];
+};
+
+struct Job;
+
+// Starts computing `kind` with `params` on a new thread. Returns NULL if
+// the thread can't be started.
+struct Job* real_job_start(enum job_kind_t kind, struct JobParams* params);
+
+// Fills in `progress` with what `job` is doing right now.
+void real_job_progress(struct Job* job, struct JobProgress* progress);
+
+// Waits up to `timeout` seconds (or forever if `timeout` is negative) for
+// `job` to finish. Returns 0 if it has finished and -1 otherwise.
+int real_job_wait(struct Job* job, double timeout);
+
+// Asks `job` to stop at its next safe point. It then finishes as
+// JOB_CANCELLED, unless it was already done.
+void real_job_cancel(struct Job* job);
+
+// Returns a copy of the result of a job that is JOB_DONE, and NULL
+// otherwise. The caller owns the result.
+struct Real* real_job_result(struct Job* job);
+
+// Cancels `job` if it's still running, waits for it and frees it.
+void real_job_free(struct Job* job);
+
+#endif
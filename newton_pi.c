@@ -1,136 +1,130 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <unistd.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "arithmetic.h"
 #include "decimal.h"
+#include "trig.h"
+#include "digitfile.h"
+
+// Computes pi with Newton's method on cos(x) = 0, printing each iterate
+// x_n, p_n = 2 x_n and the error estimate:
+//
+//   newton_pi [-n steps] [-d digits] [-s seed] [-o output] [-D digit_file]
+//             [-f] [-k digits]
+//
+// -n caps the number of steps (10 by default), and -d stops once pi is
+// accurate to `digits` decimal places, without computing more than that.
+//
+// -s starts from a previously computed pi instead of 1.5, so extending
+// it only takes the extra steps. The seed is either a file written with
+// -o, which holds pi in the `write_real` format, truncated to the words
+// that are accurate, or a text file of decimal digits (like "3.14159...",
+// and whitespace is ignored), which are all taken to be correct.
+//
+// -D writes the digits of pi that are accurate to a digit file (see
+// digitfile.h) for `digit_range` to serve.
+//
+// -f only prints the final value, and -k only prints the first and last
+// `digits` digits of each value.
+//
+// Converting to decimal can take as long as a step, so it's done on
+// a background thread with copies of the values while the next step
+// runs.
+
+// At most this many snapshots wait to be printed before the steps wait
+// for the printing.
+#define MAX_PENDING 2
+
+struct Snapshot {
+    int step;
+    struct Real* x;
+    struct Real* d;
+    // The precision the next step computes the cosine to, or 1 if this
+    // is the final value.
+    ssize_t next_sig_word_idx;
+    time_t time;
+    struct Snapshot* next;
+};
+
+struct Reporter {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    struct Snapshot* head;
+    struct Snapshot* tail;
+    int num_pending;
+    int finished;
+    // 0 to print every digit.
+    size_t edge_digits;
+    pthread_t thread;
+};
+
+struct Real* read_seed(char* path, ssize_t* sig_word_idx) {
+    // Returns pi from `path`, and sets `sig_word_idx` to the word it's
+    // accurate to. Returns NULL if it can't be read.
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        printf("Can't open %s!\n", path);
+        return NULL;
+    }
 
-struct Real* get_threshold(struct Real* cos_est) {
-    // Compute a rough estimate for the threshold beneath which we can
-    // ignore cosine Taylor terms.
-    struct Real* est_squared = mul_with_rel_sig(cos_est, cos_est, 3);
-    struct Real* est_cubed = mul_with_rel_sig(cos_est, est_squared, 3);
-    struct Real* result = div_with_rel_sig(est_cubed, 12, 3);
-
-    /*
-    printf("  * est_squared = ");
-    print_decimal(est_squared);
-    printf("  * est_cubed   = ");
-    print_decimal(est_cubed);*/
-
-    free_real(est_squared);
-    free_real(est_cubed);
-    return result;
-}
-
-struct Real* get_next_term(struct Real* current_term,
-                           struct Real* theta_squared,
-                           word term_idx, ssize_t min_sig_word_idx) {
-    struct Real* temp1 = mul_with_sig(current_term, theta_squared,
-                                      min_sig_word_idx);
-    struct Real* temp2 = div_with_sig(temp1, 2*term_idx - 1,
-                                      min_sig_word_idx);
-    free_real(temp1);
-
-    struct Real* rtn = div_with_sig(temp2, 2*term_idx, min_sig_word_idx);
-    free_real(temp2);
-
-    negate(rtn);
-
-    return rtn;
-}
+    // A `write_real` file starts with the sign, which is a small integer
+    // and so starts with a 0 byte. A digit file starts with a digit.
+    int c = fgetc(f);
+    ungetc(c, f);
 
-struct Real* my_cos(struct Real* theta, ssize_t min_sig_word_idx) {
-    // Computes cos(theta) using the Taylor series, keeping only words at or
-    // above `min_sig_word_idx`.
-    // This is tailored to computations of pi, so we will stop
-    // computing when the terms drops below a pretty specific
-    // threshold.
-
-    // `cos_est` will hold our accumulated result. We've already
-    // accounted for the first term!
-    struct Real* cos_est = fill_real(POSITIVE, 0, 1, 1);
-
-    // `next_term` will be operated on to compute the next Taylor
-    // series term and then added to `cos_est` each iteration.
-    struct Real* next_term = fill_real(POSITIVE, 0, 1, 1);
-
-    // Since the Taylor series uses only even terms, we actually
-    // really need only `theta` squared.
-    struct Real* theta_squared = mul_with_sig(theta, theta,
-                                              min_sig_word_idx);
-
-    struct Real* temp;
-    struct Real* threshold;
-    int below_threshold;
-
-    printf("computing cosine with min_sig_word_idx = %ld\n", min_sig_word_idx);
-    /*
-    printf("Computing cosine for theta = ");
-    print_decimal(theta);
-    printf("min_sig_word_idx = %ld\n", min_sig_word_idx);
-    */
-
-    word term_idx = 1;
-    while (1) {
-        /*
-        printf("\nBeginning Taylor series term %ld\n", term_idx);
-        printf("- current estimate = ");
-        print_decimal(cos_est);
-        */
-
-        // Compute the next Taylor term.
-        temp = get_next_term(next_term, theta_squared, term_idx,
-                             min_sig_word_idx);
-        free_real(next_term);
-        next_term = temp;
-
-        /*
-        printf("- Taylor term = ");
-        print_decimal(next_term);
-        */
-
-        // Compute a threshold estimate.
-        threshold = get_threshold(cos_est);
-
-        /*
-        printf("- current threshold estimate = ");
-        print_decimal(threshold);
-        */
-
-        // We keep track of the sign in `next_term`, so we can just add.
-        temp = add(cos_est, next_term);
-        free_real(cos_est);
-        cos_est = temp;
-
-        // If the next term is below the threshold, stop.
-        below_threshold = greater_abs(threshold, next_term);
-        free_real(threshold);
-        if (below_threshold) {
-            break;
+    struct Real* pi = NULL;
+    if (c == 0) {
+        pi = read_real(f);
+        if (pi != NULL) {
+            *sig_word_idx = get_min_word_idx(pi);
         }
-
-        term_idx++;
+    } else {
+        size_t len = 0, capacity = 1 << 16;
+        char* digits = malloc(capacity);
+        while ((c = fgetc(f)) != EOF) {
+            if (isspace(c)) {
+                continue;
+            }
+            if (len + 1 == capacity) {
+                capacity *= 2;
+                digits = realloc(digits, capacity);
+            }
+            digits[len++] = (char) c;
+        }
+        digits[len] = 0;
+
+        pi = decimal_str_to_real(digits);
+        char* point = strchr(digits, '.');
+        size_t num_frac_digits = (point != NULL) ? strlen(point + 1) : 0;
+        // log2(10) > 3.32
+        *sig_word_idx = -(ssize_t) (num_frac_digits*332/100 / WORD_BITS);
+        free(digits);
     }
-    free_real(theta_squared);
-    free_real(next_term);
+    fclose(f);
 
-    printf("computed cosine using %ld terms\n", term_idx);
-
-    time_t t = time(NULL);
-    printf("time = %ld\n", t);
+    if (pi == NULL) {
+        printf("Can't read pi from %s!\n", path);
+    }
+    return pi;
+}
 
-    return cos_est;
+ssize_t step_precision(struct Real* d) {
+    trim_most_significant_zeros(d);
+    return get_max_word_idx(d) * 9 - 5;
 }
 
-void pi_step(struct Real** x, struct Real** d) {
+void pi_step(struct Real** x, struct Real** d, ssize_t min_sig_word_idx) {
     struct Real* new_x;
 
-    trim_most_significant_zeros(*d);
-    ssize_t min_sig_word_idx = get_max_word_idx(*d) * 9 - 5;
-
     free_real(*d);
+    *d = cos_with_sig(*x, min_sig_word_idx);
 
-    *d = my_cos(*x, min_sig_word_idx);
     new_x = add(*x, *d);
 
     free_real(*x);
@@ -138,44 +132,251 @@ void pi_step(struct Real** x, struct Real** d) {
     *x = new_x;
 }
 
-int main() {
-    // Initial guess: 1.5
-    struct Real* x = fill_real(POSITIVE, -1, 1,
-                               (word) 1 << (sizeof(word)*8 - 1),
-                               1);
+void print_value(char* name, int idx, char* relation, struct Real* r,
+                 size_t edge_digits) {
+    char* s = real_to_decimal_str(r);
+    size_t len = strlen(s);
+    size_t num_digits = len - (s[0] == '-') - (strchr(s, '.') != NULL);
+    if (edge_digits == 0 || len <= 2*edge_digits + 5) {
+        printf("%s_%d %s %s\n", name, idx, relation, s);
+    } else {
+        printf("%s_%d %s %.*s ... %s (%zu digits)\n", name, idx, relation,
+               (int) edge_digits, s, s + len - edge_digits, num_digits);
+    }
+    free(s);
+}
 
-    struct Real* two = fill_real(POSITIVE, 0, 1, 2);
-    struct Real* pi;
+void print_snapshot(struct Snapshot* snapshot, size_t edge_digits) {
+    printf("\n============= %d Newton steps ==================\n",
+           snapshot->step);
+    printf("time = %ld\n", snapshot->time);
 
-    // Initial error: ~ 0.1
-    struct Real* d = fill_real(POSITIVE, -1, 0,
-                               0x1999999999999999ul);
+    print_value("x", snapshot->step, "=", snapshot->x, edge_digits);
 
-    int newton_steps = 0;
-    while (newton_steps < 10) {
-        printf("\n============= %d Newton steps ==================\n",
-               newton_steps);
+    struct Real* pi = shift_left_bits(snapshot->x, 1);
+    print_value("p", snapshot->step, "=", pi, edge_digits);
+    free_real(pi);
 
-        pi = multiply(x, two);
+    print_value("eps", snapshot->step - 1, "~", snapshot->d, edge_digits);
 
-        printf("x_%d = ", newton_steps);
-        print_decimal(x);
+    printf("==================================================\n");
+    if (snapshot->next_sig_word_idx <= 0) {
+        printf("computing cosine with min_sig_word_idx = %ld\n",
+               snapshot->next_sig_word_idx);
+    }
+    fflush(stdout);
+}
 
-        printf("p_%d = ", newton_steps);
-        print_decimal(pi);
-        free_real(pi);
+void* run_reporter(void* arg) {
+    struct Reporter* reporter = (struct Reporter*) arg;
+    struct Snapshot* snapshot;
+
+    pthread_mutex_lock(&reporter->lock);
+    while (1) {
+        while (reporter->head == NULL && !reporter->finished) {
+            pthread_cond_wait(&reporter->changed, &reporter->lock);
+        }
+        if (reporter->head == NULL) {
+            break;
+        }
+        snapshot = reporter->head;
+        reporter->head = snapshot->next;
+        if (reporter->head == NULL) {
+            reporter->tail = NULL;
+        }
+        pthread_mutex_unlock(&reporter->lock);
 
-        printf("eps_%d ~ ", newton_steps - 1);
-        print_decimal(d);
+        print_snapshot(snapshot, reporter->edge_digits);
+        free_real(snapshot->x);
+        free_real(snapshot->d);
+        free(snapshot);
 
-        printf("==================================================\n\n");
+        pthread_mutex_lock(&reporter->lock);
+        reporter->num_pending--;
+        pthread_cond_broadcast(&reporter->changed);
+    }
+    pthread_mutex_unlock(&reporter->lock);
+    return NULL;
+}
 
-        pi_step(&x, &d);
+void report(struct Reporter* reporter, int step, struct Real* x,
+            struct Real* d, ssize_t next_sig_word_idx) {
+    // Hands copies of `x` and `d` to the reporter thread.
+    struct Snapshot* snapshot = malloc(sizeof(struct Snapshot));
+    snapshot->step = step;
+    snapshot->x = copy_real(x);
+    snapshot->d = copy_real(d);
+    snapshot->next_sig_word_idx = next_sig_word_idx;
+    snapshot->time = time(NULL);
+    snapshot->next = NULL;
+
+    pthread_mutex_lock(&reporter->lock);
+    while (reporter->num_pending >= MAX_PENDING) {
+        pthread_cond_wait(&reporter->changed, &reporter->lock);
+    }
+    if (reporter->tail != NULL) {
+        reporter->tail->next = snapshot;
+    } else {
+        reporter->head = snapshot;
+    }
+    reporter->tail = snapshot;
+    reporter->num_pending++;
+    pthread_cond_broadcast(&reporter->changed);
+    pthread_mutex_unlock(&reporter->lock);
+}
+
+void start_reporter(struct Reporter* reporter, size_t edge_digits) {
+    pthread_mutex_init(&reporter->lock, NULL);
+    pthread_cond_init(&reporter->changed, NULL);
+    reporter->head = NULL;
+    reporter->tail = NULL;
+    reporter->num_pending = 0;
+    reporter->finished = 0;
+    reporter->edge_digits = edge_digits;
+    pthread_create(&reporter->thread, NULL, run_reporter, reporter);
+}
+
+void finish_reporter(struct Reporter* reporter) {
+    // Waits for everything to be printed.
+    pthread_mutex_lock(&reporter->lock);
+    reporter->finished = 1;
+    pthread_cond_broadcast(&reporter->changed);
+    pthread_mutex_unlock(&reporter->lock);
+
+    pthread_join(reporter->thread, NULL);
+    pthread_cond_destroy(&reporter->changed);
+    pthread_mutex_destroy(&reporter->lock);
+}
+
+int main(int argc, char** argv) {
+    int num_steps = 10;
+    // 1 means there's no target.
+    ssize_t target_sig_word_idx = 1;
+    char* seed_path = NULL;
+    char* output_path = NULL;
+    char* digit_path = NULL;
+    int final_only = 0;
+    size_t edge_digits = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:d:s:o:D:fk:")) != -1) {
+        switch (opt) {
+        case 'n':
+            num_steps = atoi(optarg);
+            break;
+        case 'd':
+            target_sig_word_idx = -(ssize_t) ceil(atof(optarg) * log2(10)
+                                                  / WORD_BITS);
+            break;
+        case 's':
+            seed_path = optarg;
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        case 'D':
+            digit_path = optarg;
+            break;
+        case 'f':
+            final_only = 1;
+            break;
+        case 'k':
+            edge_digits = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            puts("usage: newton_pi [-n steps] [-d digits] [-s seed] "
+                 "[-o output] [-D digit_file] [-f] [-k digits]");
+            return 1;
+        }
+    }
+
+    struct Real* x;
+    struct Real* d;
+    // `x` is accurate to within a few units of the word here.
+    ssize_t accurate_word_idx;
+    struct Real* seed = NULL;
+    if (seed_path != NULL) {
+        seed = read_seed(seed_path, &accurate_word_idx);
+        if (seed == NULL) {
+            return 1;
+        }
+        // A seed without a whole word after the point is no better than
+        // 1.5, and its error would be too big for the first step.
+        if (accurate_word_idx > -2) {
+            free_real(seed);
+            seed = NULL;
+        }
+    }
+    if (seed != NULL) {
+        x = shift_right_bits(seed, 1);
+        free_real(seed);
+
+        // Assume the error is a unit in the word above, to be safe.
+        d = fill_real(POSITIVE, accurate_word_idx + 1,
+                      accurate_word_idx + 2, 1);
+    } else {
+        // Initial guess: 1.5
+        x = fill_real(POSITIVE, -1, 1,
+                      (word) 1 << (sizeof(word)*8 - 1),
+                      1);
+
+        // Initial error: ~ 0.1
+        d = fill_real(POSITIVE, -1, 0,
+                      0x1999999999999999ul);
+        accurate_word_idx = 0;
+    }
+
+    struct Reporter reporter;
+    start_reporter(&reporter, edge_digits);
+
+    int newton_steps = 0;
+    ssize_t min_sig_word_idx;
+    ssize_t error_word_idx;
+    while (newton_steps < num_steps &&
+           (target_sig_word_idx > 0 ||
+            accurate_word_idx > target_sig_word_idx)) {
+        min_sig_word_idx = step_precision(d);
+        // The error after a step is about d^3/6, but never below the
+        // precision of the cosine, so there's no point in going past
+        // the target.
+        if (target_sig_word_idx <= 0) {
+            min_sig_word_idx = MAX(min_sig_word_idx, target_sig_word_idx - 1);
+        }
+        error_word_idx = 3*get_max_word_idx(d);
+        if (!final_only) {
+            report(&reporter, newton_steps, x, d, min_sig_word_idx);
+        }
+
+        pi_step(&x, &d, min_sig_word_idx);
+        accurate_word_idx = MAX(error_word_idx, min_sig_word_idx + 1);
 
         newton_steps++;
     }
+    report(&reporter, newton_steps, x, d, 1);
+    finish_reporter(&reporter);
+
+    if (output_path != NULL) {
+        struct Real* pi = shift_left_bits(x, 1);
+        truncate_real(pi, accurate_word_idx);
+        FILE* f = fopen(output_path, "wb");
+        if (f == NULL || write_real(f, pi) != 0) {
+            printf("Can't write %s!\n", output_path);
+        }
+        if (f != NULL) {
+            fclose(f);
+        }
+        free_real(pi);
+    }
 
-    free_real(two);
+    if (digit_path != NULL) {
+        // log10(2) > 0.30102
+        struct Real* pi = shift_left_bits(x, 1);
+        size_t num_digits = -accurate_word_idx*WORD_BITS * 30102 / 100000;
+        if (write_digit_file(digit_path, pi, num_digits) != 0) {
+            printf("Can't write %s!\n", digit_path);
+        }
+        free_real(pi);
+    }
 
     free_real(x);
     free_real(d);
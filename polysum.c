@@ -0,0 +1,230 @@
+#include "polysum.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "real.h"
+#include "arithmetic.h"
+
+
+#define MAX_POLYSUM_THREADS 64
+
+
+struct Real* mul_word(struct Real* r, word w) {
+    struct Real* p = fill_real(POSITIVE, 0, 1, 0);
+    axpy(p, w, r);
+    trim_most_significant_zeros(p);
+    return p;
+}
+
+struct Real* eval_poly_at_word(struct Real** poly, int degree, word x) {
+    // Horner's method, with only small multiplies.
+    struct Real* value = copy_real(poly[degree]);
+    struct Real* next;
+    int i;
+    for (i = degree - 1; i >= 0; i--) {
+        next = copy_real(poly[i]);
+        axpy(next, x, value);
+        free_real(value);
+        value = next;
+    }
+    return value;
+}
+
+struct Real** polysum(struct Real** poly, int degree,
+                      struct Real** denominator) {
+    // P(x) = sum_k d_k C(x, k), where d_k is the k'th forward difference of
+    // P at 0, so
+    //
+    //   P(0) + ... + P(n) = sum_k d_k C(n + 1, k + 1)
+    //                     = sum_k a_k (n + 1) n ... (n + 1 - k) / D,
+    //
+    // with D = (degree + 1)! and a_k = d_k (degree + 1)! / (k + 1)!.
+    int i, k;
+
+    // Start with P(0), ..., P(degree) and difference them in place, so
+    // that diffs[k] ends up as d_k.
+    struct Real** diffs = malloc((degree + 1) * sizeof(struct Real*));
+    for (i = 0; i <= degree; i++) {
+        diffs[i] = eval_poly_at_word(poly, degree, i);
+    }
+    struct Real* p_0 = copy_real(diffs[0]);
+    for (k = 1; k <= degree; k++) {
+        for (i = degree; i >= k; i--) {
+            subtract_from(diffs[i], diffs[i - 1]);
+        }
+    }
+
+    // Scale to a_k, working down from a_degree so that each factor
+    // (degree + 1)! / (k + 1)! is one small multiply from the last.
+    struct Real* factor = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* temp;
+    for (k = degree; k >= 0; k--) {
+        temp = multiply(diffs[k], factor);
+        free_real(diffs[k]);
+        diffs[k] = temp;
+        temp = mul_word(factor, k + 1);
+        free_real(factor);
+        factor = temp;
+    }
+    // `factor` is now (degree + 1)!.
+    *denominator = factor;
+
+    // Multiply out the nested form
+    //
+    //   (n + 1)(a_0 + n (a_1 + (n - 1)(a_2 + ... (n - degree + 1) a_degree))),
+    //
+    // from the inside out. `sum` holds a polynomial in n of degree
+    // `sum_degree`.
+    struct Real** sum = malloc((degree + 2) * sizeof(struct Real*));
+    int sum_degree = 0;
+    sum[0] = copy_real(diffs[degree]);
+    for (k = degree - 1; k >= -1; k--) {
+        // sum <- sum * (n - k) (+ a_k), where the last step is n + 1.
+        sum[sum_degree + 1] = copy_real(sum[sum_degree]);
+        for (i = sum_degree; i >= 1; i--) {
+            temp = mul_word(sum[i], (k >= 0) ? k : 1);
+            free_real(sum[i]);
+            sum[i] = copy_real(sum[i - 1]);
+            if (k >= 0) {
+                subtract_from(sum[i], temp);
+            } else {
+                add_to(sum[i], temp);
+            }
+            free_real(temp);
+        }
+        temp = mul_word(sum[0], (k >= 0) ? k : 1);
+        free_real(sum[0]);
+        sum[0] = temp;
+        if (k >= 0) {
+            negate(sum[0]);
+            add_to(sum[0], diffs[k]);
+        }
+        sum_degree++;
+    }
+
+    // That sum starts at P(0), so take it back out.
+    temp = multiply(p_0, *denominator);
+    subtract_from(sum[0], temp);
+    free_real(temp);
+    free_real(p_0);
+
+    for (i = 0; i <= degree + 1; i++) {
+        trim_zeros(sum[i]);
+    }
+    free_poly(diffs, degree);
+    return sum;
+}
+
+struct Real* eval_polysum(struct Real** sum, int degree,
+                          struct Real* denominator, struct Real* n) {
+    struct Real* value = copy_real(sum[degree]);
+    struct Real* temp;
+    int i;
+    for (i = degree - 1; i >= 0; i--) {
+        temp = multiply(value, n);
+        free_real(value);
+        value = temp;
+        add_to(value, sum[i]);
+    }
+
+    // The sum of integers is an integer, so this division is exact.
+    temp = long_div_with_sig(value, denominator, 0);
+    free_real(value);
+    return temp;
+}
+
+struct PolysumJob {
+    struct Real** sum;
+    int degree;
+    struct Real* denominator;
+    struct Real** ns;
+    struct Real** results;
+    int num_ns;
+    int thread_idx;
+    int num_threads;
+};
+
+void* eval_polysum_thread(void* arg) {
+    struct PolysumJob* job = arg;
+    int i;
+    for (i = job->thread_idx; i < job->num_ns; i += job->num_threads) {
+        job->results[i] = eval_polysum(job->sum, job->degree,
+                                       job->denominator, job->ns[i]);
+    }
+    return NULL;
+}
+
+void eval_polysum_batch(struct Real** sum, int degree,
+                        struct Real* denominator, struct Real** ns,
+                        int num_ns, struct Real** results, int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    num_threads = MAX(1, MIN(num_threads, MAX_POLYSUM_THREADS));
+
+    struct PolysumJob jobs[MAX_POLYSUM_THREADS];
+    pthread_t threads[MAX_POLYSUM_THREADS];
+    int i;
+    for (i = 0; i < num_threads; i++) {
+        jobs[i].sum = sum;
+        jobs[i].degree = degree;
+        jobs[i].denominator = denominator;
+        jobs[i].ns = ns;
+        jobs[i].results = results;
+        jobs[i].num_ns = num_ns;
+        jobs[i].thread_idx = i;
+        jobs[i].num_threads = num_threads;
+        pthread_create(&threads[i], NULL, eval_polysum_thread, &jobs[i]);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+struct Real** clear_denominators(struct Rational** poly, int degree,
+                                 struct Real** common_den) {
+    struct Real* lcm = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* den;
+    struct Real* g;
+    struct Real* temp;
+    int i;
+    for (i = 0; i <= degree; i++) {
+        // lcm(l, d) = l d / gcd(l, d)
+        den = get_denominator(poly[i]);
+        g = gcd(lcm, den);
+        temp = long_div_with_sig(den, g, 0);
+        free_real(den);
+        den = multiply(lcm, temp);
+        free_real(lcm);
+        lcm = den;
+        trim_most_significant_zeros(lcm);
+        free_real(temp);
+        free_real(g);
+    }
+
+    struct Real** rtn = malloc((degree + 1) * sizeof(struct Real*));
+    struct Real* num;
+    for (i = 0; i <= degree; i++) {
+        num = get_numerator(poly[i]);
+        den = get_denominator(poly[i]);
+        temp = long_div_with_sig(lcm, den, 0);
+        rtn[i] = multiply(num, temp);
+        trim_most_significant_zeros(rtn[i]);
+        free_real(temp);
+        free_real(den);
+        free_real(num);
+    }
+
+    *common_den = lcm;
+    return rtn;
+}
+
+void free_poly(struct Real** poly, int degree) {
+    int i;
+    for (i = 0; i <= degree; i++) {
+        free_real(poly[i]);
+    }
+    free(poly);
+}
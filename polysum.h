@@ -0,0 +1,44 @@
+#ifndef POLYSUM_H
+#define POLYSUM_H
+
+#include "real.h"
+#include "rational.h"
+
+// Closed forms for sums of polynomials with integer coefficients.
+//
+// A polynomial of degree `degree` is an array of `degree + 1` integer
+// struct Reals, starting with the constant term.
+
+// Returns the coefficients of D * S, where
+//
+//   S(n) = P(1) + P(2) + ... + P(n)
+//
+// is the sum of `poly`, and sets `*denominator` to D = (degree + 1)!.
+// D * S has integer coefficients and degree `degree + 1`.
+//
+// This uses the forward differences of P at 0, which turn the sum into
+// a sum of binomial coefficients, C(n + 1, k + 1). Multiplying those out
+// in nested form takes O(degree^2) operations.
+struct Real** polysum(struct Real** poly, int degree,
+                      struct Real** denominator);
+
+// Returns S(n) for an integer `n`, exactly, given the output of
+// `polysum`. `degree` is the degree of `sum`.
+struct Real* eval_polysum(struct Real** sum, int degree,
+                          struct Real* denominator, struct Real* n);
+
+// Evaluates S at each of `ns`, spreading them across `num_threads`
+// threads (0 means one per CPU).
+void eval_polysum_batch(struct Real** sum, int degree,
+                        struct Real* denominator, struct Real** ns,
+                        int num_ns, struct Real** results, int num_threads);
+
+// Returns `poly` times the least common multiple of its coefficients'
+// denominators, which it sets `*common_den` to, so that it can be summed
+// with `polysum`.
+struct Real** clear_denominators(struct Rational** poly, int degree,
+                                 struct Real** common_den);
+
+void free_poly(struct Real** poly, int degree);
+
+#endif
@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "decimal.h"
+#include "rational.h"
+#include "polysum.h"
+
+// Prints the closed form of P(1) + ... + P(n) for a polynomial P with
+// rational coefficients, like 3 or -1/2, exactly:
+//
+//   polysum <c_0> <c_1> ... <c_d>
+//
+// With -e, it instead reads one integer n per line from stdin and prints
+// the sum up to each of them:
+//
+//   polysum -e <c_0> <c_1> ... <c_d> < ns
+
+#define MAX_LINE 1000000
+
+struct Real* parse_integer(char* str) {
+    if (strchr(str, '.') != NULL) {
+        printf("Not an integer: %s\n", str);
+        return NULL;
+    }
+    return decimal_str_to_real(str);
+}
+
+struct Rational* parse_rational(char* str) {
+    char* slash = strchr(str, '/');
+    if (slash != NULL) {
+        *slash = 0;
+    }
+    struct Real* num = parse_integer(str);
+    struct Real* den = (slash != NULL) ? parse_integer(slash + 1)
+        : fill_real(POSITIVE, 0, 1, 1);
+    struct Rational* q = NULL;
+    if (num != NULL && den != NULL) {
+        q = make_rational(num, den);
+    }
+    if (num != NULL) {
+        free_real(num);
+    }
+    if (den != NULL) {
+        free_real(den);
+    }
+    return q;
+}
+
+void print_poly(struct Rational** poly, int degree) {
+    // Prints the non-zero terms, like polysum.py.
+    int i;
+    char* c;
+    for (i = 0; i <= degree; i++) {
+        if (is_zero_rational(poly[i])) {
+            continue;
+        }
+        c = rational_to_str(poly[i]);
+        if (i == 0) {
+            printf(" %s ", c);
+        } else if (i == 1) {
+            printf(" %s*x ", c);
+        } else {
+            printf(" %s*x^%d ", c, i);
+        }
+        free(c);
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    int evaluate = (argc > 1 && strcmp(argv[1], "-e") == 0);
+    int first_arg = evaluate ? 2 : 1;
+    int degree = argc - first_arg - 1;
+    if (degree < 0) {
+        puts("usage: polysum [-e] <c_0> <c_1> ... <c_d>");
+        return 1;
+    }
+
+    struct Rational** rational_poly = malloc((degree + 1)
+                                             * sizeof(struct Rational*));
+    int i;
+    for (i = 0; i <= degree; i++) {
+        rational_poly[i] = parse_rational(argv[first_arg + i]);
+        if (rational_poly[i] == NULL) {
+            return 1;
+        }
+    }
+
+    // Sum L P, which has integer coefficients, and divide by L at the end.
+    struct Real* common_den;
+    struct Real** poly = clear_denominators(rational_poly, degree,
+                                            &common_den);
+    struct Real* denominator;
+    struct Real** sum = polysum(poly, degree, &denominator);
+
+    struct Rational* q;
+    if (!evaluate) {
+        struct Rational** coeffs = malloc((degree + 2)
+                                          * sizeof(struct Rational*));
+        struct Real* full_den = multiply(denominator, common_den);
+        for (i = 0; i <= degree + 1; i++) {
+            coeffs[i] = make_rational(sum[i], full_den);
+        }
+        print_poly(coeffs, degree + 1);
+        for (i = 0; i <= degree + 1; i++) {
+            free_rational(coeffs[i]);
+        }
+        free(coeffs);
+        free_real(full_den);
+    } else {
+        // Read all of the ns first, so they can be evaluated in parallel.
+        char* line = malloc(MAX_LINE);
+        int num_ns = 0, max_ns = 16;
+        struct Real** ns = malloc(max_ns * sizeof(struct Real*));
+        while (fgets(line, MAX_LINE, stdin) != NULL) {
+            line[strcspn(line, " \r\n")] = 0;
+            if (strlen(line) == 0) {
+                continue;
+            }
+            if (num_ns == max_ns) {
+                max_ns *= 2;
+                ns = realloc(ns, max_ns * sizeof(struct Real*));
+            }
+            ns[num_ns] = parse_integer(line);
+            if (ns[num_ns] == NULL) {
+                return 1;
+            }
+            num_ns++;
+        }
+        free(line);
+
+        struct Real** results = malloc(num_ns * sizeof(struct Real*));
+        eval_polysum_batch(sum, degree + 1, denominator, ns, num_ns,
+                           results, 0);
+
+        char* s;
+        for (i = 0; i < num_ns; i++) {
+            q = make_rational(results[i], common_den);
+            s = rational_to_str(q);
+            printf("%s\n", s);
+            free(s);
+            free_rational(q);
+            free_real(results[i]);
+            free_real(ns[i]);
+        }
+        free(results);
+        free(ns);
+    }
+
+    free_poly(sum, degree + 1);
+    free_poly(poly, degree);
+    free_real(denominator);
+    free_real(common_den);
+    for (i = 0; i <= degree; i++) {
+        free_rational(rational_poly[i]);
+    }
+    free(rational_poly);
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "progress.h"
+
+#include <string.h>
+#include <time.h>
+
+
+__thread struct Progress* thread_progress = NULL;
+
+double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void init_progress(struct Progress* progress, double deadline) {
+    memset(progress, 0, sizeof(*progress));
+    progress->deadline = deadline;
+}
+
+void set_thread_progress(struct Progress* progress) {
+    thread_progress = progress;
+}
+
+void cancel_progress(struct Progress* progress) {
+    __atomic_store_n(&progress->cancelled, 1, __ATOMIC_RELAXED);
+}
+
+int get_stages(struct Progress* progress, struct Stage* stages) {
+    // The stages can change while we read them, so each field is only
+    // consistent with itself.
+    int depth = __atomic_load_n(&progress->depth, __ATOMIC_RELAXED);
+    depth = MIN(depth, MAX_STAGES);
+    int i;
+    for (i = 0; i < depth; i++) {
+        stages[i].name = __atomic_load_n(&progress->stages[i].name,
+                                         __ATOMIC_RELAXED);
+        stages[i].step = __atomic_load_n(&progress->stages[i].step,
+                                         __ATOMIC_RELAXED);
+        stages[i].total = __atomic_load_n(&progress->stages[i].total,
+                                          __ATOMIC_RELAXED);
+    }
+    return depth;
+}
+
+void begin_stage(const char* name, word total) {
+    struct Progress* p = thread_progress;
+    if (p == NULL) {
+        return;
+    }
+    // Only this thread writes the stages, so it can read them plainly.
+    int depth = p->depth;
+    if (depth < MAX_STAGES) {
+        __atomic_store_n(&p->stages[depth].name, name, __ATOMIC_RELAXED);
+        __atomic_store_n(&p->stages[depth].step, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&p->stages[depth].total, total, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&p->depth, depth + 1, __ATOMIC_RELAXED);
+}
+
+void end_stage(void) {
+    struct Progress* p = thread_progress;
+    if (p == NULL) {
+        return;
+    }
+    __atomic_store_n(&p->depth, p->depth - 1, __ATOMIC_RELAXED);
+}
+
+int is_cancelled(void) {
+    struct Progress* p = thread_progress;
+    if (p == NULL) {
+        return 0;
+    }
+    if (__atomic_load_n(&p->cancelled, __ATOMIC_RELAXED)) {
+        return 1;
+    }
+    if (p->deadline != 0 && monotonic_seconds() > p->deadline) {
+        cancel_progress(p);
+        return 1;
+    }
+    return 0;
+}
+
+int checkpoint(word step) {
+    struct Progress* p = thread_progress;
+    if (p == NULL) {
+        return 0;
+    }
+    int depth = p->depth;
+    if (depth >= 1 && depth <= MAX_STAGES) {
+        __atomic_store_n(&p->stages[depth - 1].step, step, __ATOMIC_RELAXED);
+    }
+    return is_cancelled();
+}
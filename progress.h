@@ -0,0 +1,69 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include "real.h"
+
+// Progress reports and cooperative cancellation for long computations.
+//
+// A thread can attach a `struct Progress` to itself. The algorithms it
+// then runs report what they're doing as a stack of nested stages (say
+// an AGM step, within it a Newton step for a square root, and within
+// that a multiply), and stop early at safe points once the computation
+// has been cancelled or its deadline has passed. A function that stops
+// early returns NULL.
+//
+// On a thread without a `struct Progress` all of this does nothing, and
+// nothing is ever cancelled.
+
+// Only this many levels of nested stages are recorded. Deeper stages
+// are still tracked, just not reported.
+#define MAX_STAGES 4
+
+struct Stage {
+    const char* name;
+    word step;
+    // 0 if the number of steps isn't known in advance.
+    word total;
+};
+
+struct Progress {
+    // Written by the computing thread and read by anyone, atomically.
+    int cancelled;
+    int depth;
+    struct Stage stages[MAX_STAGES];
+    // Seconds on `monotonic_seconds`' clock after which the computation
+    // stops, or 0 for no deadline. Set before attaching.
+    double deadline;
+};
+
+// Seconds since some fixed point in the past.
+double monotonic_seconds(void);
+
+// Clears `progress` and sets its deadline.
+void init_progress(struct Progress* progress, double deadline);
+
+// Attaches `progress` to the calling thread, or detaches it if NULL.
+void set_thread_progress(struct Progress* progress);
+
+// Asks the computation using `progress` to stop at its next safe point.
+// Any thread can call this.
+void cancel_progress(struct Progress* progress);
+
+// Copies the stages that are currently running on `progress` into
+// `stages`, outermost first, and returns how many there are.
+int get_stages(struct Progress* progress, struct Stage* stages);
+
+// Starts a stage with `total` steps within the current one.
+void begin_stage(const char* name, word total);
+
+// Ends the innermost stage.
+void end_stage(void);
+
+// Records that the innermost stage has reached `step`. Returns 1 if the
+// computation should stop, and 0 otherwise.
+int checkpoint(word step);
+
+// Returns 1 if the computation on this thread should stop.
+int is_cancelled(void);
+
+#endif
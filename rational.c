@@ -0,0 +1,560 @@
+#include "rational.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "decimal.h"
+#include "thresholds.h"
+
+
+// Lehmer's method simulates Euclid's algorithm on this many leading bits,
+// which keeps the cofactors in a signed word.
+#define LEHMER_BITS 62
+
+
+struct Rational {
+    struct Real* num;
+    // Always positive once normalized, but may be negative before.
+    struct Real* den;
+    // The number of words `num` and `den` would have without any common
+    // factors, roughly. Once they have twice this, they get reduced.
+    ssize_t reduced_words;
+};
+
+ssize_t num_words(struct Real* r) {
+    return get_max_word_idx(r) - get_min_word_idx(r);
+}
+
+ssize_t rational_words(struct Rational* q) {
+    return num_words(q->num) + num_words(q->den);
+}
+
+struct Rational* new_rational(struct Real* num, struct Real* den,
+                              ssize_t reduced_words) {
+    // Takes ownership of `num` and `den`.
+    struct Rational* q = malloc(sizeof(struct Rational));
+    trim_most_significant_zeros(num);
+    trim_most_significant_zeros(den);
+    q->num = num;
+    q->den = den;
+    q->reduced_words = reduced_words;
+    if (rational_words(q) > 2*q->reduced_words) {
+        normalize_rational(q);
+    }
+    return q;
+}
+
+struct Rational* make_rational(struct Real* num, struct Real* den) {
+    if (is_zero(den)) {
+        puts("Rational with a zero denominator!");
+        return NULL;
+    } else if (get_min_word_idx(num) < 0 || get_min_word_idx(den) < 0) {
+        puts("Rationals need integer numerators and denominators!");
+        return NULL;
+    }
+    struct Rational* q = malloc(sizeof(struct Rational));
+    q->num = copy_real(num);
+    q->den = copy_real(den);
+    normalize_rational(q);
+    return q;
+}
+
+struct Rational* integer_rational(struct Real* r) {
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    struct Rational* q = make_rational(r, one);
+    free_real(one);
+    return q;
+}
+
+struct Rational* copy_rational(struct Rational* q) {
+    struct Rational* rtn = malloc(sizeof(struct Rational));
+    rtn->num = copy_real(q->num);
+    rtn->den = copy_real(q->den);
+    rtn->reduced_words = q->reduced_words;
+    return rtn;
+}
+
+void free_rational(struct Rational* q) {
+    free_real(q->num);
+    free_real(q->den);
+    free(q);
+}
+
+struct Rational* add_or_subtract(struct Rational* a, struct Rational* b,
+                                 int subtracting) {
+    // a/b + c/d = (ad + bc) / bd, or just (a + c) / b if the denominators
+    // are already the same.
+    struct Real* num;
+    struct Real* den;
+    if (check_equal(a->den, b->den)) {
+        num = subtracting ? subtract(a->num, b->num) : add(a->num, b->num);
+        den = copy_real(a->den);
+    } else {
+        num = multiply(a->num, b->den);
+        if (subtracting) {
+            fms_with_sig(num, b->num, a->den, 0);
+        } else {
+            fma_with_sig(num, b->num, a->den, 0);
+        }
+        den = multiply(a->den, b->den);
+    }
+    return new_rational(num, den, a->reduced_words + b->reduced_words);
+}
+
+struct Rational* add_rational(struct Rational* a, struct Rational* b) {
+    return add_or_subtract(a, b, 0);
+}
+
+struct Rational* subtract_rational(struct Rational* a, struct Rational* b) {
+    return add_or_subtract(a, b, 1);
+}
+
+struct Rational* multiply_rational(struct Rational* a, struct Rational* b) {
+    return new_rational(multiply(a->num, b->num), multiply(a->den, b->den),
+                        a->reduced_words + b->reduced_words);
+}
+
+struct Rational* divide_rational(struct Rational* a, struct Rational* b) {
+    if (is_zero(b->num)) {
+        puts("Division by zero!");
+        return NULL;
+    }
+    return new_rational(multiply(a->num, b->den), multiply(a->den, b->num),
+                        a->reduced_words + b->reduced_words);
+}
+
+void normalize_rational(struct Rational* q) {
+    if (get_sign(q->den) == NEGATIVE) {
+        negate(q->num);
+        negate(q->den);
+    }
+
+    struct Real* g = gcd(q->num, q->den);
+    struct Real* temp;
+    if (!(get_max_word_idx(g) == 1 && get_word(g, 0) == 1)) {
+        temp = long_div_with_sig(q->num, g, 0);
+        free_real(q->num);
+        q->num = temp;
+        temp = long_div_with_sig(q->den, g, 0);
+        free_real(q->den);
+        q->den = temp;
+    }
+    free_real(g);
+
+    if (is_zero(q->num)) {
+        set_sign(q->num, POSITIVE);
+    }
+    trim_most_significant_zeros(q->num);
+    trim_most_significant_zeros(q->den);
+    q->reduced_words = rational_words(q);
+}
+
+struct Real* get_numerator(struct Rational* q) {
+    normalize_rational(q);
+    return copy_real(q->num);
+}
+
+struct Real* get_denominator(struct Rational* q) {
+    normalize_rational(q);
+    return copy_real(q->den);
+}
+
+int is_zero_rational(struct Rational* q) {
+    return is_zero(q->num);
+}
+
+struct Real* rational_to_real(struct Rational* q, ssize_t min_sig_word_idx) {
+    return long_div_with_sig(q->num, q->den, min_sig_word_idx);
+}
+
+char* rational_to_str(struct Rational* q) {
+    normalize_rational(q);
+    char* num = real_to_decimal_str(q->num);
+    if (get_max_word_idx(q->den) == 1 && get_word(q->den, 0) == 1) {
+        return num;
+    }
+    char* den = real_to_decimal_str(q->den);
+    char* rtn = malloc(strlen(num) + strlen(den) + 2);
+    sprintf(rtn, "%s/%s", num, den);
+    free(num);
+    free(den);
+    return rtn;
+}
+
+
+// GCD
+
+word top_bits(struct Real* r, ssize_t bit_idx) {
+    // Returns the bits of |r| from `bit_idx` up, which must be no more
+    // than 64.
+    ssize_t word_idx = floor_div(bit_idx, WORD_BITS);
+    int shift = bit_idx - word_idx*WORD_BITS;
+    word w = get_word(r, word_idx) >> shift;
+    if (shift > 0) {
+        w |= get_word(r, word_idx + 1) << (WORD_BITS - shift);
+    }
+    return w;
+}
+
+struct Real* combine(int64_t c1, struct Real* x, int64_t c2, struct Real* y) {
+    // Returns c1 x + c2 y.
+    struct Real* rtn = fill_real(POSITIVE, 0, 1, 0);
+    struct Real* term = fill_real(POSITIVE, 0, 1, 0);
+    axpy(rtn, (c1 < 0) ? -(word) c1 : (word) c1, x);
+    if (c1 < 0) {
+        negate(rtn);
+    }
+    axpy(term, (c2 < 0) ? -(word) c2 : (word) c2, y);
+    if (c2 < 0) {
+        negate(term);
+    }
+    add_to(rtn, term);
+    free_real(term);
+    trim_most_significant_zeros(rtn);
+    return rtn;
+}
+
+struct Real* remainder_real(struct Real* x, struct Real* y) {
+    // Returns x mod y for non-negative integers.
+    struct Real* q = long_div_with_sig(x, y, 0);
+    struct Real* r = copy_real(x);
+    fms_with_sig(r, q, y, 0);
+    free_real(q);
+    trim_most_significant_zeros(r);
+    return r;
+}
+
+int lehmer_cofactors(struct Real* x, struct Real* y, int64_t* cofactors) {
+    // For x >= y > 0, runs Euclid's algorithm on the leading bits for as
+    // long as the quotients are sure to be the same as for the whole
+    // numbers. Sets `cofactors` to {a, b, c, d} such that those steps take
+    // (x, y) to (a x + b y, c x + d y), and returns 0 if not even one
+    // quotient was certain.
+    ssize_t shift = MAX(0, get_exponent(x) - LEHMER_BITS);
+    int64_t x_hat = top_bits(x, shift);
+    int64_t y_hat = top_bits(y, shift);
+
+    int64_t a_1 = 1;
+    int64_t b_1 = 0;
+    int64_t c_1 = 0;
+    int64_t d_1 = 1;
+    int64_t q_1, q_2, t;
+    while (y_hat + c_1 != 0 && y_hat + d_1 != 0) {
+        q_1 = (x_hat + a_1) / (y_hat + c_1);
+        q_2 = (x_hat + b_1) / (y_hat + d_1);
+        if (q_1 != q_2) {
+            break;
+        }
+        t = a_1 - q_1*c_1;
+        a_1 = c_1;
+        c_1 = t;
+        t = b_1 - q_1*d_1;
+        b_1 = d_1;
+        d_1 = t;
+        t = x_hat - q_1*y_hat;
+        x_hat = y_hat;
+        y_hat = t;
+    }
+
+    cofactors[0] = a_1;
+    cofactors[1] = b_1;
+    cofactors[2] = c_1;
+    cofactors[3] = d_1;
+    return b_1 != 0;
+}
+
+
+// Half-GCD. Every step below is a unimodular transformation of a pair
+// (x, y), so it keeps gcd(x, y) whether or not it's the step Euclid's
+// algorithm would have taken. That's what lets the quotients found from
+// the top half of the numbers be applied to the whole numbers: when they
+// turn out to be slightly wrong, the pair is just fixed up to be
+// non-negative and in order.
+
+struct GcdMatrix {
+    // (x, y) is taken to (m[0][0] x + m[0][1] y, m[1][0] x + m[1][1] y).
+    struct Real* m[2][2];
+};
+
+void identity_matrix(struct GcdMatrix* m) {
+    m->m[0][0] = fill_real(POSITIVE, 0, 1, 1);
+    m->m[0][1] = fill_real(POSITIVE, 0, 1, 0);
+    m->m[1][0] = fill_real(POSITIVE, 0, 1, 0);
+    m->m[1][1] = fill_real(POSITIVE, 0, 1, 1);
+}
+
+void free_matrix(struct GcdMatrix* m) {
+    int i, j;
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < 2; j++) {
+            free_real(m->m[i][j]);
+        }
+    }
+}
+
+struct Real* combine_reals(struct Real* c1, struct Real* x, struct Real* c2,
+                          struct Real* y) {
+    // Returns c1 x + c2 y.
+    struct Real* rtn = multiply(c1, x);
+    struct Real* term = multiply(c2, y);
+    add_to(rtn, term);
+    free_real(term);
+    trim_zeros(rtn);
+    return rtn;
+}
+
+void apply_matrix(struct GcdMatrix* m, struct Real** x, struct Real** y) {
+    // (x, y) = m (x, y), in place.
+    struct Real* new_x = combine_reals(m->m[0][0], *x, m->m[0][1], *y);
+    struct Real* new_y = combine_reals(m->m[1][0], *x, m->m[1][1], *y);
+    free_real(*x);
+    free_real(*y);
+    *x = new_x;
+    *y = new_y;
+}
+
+void multiply_matrices(struct GcdMatrix* m2, struct GcdMatrix* m1) {
+    // m1 = m2 m1, in place.
+    struct Real* col_0[2] = {m1->m[0][0], m1->m[1][0]};
+    struct Real* col_1[2] = {m1->m[0][1], m1->m[1][1]};
+    int i;
+    for (i = 0; i < 2; i++) {
+        m1->m[i][0] = combine_reals(m2->m[i][0], col_0[0],
+                                    m2->m[i][1], col_0[1]);
+        m1->m[i][1] = combine_reals(m2->m[i][0], col_1[0],
+                                    m2->m[i][1], col_1[1]);
+    }
+    for (i = 0; i < 2; i++) {
+        free_real(col_0[i]);
+        free_real(col_1[i]);
+    }
+}
+
+void fix_up_pair(struct GcdMatrix* m, struct Real** x, struct Real** y) {
+    // Makes x >= y >= 0 by negating and swapping rows.
+    int row;
+    struct Real** v[2] = {x, y};
+    for (row = 0; row < 2; row++) {
+        if (get_sign(*v[row]) == NEGATIVE && !is_zero(*v[row])) {
+            negate(*v[row]);
+            negate(m->m[row][0]);
+            negate(m->m[row][1]);
+        }
+        set_sign(*v[row], POSITIVE);
+    }
+    if (greater_abs(*y, *x)) {
+        struct Real* temp = *x;
+        *x = *y;
+        *y = temp;
+        temp = m->m[0][0];
+        m->m[0][0] = m->m[1][0];
+        m->m[1][0] = temp;
+        temp = m->m[0][1];
+        m->m[0][1] = m->m[1][1];
+        m->m[1][1] = temp;
+    }
+}
+
+void euclid_step(struct GcdMatrix* m, struct Real** x, struct Real** y) {
+    // (x, y) = (y, x mod y) for x >= y > 0, in place.
+    struct Real* q = long_div_with_sig(*x, *y, 0);
+    struct Real* r = copy_real(*x);
+    fms_with_sig(r, q, *y, 0);
+    trim_zeros(r);
+    free_real(*x);
+    *x = *y;
+    *y = r;
+
+    int col;
+    for (col = 0; m != NULL && col < 2; col++) {
+        r = copy_real(m->m[0][col]);
+        fms_with_sig(r, q, m->m[1][col], 0);
+        trim_zeros(r);
+        free_real(m->m[0][col]);
+        m->m[0][col] = m->m[1][col];
+        m->m[1][col] = r;
+    }
+    free_real(q);
+}
+
+void lehmer_step(struct GcdMatrix* m, struct Real** x, struct Real** y) {
+    // Takes as many of Euclid's steps on x >= y > 0 as Lehmer's method
+    // can at once, and at least one.
+    int64_t c[4];
+    if (!lehmer_cofactors(*x, *y, c)) {
+        euclid_step(m, x, y);
+        return;
+    }
+    struct Real* new_x = combine(c[0], *x, c[1], *y);
+    struct Real* new_y = combine(c[2], *x, c[3], *y);
+    free_real(*x);
+    free_real(*y);
+    *x = new_x;
+    *y = new_y;
+
+    int col;
+    for (col = 0; m != NULL && col < 2; col++) {
+        new_x = combine(c[0], m->m[0][col], c[1], m->m[1][col]);
+        new_y = combine(c[2], m->m[0][col], c[3], m->m[1][col]);
+        free_real(m->m[0][col]);
+        free_real(m->m[1][col]);
+        m->m[0][col] = new_x;
+        m->m[1][col] = new_y;
+    }
+}
+
+struct Real* high_bits(struct Real* r, ssize_t bit_idx) {
+    // Returns floor(r / 2^bit_idx) for r >= 0.
+    struct Real* rtn = shift_right_bits(r, bit_idx);
+    truncate_real(rtn, 0);
+    trim_zeros(rtn);
+    return rtn;
+}
+
+int is_half_reduced(struct Real* y, ssize_t num_bits) {
+    return is_zero(y) || get_exponent(y) <= num_bits - num_bits/2;
+}
+
+void half_gcd(struct Real* a, struct Real* b, struct GcdMatrix* m,
+              struct Real** x, struct Real** y) {
+    // For a >= b >= 0, sets `m` and (x, y) = m (a, b) with x >= y >= 0,
+    // where y has about half as many bits as a. `m` can be NULL if only
+    // (x, y) is needed, which saves multiplying the matrices at the end.
+    //
+    // Above `thresholds.hgcd_min_words`, the top half of (a, b) is
+    // reduced first, which takes (a, b) about a quarter of the way. After
+    // one more step of Euclid's algorithm the top half of what's left is
+    // reduced the rest of the way. This costs O(M(n) log n) rather than
+    // the O(n^2) of Lehmer's method.
+    ssize_t n = get_exponent(a);
+    if (m != NULL) {
+        identity_matrix(m);
+    }
+    *x = copy_real(a);
+    *y = copy_real(b);
+    trim_zeros(*x);
+    trim_zeros(*y);
+
+    if (get_max_word_idx(*x) < MAX(thresholds.hgcd_min_words, 2)) {
+        while (!is_half_reduced(*y, n)) {
+            lehmer_step(m, x, y);
+        }
+        return;
+    }
+
+    ssize_t k = n / 2;
+    struct GcdMatrix m_top;
+    struct Real* x_top;
+    struct Real* y_top;
+    struct Real* a_top = high_bits(*x, k);
+    struct Real* b_top = high_bits(*y, k);
+    half_gcd(a_top, b_top, &m_top, &x_top, &y_top);
+    free_real(a_top);
+    free_real(b_top);
+    free_real(x_top);
+    free_real(y_top);
+    apply_matrix(&m_top, x, y);
+    fix_up_pair(&m_top, x, y);
+    if (m != NULL) {
+        free_matrix(m);
+        *m = m_top;
+    } else {
+        free_matrix(&m_top);
+    }
+    if (is_half_reduced(*y, n)) {
+        return;
+    }
+
+    euclid_step(m, x, y);
+    if (is_half_reduced(*y, n)) {
+        return;
+    }
+
+    // Reducing the bits of x from `shift` up by half leaves about n/2
+    // bits. Always drop at least one, so the recursion ends.
+    ssize_t l = get_exponent(*x);
+    ssize_t shift = MAX(MAX(2*(n - k) - l, l - (n - 1)), 0);
+    a_top = high_bits(*x, shift);
+    b_top = high_bits(*y, shift);
+    half_gcd(a_top, b_top, &m_top, &x_top, &y_top);
+    free_real(a_top);
+    free_real(b_top);
+    free_real(x_top);
+    free_real(y_top);
+    apply_matrix(&m_top, x, y);
+    fix_up_pair(&m_top, x, y);
+    if (m != NULL) {
+        multiply_matrices(&m_top, m);
+    }
+    free_matrix(&m_top);
+}
+
+struct Real* gcd(struct Real* a, struct Real* b) {
+    struct Real* x = copy_real(a);
+    struct Real* y = copy_real(b);
+    set_sign(x, POSITIVE);
+    set_sign(y, POSITIVE);
+    trim_most_significant_zeros(x);
+    trim_most_significant_zeros(y);
+    if (greater_abs(y, x)) {
+        struct Real* temp = x;
+        x = y;
+        y = temp;
+    }
+
+    // Keep x >= y. Each half-GCD roughly halves the numbers. If one
+    // doesn't get anywhere, a step of Euclid's algorithm always does.
+    struct Real* new_x;
+    struct Real* new_y;
+    while (!is_zero(y) && get_max_word_idx(x) >= thresholds.hgcd_min_words) {
+        half_gcd(x, y, NULL, &new_x, &new_y);
+        if (greater_abs(x, new_x)) {
+            free_real(x);
+            free_real(y);
+            x = new_x;
+            y = new_y;
+        } else {
+            free_real(new_x);
+            free_real(new_y);
+            new_y = remainder_real(x, y);
+            free_real(x);
+            x = y;
+            y = new_y;
+        }
+    }
+
+    int64_t c[4];
+    while (!is_zero(y) && get_max_word_idx(x) > 1) {
+        if (!lehmer_cofactors(x, y, c)) {
+            // Not even one quotient was certain, so take a full step.
+            new_y = remainder_real(x, y);
+            new_x = y;
+        } else {
+            new_x = combine(c[0], x, c[1], y);
+            new_y = combine(c[2], x, c[3], y);
+            free_real(y);
+        }
+        free_real(x);
+        x = new_x;
+        y = new_y;
+    }
+
+    // Finish off with single words.
+    word x_word = get_word(x, 0);
+    word y_word = get_word(y, 0);
+    word temp_word;
+    if (!is_zero(y)) {
+        while (y_word != 0) {
+            temp_word = x_word % y_word;
+            x_word = y_word;
+            y_word = temp_word;
+        }
+        free_real(x);
+        x = fill_real(POSITIVE, 0, 1, x_word);
+    }
+    free_real(y);
+    return x;
+}
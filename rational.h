@@ -0,0 +1,59 @@
+#ifndef RATIONAL_H
+#define RATIONAL_H
+
+#include "real.h"
+
+// Exact rational numbers, as a ratio of 2 integer struct Reals.
+//
+// Operations don't reduce their results, since a GCD costs far more than
+// an add or multiply. Instead, a result is only reduced once it has grown
+// to more than twice the size it would have if its operands had no
+// common factors, so long chains of operations stay cheap but can't blow
+// up. `normalize_rational` reduces one explicitly.
+
+struct Rational;
+
+// Returns num / den. Both must be integers (`min_word_idx` >= 0), and
+// they are copied. Returns NULL if `den` is 0.
+struct Rational* make_rational(struct Real* num, struct Real* den);
+
+// Returns the integer `r` as a rational.
+struct Rational* integer_rational(struct Real* r);
+
+struct Rational* copy_rational(struct Rational* q);
+
+void free_rational(struct Rational* q);
+
+struct Rational* add_rational(struct Rational* a, struct Rational* b);
+struct Rational* subtract_rational(struct Rational* a, struct Rational* b);
+struct Rational* multiply_rational(struct Rational* a, struct Rational* b);
+
+// Returns NULL if `b` is 0.
+struct Rational* divide_rational(struct Rational* a, struct Rational* b);
+
+// Divides out the GCD of the numerator and denominator and makes the
+// denominator positive.
+void normalize_rational(struct Rational* q);
+
+// Return copies of the numerator and denominator, after normalizing.
+struct Real* get_numerator(struct Rational* q);
+struct Real* get_denominator(struct Rational* q);
+
+int is_zero_rational(struct Rational* q);
+
+// Returns q truncated towards 0 at `min_sig_word_idx`. This is exact up
+// to the truncation.
+struct Real* rational_to_real(struct Rational* q, ssize_t min_sig_word_idx);
+
+// Returns the normalized "num/den" in decimal, or just "num" if the
+// denominator is 1. The caller frees it.
+char* rational_to_str(struct Rational* q);
+
+// Returns the greatest common divisor of |a| and |b|, using Lehmer's
+// method: most steps of Euclid's algorithm are worked out from the top
+// 62 bits and applied to the whole numbers at once. Integers at least
+// `thresholds.hgcd_min_words` long are first brought down below it with
+// the recursive half-GCD, which is subquadratic.
+struct Real* gcd(struct Real* a, struct Real* b);
+
+#endif
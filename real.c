@@ -3,8 +3,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 
+// The storage for the words of a struct Real. It's shared by the struct
+// Real that allocated it and any views of that struct Real, and it's
+// freed when the last of them is.
+//
+// It can hold more words than are in use, so that a struct Real can
+// grow and shrink without reallocating.
+struct WordBuffer {
+    word* words;
+    ssize_t capacity;
+    // Views of a struct Real that's shared between threads, like the
+    // powers of ten in decimal.c, are taken and freed concurrently, so
+    // this is only accessed atomically.
+    int refcount;
+};
+
 // A structure representing real numbers with arbitrary precision.
 //
 // A word index of 0 corresponds to the "ones" word.
@@ -13,6 +29,10 @@
 // `max_word_idx` is actually the maximum present word index plus 1.
 // `min_word_idx` is the actual minimum present word index.
 // Thus there are `max_word_idx - min_word_idx` words present.
+//
+// `words` points at the word at `min_word_idx` somewhere inside
+// `buffer`, so narrowing the range of words never has to move them, and
+// widening it only has to when it runs off either end of the buffer.
 struct Real {
     enum sign_t sign;
 
@@ -20,6 +40,10 @@ struct Real {
     ssize_t max_word_idx;
 
     word* words;
+    struct WordBuffer* buffer;
+
+    // Set for views, which can't change their words.
+    int read_only;
 };
 
 // Functions for allocating and freeing structures.
@@ -34,6 +58,7 @@ struct Real* alloc_real(enum sign_t sign,
         return NULL;
     }
     struct Real* r = malloc(sizeof(struct Real));
+    r->buffer = NULL;
     set_sign(r, sign);
     set_max_word_idx(r, max_word_idx);
     set_min_word_idx(r, min_word_idx);
@@ -63,29 +88,155 @@ struct Real* fill_real(enum sign_t sign,
     return r;
 }
 
+void release_buffer(struct WordBuffer* buffer) {
+    if (__atomic_sub_fetch(&buffer->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(buffer->words);
+        free(buffer);
+    }
+}
+
+void release_words(struct Real* r) {
+    // Drops `r`'s reference to its buffer.
+    if (r->buffer != NULL) {
+        release_buffer(r->buffer);
+        r->buffer = NULL;
+    }
+}
+
+void allocate_buffer(struct Real* r, ssize_t capacity, ssize_t offset) {
+    // Gives `r` a new buffer of `capacity` words, with its words starting
+    // `offset` words in. The new words are all 0.
+    release_words(r);
+    r->buffer = malloc(sizeof(struct WordBuffer));
+    r->buffer->words = calloc(capacity, sizeof(word));
+    r->buffer->capacity = capacity;
+    r->buffer->refcount = 1;
+    r->words = r->buffer->words + offset;
+    r->read_only = 0;
+}
+
 void allocate_words(struct Real* r) {
-    r->words = calloc(get_max_word_idx(r) - get_min_word_idx(r),
-                      sizeof(word));
+    allocate_buffer(r, get_max_word_idx(r) - get_min_word_idx(r), 0);
+}
+
+void unshare_words(struct Real* r) {
+    // Gives `r` its own copy of its words, so it can change them without
+    // affecting any views.
+    struct WordBuffer* old_buffer = r->buffer;
+    word* old_words = r->words;
+    r->buffer = NULL;
+    allocate_words(r);
+    memcpy(r->words, old_words,
+           (get_max_word_idx(r) - get_min_word_idx(r))*sizeof(word));
+    release_buffer(old_buffer);
 }
 
 struct Real* copy_real(struct Real* r) {
     struct Real* rtn = alloc_real(get_sign(r),
                                    get_min_word_idx(r),
                                    get_max_word_idx(r));
+    memcpy(rtn->words, r->words,
+           (get_max_word_idx(r) - get_min_word_idx(r))*sizeof(word));
+    return rtn;
+}
+
+struct Real* view_real(struct Real* r,
+                       ssize_t min_word_idx,
+                       ssize_t max_word_idx) {
+    min_word_idx = MAX(min_word_idx, get_min_word_idx(r));
+    max_word_idx = MIN(max_word_idx, get_max_word_idx(r));
+    if (max_word_idx <= min_word_idx) {
+        return alloc_real(get_sign(r), 0, 1);
+    }
+
+    struct Real* v = malloc(sizeof(struct Real));
+    *v = *r;
+    v->words = r->words + (min_word_idx - get_min_word_idx(r));
+    set_min_word_idx(v, min_word_idx);
+    set_max_word_idx(v, max_word_idx);
+    __atomic_add_fetch(&v->buffer->refcount, 1, __ATOMIC_ACQ_REL);
+    v->read_only = 1;
+    return v;
+}
+
+int resize_real(struct Real* r,
+                ssize_t min_word_idx,
+                ssize_t max_word_idx) {
+    if (r->read_only) {
+        puts("Tried to resize a read-only view!");
+        return -1;
+    } else if (max_word_idx <= min_word_idx) {
+        puts("Tried to resize real to an empty range!");
+        return -1;
+    }
+
+    ssize_t old_min_word_idx = get_min_word_idx(r);
+    ssize_t old_max_word_idx = get_max_word_idx(r);
+    ssize_t num_words = max_word_idx - min_word_idx;
+    ssize_t offset = ((r->words - r->buffer->words)
+                      + min_word_idx - old_min_word_idx);
+
     ssize_t word_idx;
-    for (word_idx = get_min_word_idx(r);
-         word_idx < get_max_word_idx(r);
-         word_idx++) {
-        set_word(rtn, word_idx, get_word(r, word_idx));
+    if (__atomic_load_n(&r->buffer->refcount, __ATOMIC_ACQUIRE) == 1 &&
+        offset >= 0 && offset + num_words <= r->buffer->capacity) {
+        // The new range fits in the buffer. Words that weren't in the old
+        // range may hold stale values from before a trim.
+        r->words = r->buffer->words + offset;
+        set_min_word_idx(r, min_word_idx);
+        set_max_word_idx(r, max_word_idx);
+        for (word_idx = min_word_idx; word_idx < max_word_idx; word_idx++) {
+            if (word_idx < old_min_word_idx || word_idx >= old_max_word_idx) {
+                r->words[word_idx - min_word_idx] = 0;
+            }
+        }
+        return 0;
     }
-    return rtn;
+
+    // Grow the buffer geometrically if it's too small (rather than just
+    // shared), leaving the spare room on the side(s) that grew.
+    ssize_t capacity = r->buffer->capacity;
+    if (num_words > capacity) {
+        capacity = MAX(num_words, 2*capacity);
+    }
+    ssize_t spare = capacity - num_words;
+    if (min_word_idx >= old_min_word_idx) {
+        offset = 0;
+    } else if (max_word_idx <= old_max_word_idx) {
+        offset = spare;
+    } else {
+        offset = spare / 2;
+    }
+
+    struct WordBuffer* old_buffer = r->buffer;
+    word* old_words = r->words;
+    r->buffer = NULL;
+    set_min_word_idx(r, min_word_idx);
+    set_max_word_idx(r, max_word_idx);
+    allocate_buffer(r, capacity, offset);
+
+    ssize_t copy_min_word_idx = MAX(min_word_idx, old_min_word_idx);
+    ssize_t copy_max_word_idx = MIN(max_word_idx, old_max_word_idx);
+    if (copy_max_word_idx > copy_min_word_idx) {
+        memcpy(r->words + (copy_min_word_idx - min_word_idx),
+               old_words + (copy_min_word_idx - old_min_word_idx),
+               (copy_max_word_idx - copy_min_word_idx)*sizeof(word));
+    }
+
+    release_buffer(old_buffer);
+    return 0;
 }
 
 void free_real(struct Real* r) {
-    free(r->words);
+    release_words(r);
     free(r);
 }
 
+void move_real(struct Real* dst, struct Real* src) {
+    release_words(dst);
+    *dst = *src;
+    free(src);
+}
+
 
 // Functions for getting and setting individual words.
 
@@ -110,12 +261,19 @@ int set_word(struct Real* r, ssize_t word_idx, word l) {
     // Set the value of the `word_idx` word in `r`.
     // Returns 0 on success; -1 on error.
     int rtn;
-    if (word_idx >= get_max_word_idx(r) ||
-        word_idx < get_min_word_idx(r)) {
+    if (r->read_only) {
+        puts("Tried to set word of a read-only view!");
+        rtn = -1;
+    } else if (word_idx >= get_max_word_idx(r) ||
+               word_idx < get_min_word_idx(r)) {
         puts("Tried to set word out of range!");
         rtn = -1;
     } else {
         rtn = 0;
+        if (__atomic_load_n(&r->buffer->refcount, __ATOMIC_ACQUIRE) > 1) {
+            // Views of `r` have to keep the old value.
+            unshare_words(r);
+        }
         (r->words)[word_idx - get_min_word_idx(r)] = l;
     }
     return rtn;
@@ -194,6 +352,14 @@ void set_sign(struct Real* r, enum sign_t sign) {
 
 // Miscellaneous functions.
 
+ssize_t floor_div(ssize_t a, ssize_t b) {
+    ssize_t q = a / b;
+    if (a % b != 0 && a < 0) {
+        q--;
+    }
+    return q;
+}
+
 int check_equal(struct Real* r1, struct Real* r2) {
     int rtn = 1;
     // After comparing all words, this flag will tell us whether both reals
@@ -222,8 +388,8 @@ int check_equal(struct Real* r1, struct Real* r2) {
 }
 
 void trim_most_significant_zeros(struct Real* r) {
-    // This function has to reference actual fields inside the struct Real
-    // in order to reallocate the words buffer.
+    // This only narrows the range of words, so it never reallocates and
+    // works on views too.
     ssize_t new_max_word_idx;
     ssize_t old_max_word_idx = get_max_word_idx(r);
 
@@ -236,32 +402,17 @@ void trim_most_significant_zeros(struct Real* r) {
     }
 
     if (new_max_word_idx == get_min_word_idx(r)) {
-        // `r` = 0. But it might already be as clean as possible.
-        if (get_min_word_idx(r) != 0 || old_max_word_idx != 1) {
-            free(r->words);
-            set_min_word_idx(r, 0);
-            set_max_word_idx(r, 1);
-            allocate_words(r);
-        }
-    }
-    else if (new_max_word_idx < old_max_word_idx) {
-        // We can decrease the allocated space.
-        word* old_words = r->words;
+        // `r` = 0, so keep just its first word, which is 0.
+        set_min_word_idx(r, 0);
+        set_max_word_idx(r, 1);
+    } else {
         set_max_word_idx(r, new_max_word_idx);
-        allocate_words(r);
-        ssize_t word_idx;
-        for (word_idx = get_min_word_idx(r);
-             word_idx < get_max_word_idx(r);
-             word_idx++) {
-            set_word(r, word_idx, old_words[word_idx - get_min_word_idx(r)]);
-        }
-        free(old_words);
     }
 }
 
 void trim_least_significant_zeros(struct Real* r) {
-    // This function has to reference actual fields inside the struct Real
-    // in order to reallocate the words buffer.
+    // This only narrows the range of words, so it never reallocates and
+    // works on views too.
     ssize_t new_min_word_idx;
     ssize_t old_min_word_idx = get_min_word_idx(r);
 
@@ -274,26 +425,29 @@ void trim_least_significant_zeros(struct Real* r) {
     }
 
     if (new_min_word_idx == get_max_word_idx(r)) {
-        // `r` = 0. But it might already be as clean as possible.
-        if (old_min_word_idx != 0 || get_max_word_idx(r) != 1) {
-            free(r->words);
-            set_min_word_idx(r, 0);
-            set_max_word_idx(r, 1);
-            allocate_words(r);
-        }
-    }
-    else if (new_min_word_idx > old_min_word_idx) {
-        // We can decrease the allocated space.
-        word* old_words = r->words;
+        // `r` = 0, so keep just its first word, which is 0.
+        set_min_word_idx(r, 0);
+        set_max_word_idx(r, 1);
+    } else {
+        r->words += new_min_word_idx - old_min_word_idx;
         set_min_word_idx(r, new_min_word_idx);
+    }
+}
+
+void shift_words(struct Real* r, ssize_t num_words) {
+    set_min_word_idx(r, get_min_word_idx(r) + num_words);
+    set_max_word_idx(r, get_max_word_idx(r) + num_words);
+}
+
+void truncate_real(struct Real* r, ssize_t min_sig_word_idx) {
+    if (get_max_word_idx(r) <= min_sig_word_idx) {
+        // Nothing is left, so `r` = 0.
+        set_min_word_idx(r, 0);
+        set_max_word_idx(r, 1);
         allocate_words(r);
-        ssize_t word_idx;
-        for (word_idx = get_min_word_idx(r);
-             word_idx < get_max_word_idx(r);
-             word_idx++) {
-            set_word(r, word_idx, old_words[word_idx - old_min_word_idx]);
-        }
-        free(old_words);
+    } else if (get_min_word_idx(r) < min_sig_word_idx) {
+        r->words += min_sig_word_idx - get_min_word_idx(r);
+        set_min_word_idx(r, min_sig_word_idx);
     }
 }
 
@@ -319,3 +473,45 @@ void print_real(struct Real* r) {
     }
     fputs("\n", stdout);
 }
+
+int write_real(FILE* f, struct Real* r) {
+    int64_t header[3] = {get_sign(r), get_min_word_idx(r), get_max_word_idx(r)};
+    size_t num_words = get_max_word_idx(r) - get_min_word_idx(r);
+
+    if (fwrite(header, sizeof(int64_t), 3, f) != 3 ||
+        fwrite(r->words, sizeof(word), num_words, f) != num_words) {
+        return -1;
+    }
+    return 0;
+}
+
+struct Real* read_bounded_real(FILE* f, ssize_t max_abs_word_idx) {
+    // The header is checked before anything is allocated, so that a
+    // corrupt one can't ask for more memory than the bound allows.
+    int64_t header[3];
+    if (fread(header, sizeof(int64_t), 3, f) != 3 ||
+        (header[0] != POSITIVE && header[0] != NEGATIVE) ||
+        header[1] >= header[2] ||
+        header[1] < -max_abs_word_idx || header[2] > max_abs_word_idx) {
+        return NULL;
+    }
+
+    struct Real* r = alloc_real(header[0], header[1], header[2]);
+    if (r->words == NULL) {
+        // Out of memory.
+        free_real(r);
+        return NULL;
+    }
+
+    size_t num_words = get_max_word_idx(r) - get_min_word_idx(r);
+    if (fread(r->words, sizeof(word), num_words, f) != num_words) {
+        free_real(r);
+        return NULL;
+    }
+    return r;
+}
+
+struct Real* read_real(FILE* f) {
+    // Any more and the size in bytes wouldn't fit in a size_t.
+    return read_bounded_real(f, SSIZE_MAX / (2*sizeof(word)));
+}
@@ -4,6 +4,7 @@
 #include <sys/types.h>
 #include <stdint.h>
 #include <stdarg.h>
+#include <stdio.h>
 
 
 enum sign_t {
@@ -20,6 +21,8 @@ typedef uint32_t hword;
 #define MAX(x, y) (x >= y ? x : y)
 #define MIN(x, y) (x <= y ? x : y)
 
+#define WORD_BITS ((ssize_t) (sizeof(word)*8))
+
 
 // Functions for allocating and freeing structures.
 
@@ -50,9 +53,40 @@ void allocate_words(struct Real* r);
 // Creates a copy of `r`.
 struct Real* copy_real(struct Real* r);
 
+// Returns a read-only view of the words of `r` at indices in
+// [`min_word_idx`, `max_word_idx`), without copying them.
+//
+// The view shares `r`'s words, so this is O(1). It can be used anywhere
+// a struct Real is read, and it stays valid after `r` is freed or
+// changed: changing the words of `r` gives `r` its own copy first.
+// Free it with `free_real`. If the range doesn't overlap the words of
+// `r`, the result is 0.
+struct Real* view_real(struct Real* r,
+                       ssize_t min_word_idx,
+                       ssize_t max_word_idx);
+
+// Changes the range of word indices of `r` in-place. Words in both the
+// old and new ranges keep their values, and new words are 0.
+//
+// Each struct Real has a buffer that can be bigger than its range of
+// words, so this only reallocates when the new range doesn't fit in the
+// buffer (or the buffer is shared with a view). The buffer then grows
+// geometrically, so repeatedly extending a struct Real by a word at a
+// time costs amortized O(1) per word.
+// Returns 0 on success and -1 on error.
+int resize_real(struct Real* r,
+                ssize_t min_word_idx,
+                ssize_t max_word_idx);
+
 // Frees all memory associated with `r`.
 void free_real(struct Real* r);
 
+// Replaces the contents of `dst` with those of `src` and frees `src`.
+//
+// This lets in-place operations compute a new value and then swap it
+// into an existing struct Real.
+void move_real(struct Real* dst, struct Real* src);
+
 
 // Functions for getting and setting individual words.
 
@@ -76,17 +110,44 @@ void set_sign(struct Real* r, enum sign_t sign);
 
 // Miscellaneous functions.
 
+// Integer division rounding towards negative infinity, for `b` > 0.
+// This is useful for converting bit indices to word indices.
+ssize_t floor_div(ssize_t a, ssize_t b);
+
 // Checks if 2 real numbers are exactly arithmetically equal.
 //
 // It compares the signs and all words at all valid indices.
 int check_equal(struct Real* r1, struct Real* r2);
 
-// These functions trim the unneeded indices and space for `r`;
-// they operate in-place.
+// These functions trim the unneeded indices for `r`; they operate
+// in-place without copying any words, so they work on views too.
 void trim_most_significant_zeros(struct Real* r);
 void trim_least_significant_zeros(struct Real* r);
 void trim_zeros(struct Real* r);
 
+// Multiplies `r` by 2^(64 * num_words) in-place. This only changes the
+// word indices, so it's O(1) and works on views too.
+void shift_words(struct Real* r, ssize_t num_words);
+
+// Drops the words of `r` below `min_sig_word_idx` in-place, without
+// copying the rest, so it works on views too.
+void truncate_real(struct Real* r, ssize_t min_sig_word_idx);
+
 void print_real(struct Real* real);
 
+// Functions for storing struct Reals in binary files.
+//
+// The format is the sign and the word indices as 64-bit integers,
+// followed by the words, all in native byte order.
+// `write_real` returns 0 on success and -1 on error; `read_real` returns
+// NULL on error, including a header with an empty range of words or more
+// words than fit in memory.
+int write_real(FILE* f, struct Real* r);
+struct Real* read_real(FILE* f);
+
+// Like `read_real`, but also returns NULL if any of the word indices is
+// outside [-`max_abs_word_idx`, `max_abs_word_idx`], for input that
+// can't be trusted.
+struct Real* read_bounded_real(FILE* f, ssize_t max_abs_word_idx);
+
 #endif
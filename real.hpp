@@ -0,0 +1,553 @@
+#ifndef REAL_HPP
+#define REAL_HPP
+
+// A header-only C++ interface to struct Real.
+//
+// `real::Real` owns a struct Real and frees it when it goes out of
+// scope. It can be moved but not copied; use `clone` for a copy.
+//
+// Arithmetic on Reals builds an expression that's only evaluated when
+// it's assigned to a Real, straight into the words of the result. A sum
+// of products like `a*b + c*d - e` is accumulated into one struct Real
+// with `fma_with_sig` and `add_to`, and `(x*y)/k` divides the product in
+// place with `divide_by_word`, so neither allocates anything else.
+// Products of long operands (at least `thresholds.karatsuba_min_words`
+// words) are the exception: they're computed with Karatsuba and then
+// added in, since that beats the schoolbook `fma_with_sig` by far more
+// than the temporary costs.
+//
+// The precision comes from the innermost `real::Precision` on the thread:
+//
+//   real::Precision precision(-100);
+//   real::Real y = x*x/3 - a*b;
+//
+// keeps the words at or above index -100, as the `_with_sig` functions
+// do. Without one, sums, differences and products are exact and dividing
+// by a word keeps as many words as the dividend has, while everything
+// that can only be approximated throws std::logic_error. Like
+// `divide_by_word`, dividing by a word only works for divisors below
+// 2^32; larger ones throw std::domain_error, and can be divided by as
+// Reals instead.
+//
+// Expressions refer to their operands, so evaluate them in the statement
+// that makes them rather than keeping them in `auto` variables.
+
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cstdlib>
+#include <cstdint>
+
+extern "C" {
+#include "real.h"
+#include "arithmetic.h"
+#include "thresholds.h"
+#include "decimal.h"
+#include "constants.h"
+#include "exp_log.h"
+#include "trig.h"
+}
+
+namespace real {
+
+// Inside this namespace `Real` is the C++ class.
+using CReal = ::Real;
+
+
+// Sets the precision of everything evaluated on this thread until it
+// goes out of scope, when the previous one comes back.
+class Precision {
+public:
+    explicit Precision(ssize_t min_sig_word_idx) : previous_(state()) {
+        state().is_set = true;
+        state().min_sig_word_idx = min_sig_word_idx;
+    }
+    ~Precision() { state() = previous_; }
+    Precision(const Precision&) = delete;
+    Precision& operator=(const Precision&) = delete;
+
+    static bool is_set() { return state().is_set; }
+    // Only meaningful if `is_set`.
+    static ssize_t min_sig_word_idx() { return state().min_sig_word_idx; }
+
+private:
+    struct State {
+        bool is_set;
+        ssize_t min_sig_word_idx;
+    };
+    static State& state() {
+        static thread_local State current = {false, 0};
+        return current;
+    }
+    State previous_;
+};
+
+inline ssize_t required_precision(const char* what) {
+    if (!Precision::is_set()) {
+        throw std::logic_error(std::string(what) + " needs a real::Precision");
+    }
+    return Precision::min_sig_word_idx();
+}
+
+inline CReal* checked(CReal* r, const char* what) {
+    // The C functions return NULL for bad arguments and cancellation.
+    if (r == nullptr) {
+        throw std::runtime_error(std::string(what) + " failed");
+    }
+    return r;
+}
+
+inline void check_word_divisor(word divisor) {
+    // `divide_by_word` only has room for 32-bit divisors.
+    if (divisor == 0) {
+        throw std::domain_error("division by 0");
+    }
+    if (divisor > UINT32_MAX) {
+        throw std::domain_error("word divisors must be below 2^32");
+    }
+}
+
+
+// The base of all expressions, so operators can tell them apart from
+// other types.
+template <class E>
+struct Expr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+// Expressions are sums, differences and negations of terms. Each one can
+// `evaluate` itself into a new struct Real, or `accumulate` itself into
+// an existing one. Terms can also be accumulated into one of their own
+// operands.
+template <class E>
+struct is_term : std::true_type {};
+
+template <class E>
+CReal* evaluate_sum(const E& e) {
+    CReal* acc = fill_real(POSITIVE, 0, 1, (word) 0);
+    e.accumulate(acc, false);
+    if (Precision::is_set()) {
+        truncate_real(acc, Precision::min_sig_word_idx());
+    }
+    return acc;
+}
+
+
+class Real {
+public:
+    // 0.
+    Real() : r_(fill_real(POSITIVE, 0, 1, (word) 0)) {}
+    explicit Real(word w, enum sign_t sign = POSITIVE)
+        : r_(fill_real(sign, 0, 1, w)) {}
+    // Parses a decimal string like "-12.375".
+    explicit Real(const std::string& decimal)
+        : r_(checked(decimal_str_to_real(const_cast<char*>(decimal.c_str())),
+                     "parsing")) {}
+    // Takes ownership of `r`.
+    explicit Real(CReal* r) : r_(checked(r, "the computation")) {}
+
+    template <class E>
+    Real(const Expr<E>& e) : r_(e.self().evaluate()) {}
+
+    // A moved-from Real can only be assigned to or destroyed.
+    Real(Real&& other) noexcept : r_(other.r_) { other.r_ = nullptr; }
+    Real& operator=(Real&& other) noexcept {
+        std::swap(r_, other.r_);
+        return *this;
+    }
+    Real(const Real&) = delete;
+    Real& operator=(const Real&) = delete;
+
+    ~Real() {
+        if (r_ != nullptr) {
+            free_real(r_);
+        }
+    }
+
+    // The expression is evaluated before the old value goes, so it can
+    // use this Real.
+    template <class E>
+    Real& operator=(const Expr<E>& e) {
+        CReal* r = e.self().evaluate();
+        if (r_ != nullptr) {
+            free_real(r_);
+        }
+        r_ = r;
+        return *this;
+    }
+
+    // These work on this Real's words in place.
+    template <class T>
+    Real& operator+=(const T& x);
+    template <class T>
+    Real& operator-=(const T& x);
+    Real& operator/=(word divisor) {
+        check_word_divisor(divisor);
+        divide_by_word(r_, divisor, Precision::is_set()
+                       ? Precision::min_sig_word_idx()
+                       : get_min_word_idx(r_));
+        return *this;
+    }
+
+    Real clone() const { return Real(copy_real(r_)); }
+
+    // The struct Real still belongs to this Real.
+    CReal* get() const { return r_; }
+    // The caller takes ownership, and this Real is left moved-from.
+    CReal* release() {
+        CReal* r = r_;
+        r_ = nullptr;
+        return r;
+    }
+
+    enum sign_t sign() const { return get_sign(r_); }
+    bool is_zero() const { return ::is_zero(r_) != 0; }
+
+    std::string to_string() const {
+        char* s = real_to_decimal_str(r_);
+        std::string rtn(s);
+        free(s);
+        return rtn;
+    }
+
+private:
+    template <class E>
+    void accumulate(const E& e, bool subtract);
+
+    CReal* r_;
+};
+
+
+// A Real in an expression.
+struct Ref : Expr<Ref> {
+    explicit Ref(const Real& real) : r(real.get()) {}
+
+    CReal* evaluate() const {
+        if (Precision::is_set()) {
+            return div_with_sig(r, 1, Precision::min_sig_word_idx());
+        }
+        return copy_real(r);
+    }
+    void accumulate(CReal* acc, bool subtract) const {
+        if (subtract) {
+            subtract_from(acc, r);
+        } else {
+            add_to(acc, r);
+        }
+    }
+
+    CReal* r;
+};
+
+// The struct Real an operand of a product or a quotient refers to,
+// evaluating it first unless it's just a Real.
+class Operand {
+public:
+    explicit Operand(const Ref& ref) : r_(ref.r), owned_(false) {}
+    template <class E>
+    explicit Operand(const Expr<E>& e)
+        : r_(e.self().evaluate()), owned_(true) {}
+    ~Operand() {
+        if (owned_) {
+            free_real(r_);
+        }
+    }
+    Operand(const Operand&) = delete;
+    Operand& operator=(const Operand&) = delete;
+
+    CReal* get() const { return r_; }
+
+private:
+    CReal* r_;
+    bool owned_;
+};
+
+template <class L, class R>
+struct Sum : Expr<Sum<L, R>> {
+    Sum(const L& l, const R& r) : l(l), r(r) {}
+
+    CReal* evaluate() const { return evaluate_sum(*this); }
+    void accumulate(CReal* acc, bool subtract) const {
+        l.accumulate(acc, subtract);
+        r.accumulate(acc, subtract);
+    }
+
+    L l;
+    R r;
+};
+
+template <class L, class R>
+struct Difference : Expr<Difference<L, R>> {
+    Difference(const L& l, const R& r) : l(l), r(r) {}
+
+    CReal* evaluate() const { return evaluate_sum(*this); }
+    void accumulate(CReal* acc, bool subtract) const {
+        l.accumulate(acc, subtract);
+        r.accumulate(acc, !subtract);
+    }
+
+    L l;
+    R r;
+};
+
+template <class E>
+struct Negation : Expr<Negation<E>> {
+    explicit Negation(const E& e) : e(e) {}
+
+    CReal* evaluate() const { return evaluate_sum(*this); }
+    void accumulate(CReal* acc, bool subtract) const {
+        e.accumulate(acc, !subtract);
+    }
+
+    E e;
+};
+
+template <class L, class R>
+struct is_term<Sum<L, R>> : std::false_type {};
+template <class L, class R>
+struct is_term<Difference<L, R>> : std::false_type {};
+template <class E>
+struct is_term<Negation<E>> : std::false_type {};
+
+inline ssize_t product_precision(CReal* a, CReal* b) {
+    return Precision::is_set() ? Precision::min_sig_word_idx()
+        : get_min_word_idx(a) + get_min_word_idx(b);
+}
+
+template <class L, class R>
+struct Product : Expr<Product<L, R>> {
+    Product(const L& l, const R& r) : l(l), r(r) {}
+
+    CReal* evaluate() const {
+        Operand a(l);
+        Operand b(r);
+        return mul_with_sig(a.get(), b.get(),
+                            product_precision(a.get(), b.get()));
+    }
+    void accumulate(CReal* acc, bool subtract) const {
+        Operand a(l);
+        Operand b(r);
+        ssize_t min_sig_word_idx = product_precision(a.get(), b.get());
+        if (MIN(get_max_word_idx(a.get()) - get_min_word_idx(a.get()),
+                get_max_word_idx(b.get()) - get_min_word_idx(b.get()))
+            < thresholds.karatsuba_min_words) {
+            if (subtract) {
+                fms_with_sig(acc, a.get(), b.get(), min_sig_word_idx);
+            } else {
+                fma_with_sig(acc, a.get(), b.get(), min_sig_word_idx);
+            }
+        } else {
+            CReal* p = mul_with_sig(a.get(), b.get(), min_sig_word_idx);
+            if (subtract) {
+                subtract_from(acc, p);
+            } else {
+                add_to(acc, p);
+            }
+            free_real(p);
+        }
+    }
+
+    L l;
+    R r;
+};
+
+template <class E>
+CReal* accumulate_evaluated(const E& e, CReal* acc, bool subtract) {
+    CReal* r = e.evaluate();
+    if (subtract) {
+        subtract_from(acc, r);
+    } else {
+        add_to(acc, r);
+    }
+    free_real(r);
+    return acc;
+}
+
+// Division by a word.
+template <class E>
+struct WordQuotient : Expr<WordQuotient<E>> {
+    WordQuotient(const E& e, word divisor) : e(e), divisor(divisor) {
+        check_word_divisor(divisor);
+    }
+
+    CReal* evaluate() const {
+        CReal* q = e.evaluate();
+        divide_by_word(q, divisor, Precision::is_set()
+                       ? Precision::min_sig_word_idx()
+                       : get_min_word_idx(q));
+        return q;
+    }
+    void accumulate(CReal* acc, bool subtract) const {
+        accumulate_evaluated(*this, acc, subtract);
+    }
+
+    E e;
+    word divisor;
+};
+
+// Division by a Real, which needs a precision.
+template <class L, class R>
+struct Quotient : Expr<Quotient<L, R>> {
+    Quotient(const L& l, const R& r) : l(l), r(r) {}
+
+    CReal* evaluate() const {
+        ssize_t min_sig_word_idx = required_precision("division");
+        Operand a(l);
+        Operand b(r);
+        return checked(div_real_with_sig(a.get(), b.get(), min_sig_word_idx),
+                       "division");
+    }
+    void accumulate(CReal* acc, bool subtract) const {
+        accumulate_evaluated(*this, acc, subtract);
+    }
+
+    L l;
+    R r;
+};
+
+
+template <class T>
+struct is_operand
+    : std::integral_constant<bool, std::is_same<T, Real>::value
+                             || std::is_base_of<Expr<T>, T>::value> {};
+
+// The expression type an operand is stored as.
+template <class T>
+struct operand_of {
+    using type = T;
+};
+template <>
+struct operand_of<Real> {
+    using type = Ref;
+};
+
+template <class T>
+using operand_t = typename operand_of<T>::type;
+
+template <class L, class R>
+using if_operands = typename std::enable_if<is_operand<L>::value
+                                            && is_operand<R>::value>::type;
+
+inline Ref as_operand(const Real& r) {
+    return Ref(r);
+}
+template <class E>
+const E& as_operand(const Expr<E>& e) {
+    return e.self();
+}
+
+template <class L, class R, class = if_operands<L, R>>
+Sum<operand_t<L>, operand_t<R>> operator+(const L& l, const R& r) {
+    return {as_operand(l), as_operand(r)};
+}
+
+template <class L, class R, class = if_operands<L, R>>
+Difference<operand_t<L>, operand_t<R>> operator-(const L& l, const R& r) {
+    return {as_operand(l), as_operand(r)};
+}
+
+template <class L, class R, class = if_operands<L, R>>
+Product<operand_t<L>, operand_t<R>> operator*(const L& l, const R& r) {
+    return {as_operand(l), as_operand(r)};
+}
+
+template <class L, class R, class = if_operands<L, R>>
+Quotient<operand_t<L>, operand_t<R>> operator/(const L& l, const R& r) {
+    return {as_operand(l), as_operand(r)};
+}
+
+template <class T, class = if_operands<T, T>>
+WordQuotient<operand_t<T>> operator/(const T& x, word divisor) {
+    return {as_operand(x), divisor};
+}
+
+template <class T, class = if_operands<T, T>>
+Negation<operand_t<T>> operator-(const T& x) {
+    return Negation<operand_t<T>>(as_operand(x));
+}
+
+
+template <class E>
+void Real::accumulate(const E& e, bool subtract) {
+    if (is_term<E>::value) {
+        e.accumulate(r_, subtract);
+    } else {
+        // The terms of a sum could change this Real before the rest of
+        // the sum reads it.
+        accumulate_evaluated(e, r_, subtract);
+    }
+    if (Precision::is_set()) {
+        truncate_real(r_, Precision::min_sig_word_idx());
+    }
+}
+
+template <class T>
+Real& Real::operator+=(const T& x) {
+    static_assert(is_operand<T>::value, "can only add Reals and expressions");
+    accumulate(as_operand(x), false);
+    return *this;
+}
+
+template <class T>
+Real& Real::operator-=(const T& x) {
+    static_assert(is_operand<T>::value,
+                  "can only subtract Reals and expressions");
+    accumulate(as_operand(x), true);
+    return *this;
+}
+
+
+// Functions of a Real or an expression, which all need a precision.
+
+template <class T, class = if_operands<T, T>>
+Real sqrt(const T& x) {
+    ssize_t min_sig_word_idx = required_precision("sqrt");
+    Operand a(as_operand(x));
+    return Real(checked(sqrt_with_sig(a.get(), min_sig_word_idx), "sqrt"));
+}
+
+template <class T, class = if_operands<T, T>>
+Real exp(const T& x) {
+    ssize_t min_sig_word_idx = required_precision("exp");
+    Operand a(as_operand(x));
+    return Real(checked(exp_with_sig(a.get(), min_sig_word_idx), "exp"));
+}
+
+template <class T, class = if_operands<T, T>>
+Real log(const T& x) {
+    ssize_t min_sig_word_idx = required_precision("log");
+    Operand a(as_operand(x));
+    return Real(checked(log_with_sig(a.get(), min_sig_word_idx), "log"));
+}
+
+template <class T, class = if_operands<T, T>>
+Real cos(const T& x) {
+    ssize_t min_sig_word_idx = required_precision("cos");
+    Operand a(as_operand(x));
+    return Real(checked(cos_with_sig(a.get(), min_sig_word_idx), "cos"));
+}
+
+template <class T, class = if_operands<T, T>>
+Real sin(const T& x) {
+    ssize_t min_sig_word_idx = required_precision("sin");
+    Operand a(as_operand(x));
+    return Real(checked(sin_with_sig(a.get(), min_sig_word_idx), "sin"));
+}
+
+// The constants come from the constant cache.
+inline Real pi() {
+    return Real(get_constant(CONSTANT_PI, required_precision("pi")));
+}
+
+inline Real e() {
+    return Real(get_constant(CONSTANT_E, required_precision("e")));
+}
+
+inline Real ln2() {
+    return Real(get_constant(CONSTANT_LN2, required_precision("ln2")));
+}
+
+}  // namespace real
+
+#endif
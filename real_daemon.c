@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "constants.h"
+#include "service.h"
+
+// Serves computations over a Unix domain socket (see service.h) until
+// it's interrupted or terminated:
+//
+//   real_daemon <socket_path> [num_workers] [constant_cache] [timeout]
+//
+// With one worker per CPU and a timeout of a minute per request by
+// default. The constant cache is loaded when it starts, if there is
+// one, and saved when it stops, so the constants stay warm across
+// restarts.
+
+#define DEFAULT_TIMEOUT 60.0
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 5) {
+        puts("usage: real_daemon <socket_path> [num_workers] "
+             "[constant_cache] [timeout]");
+        return 1;
+    }
+    int num_workers = (argc > 2) ? atoi(argv[2]) : 0;
+    char* cache_path = (argc > 3) ? argv[3] : NULL;
+    double timeout = (argc > 4) ? atof(argv[4]) : DEFAULT_TIMEOUT;
+
+    if (cache_path != NULL && load_constant_cache(cache_path) != 0) {
+        printf("Starting without a constant cache from %s.\n", cache_path);
+    }
+
+    // Block the signals in every thread, so that only `sigwait` sees them,
+    // and ignore clients that hang up before reading their results.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    struct Service* service = start_service(argv[1], num_workers, timeout);
+    if (service == NULL) {
+        printf("Can't serve at %s!\n", argv[1]);
+        return 1;
+    }
+
+    int sig;
+    sigwait(&signals, &sig);
+    stop_service(service);
+
+    int rtn = 0;
+    if (cache_path != NULL && save_constant_cache(cache_path) != 0) {
+        printf("Can't save the constant cache to %s!\n", cache_path);
+        rtn = 1;
+    }
+    clear_constant_cache();
+    return rtn;
+}
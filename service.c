@@ -0,0 +1,515 @@
+#include "service.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "constants.h"
+#include "trig.h"
+#include "exp_log.h"
+#include "progress.h"
+
+
+int service_op_num_args(enum service_op_t op) {
+    switch (op) {
+    case SERVICE_PI:
+    case SERVICE_E:
+    case SERVICE_LN2:
+        return 0;
+    case SERVICE_SQRT:
+    case SERVICE_EXP:
+    case SERVICE_LOG:
+    case SERVICE_COS:
+    case SERVICE_SIN:
+        return 1;
+    case SERVICE_ADD:
+    case SERVICE_SUBTRACT:
+    case SERVICE_MULTIPLY:
+    case SERVICE_DIVIDE:
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+int is_constant_op(enum service_op_t op) {
+    return service_op_num_args(op) == 0;
+}
+
+enum constant_t op_constant(enum service_op_t op) {
+    switch (op) {
+    case SERVICE_E:
+        return CONSTANT_E;
+    case SERVICE_LN2:
+        return CONSTANT_LN2;
+    default:
+        return CONSTANT_PI;
+    }
+}
+
+struct Real* compute_op(enum service_op_t op, struct Real** args,
+                        ssize_t min_sig_word_idx) {
+    struct Real* temp;
+    struct Real* rtn = NULL;
+    switch (op) {
+    case SERVICE_ADD:
+    case SERVICE_SUBTRACT:
+        temp = (op == SERVICE_ADD) ? add(args[0], args[1])
+            : subtract(args[0], args[1]);
+        rtn = div_with_sig(temp, 1, min_sig_word_idx);
+        free_real(temp);
+        break;
+    case SERVICE_MULTIPLY:
+        rtn = mul_with_sig(args[0], args[1], min_sig_word_idx);
+        break;
+    case SERVICE_DIVIDE:
+        rtn = div_real_with_sig(args[0], args[1], min_sig_word_idx);
+        break;
+    case SERVICE_SQRT:
+        rtn = sqrt_with_sig(args[0], min_sig_word_idx);
+        break;
+    case SERVICE_EXP:
+        rtn = exp_with_sig(args[0], min_sig_word_idx);
+        break;
+    case SERVICE_LOG:
+        rtn = log_with_sig(args[0], min_sig_word_idx);
+        break;
+    case SERVICE_COS:
+        rtn = cos_with_sig(args[0], min_sig_word_idx);
+        break;
+    case SERVICE_SIN:
+        rtn = sin_with_sig(args[0], min_sig_word_idx);
+        break;
+    default:
+        break;
+    }
+    return rtn;
+}
+
+
+// The server.
+
+struct Request {
+    enum service_op_t op;
+    ssize_t min_sig_word_idx;
+    struct Real* args[2];
+    // Set by the worker, which then sets `done`. NULL if the operation
+    // failed.
+    struct Real* result;
+    int done;
+    struct Request* next;
+};
+
+struct Connection {
+    int fd;
+    struct Service* service;
+    struct Connection* next;
+};
+
+struct Service {
+    char* path;
+    int listen_fd;
+    pthread_t listener;
+    int num_workers;
+    pthread_t* workers;
+    double timeout;
+
+    // Everything below is protected by `lock`.
+    pthread_mutex_t lock;
+    // Signalled when a request is queued or the workers should stop.
+    pthread_cond_t queued;
+    // Signalled when requests are done.
+    pthread_cond_t finished;
+    // Signalled when a connection goes away.
+    pthread_cond_t disconnected;
+    struct Request* head;
+    struct Request* tail;
+    int stopping;
+    struct Connection* connections;
+};
+
+void run_batch(struct Request* batch) {
+    // Either a single request, or requests for the same constant, which
+    // share one lookup at the finest precision any of them wants.
+    struct Request* request;
+    if (is_constant_op(batch->op)) {
+        ssize_t min_sig_word_idx = batch->min_sig_word_idx;
+        for (request = batch; request != NULL; request = request->next) {
+            min_sig_word_idx = MIN(min_sig_word_idx,
+                                   request->min_sig_word_idx);
+        }
+        struct Real* value = get_constant(op_constant(batch->op),
+                                          min_sig_word_idx);
+        if (value == NULL) {
+            // Cancelled, so they all fail.
+            return;
+        }
+        for (request = batch; request != NULL; request = request->next) {
+            request->result = div_with_sig(value, 1,
+                                           request->min_sig_word_idx);
+        }
+        free_real(value);
+    } else {
+        batch->result = compute_op(batch->op, batch->args,
+                                   batch->min_sig_word_idx);
+    }
+}
+
+void* run_worker(void* arg) {
+    struct Service* service = (struct Service*) arg;
+    struct Request* batch;
+    struct Request* batch_tail;
+    struct Request* request;
+    struct Request** link;
+    struct Progress progress;
+
+    pthread_mutex_lock(&service->lock);
+    while (1) {
+        while (service->head == NULL && !service->stopping) {
+            pthread_cond_wait(&service->queued, &service->lock);
+        }
+        if (service->head == NULL) {
+            break;
+        }
+
+        // Take the oldest request. If it's for a constant, take every
+        // other request for that constant too, keeping their order. Other
+        // operations have nothing to share, so they're left for the other
+        // workers to run at the same time.
+        batch = service->head;
+        service->head = batch->next;
+        batch->next = NULL;
+        if (service->head == NULL) {
+            service->tail = NULL;
+        } else if (is_constant_op(batch->op)) {
+            batch_tail = batch;
+            link = &service->head;
+            service->tail = NULL;
+            while (*link != NULL) {
+                request = *link;
+                if (request->op == batch->op) {
+                    *link = request->next;
+                    request->next = NULL;
+                    batch_tail->next = request;
+                    batch_tail = request;
+                } else {
+                    service->tail = request;
+                    link = &request->next;
+                }
+            }
+        }
+        pthread_mutex_unlock(&service->lock);
+
+        init_progress(&progress, (service->timeout > 0)
+                      ? monotonic_seconds() + service->timeout : 0);
+        set_thread_progress(&progress);
+        run_batch(batch);
+        set_thread_progress(NULL);
+
+        pthread_mutex_lock(&service->lock);
+        while (batch != NULL) {
+            request = batch;
+            batch = batch->next;
+            request->done = 1;
+        }
+        pthread_cond_broadcast(&service->finished);
+    }
+    pthread_mutex_unlock(&service->lock);
+    return NULL;
+}
+
+struct Request* read_request(FILE* in) {
+    // Returns NULL at the end of the connection or if the request is
+    // malformed, after which the connection can't be trusted.
+    int64_t header[2];
+    if (fread(header, sizeof(int64_t), 2, in) != 2) {
+        return NULL;
+    }
+    int num_args = service_op_num_args(header[0]);
+    if (num_args < 0 || header[1] < -SERVICE_MAX_WORD_IDX ||
+        header[1] > SERVICE_MAX_WORD_IDX) {
+        return NULL;
+    }
+
+    struct Request* request = malloc(sizeof(struct Request));
+    request->op = header[0];
+    request->min_sig_word_idx = header[1];
+    request->args[0] = NULL;
+    request->args[1] = NULL;
+    request->result = NULL;
+    request->done = 0;
+    request->next = NULL;
+
+    int i;
+    for (i = 0; i < num_args; i++) {
+        request->args[i] = read_bounded_real(in, SERVICE_MAX_WORD_IDX);
+        if (request->args[i] == NULL) {
+            break;
+        }
+    }
+    if (i < num_args) {
+        for (i = 0; i < num_args; i++) {
+            if (request->args[i] != NULL) {
+                free_real(request->args[i]);
+            }
+        }
+        free(request);
+        return NULL;
+    }
+    return request;
+}
+
+int write_response(FILE* out, struct Real* result) {
+    int64_t status = (result != NULL) ? 0 : -1;
+    if (fwrite(&status, sizeof(int64_t), 1, out) != 1 ||
+        (result != NULL && write_real(out, result) != 0) ||
+        fflush(out) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+void* serve_connection(void* arg) {
+    struct Connection* connection = (struct Connection*) arg;
+    struct Service* service = connection->service;
+
+    FILE* in = fdopen(dup(connection->fd), "rb");
+    FILE* out = fdopen(dup(connection->fd), "wb");
+
+    struct Request* request;
+    int ok = (in != NULL && out != NULL);
+    int i;
+    while (ok && (request = read_request(in)) != NULL) {
+        pthread_mutex_lock(&service->lock);
+        if (service->tail != NULL) {
+            service->tail->next = request;
+        } else {
+            service->head = request;
+        }
+        service->tail = request;
+        pthread_cond_signal(&service->queued);
+        while (!request->done) {
+            pthread_cond_wait(&service->finished, &service->lock);
+        }
+        pthread_mutex_unlock(&service->lock);
+
+        ok = (write_response(out, request->result) == 0);
+
+        for (i = 0; i < 2; i++) {
+            if (request->args[i] != NULL) {
+                free_real(request->args[i]);
+            }
+        }
+        if (request->result != NULL) {
+            free_real(request->result);
+        }
+        free(request);
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+
+    // `stop_service` shuts down the connections it finds on the list, so
+    // the socket stays open until it's off the list.
+    pthread_mutex_lock(&service->lock);
+    struct Connection** link = &service->connections;
+    while (*link != connection) {
+        link = &(*link)->next;
+    }
+    *link = connection->next;
+    close(connection->fd);
+    free(connection);
+    pthread_cond_broadcast(&service->disconnected);
+    pthread_mutex_unlock(&service->lock);
+    return NULL;
+}
+
+void* run_listener(void* arg) {
+    struct Service* service = (struct Service*) arg;
+    int fd;
+    pthread_t thread;
+    struct Connection* connection;
+    while ((fd = accept(service->listen_fd, NULL, NULL)) >= 0) {
+        connection = malloc(sizeof(struct Connection));
+        connection->fd = fd;
+        connection->service = service;
+
+        pthread_mutex_lock(&service->lock);
+        connection->next = service->connections;
+        service->connections = connection;
+        pthread_mutex_unlock(&service->lock);
+
+        if (pthread_create(&thread, NULL, serve_connection, connection)
+            != 0) {
+            pthread_mutex_lock(&service->lock);
+            service->connections = connection->next;
+            pthread_mutex_unlock(&service->lock);
+            close(fd);
+            free(connection);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+struct Service* start_service(char* path, int num_workers, double timeout) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        puts("Socket path too long!");
+        return NULL;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0 ||
+        listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    if (num_workers <= 0) {
+        num_workers = MAX(1, sysconf(_SC_NPROCESSORS_ONLN));
+    }
+
+    struct Service* service = malloc(sizeof(struct Service));
+    service->path = strdup(path);
+    service->listen_fd = fd;
+    service->num_workers = num_workers;
+    service->workers = malloc(num_workers * sizeof(pthread_t));
+    service->timeout = timeout;
+    pthread_mutex_init(&service->lock, NULL);
+    pthread_cond_init(&service->queued, NULL);
+    pthread_cond_init(&service->finished, NULL);
+    pthread_cond_init(&service->disconnected, NULL);
+    service->head = NULL;
+    service->tail = NULL;
+    service->stopping = 0;
+    service->connections = NULL;
+
+    int i;
+    for (i = 0; i < num_workers; i++) {
+        pthread_create(&service->workers[i], NULL, run_worker, service);
+    }
+    pthread_create(&service->listener, NULL, run_listener, service);
+    return service;
+}
+
+void stop_service(struct Service* service) {
+    // Shutting down the listening socket makes `accept` fail.
+    shutdown(service->listen_fd, SHUT_RDWR);
+    pthread_join(service->listener, NULL);
+    close(service->listen_fd);
+    unlink(service->path);
+
+    // Each connection finishes the request it's waiting on, if any, and
+    // then sees the end of its socket.
+    pthread_mutex_lock(&service->lock);
+    struct Connection* connection;
+    for (connection = service->connections; connection != NULL;
+         connection = connection->next) {
+        shutdown(connection->fd, SHUT_RDWR);
+    }
+    while (service->connections != NULL) {
+        pthread_cond_wait(&service->disconnected, &service->lock);
+    }
+    service->stopping = 1;
+    pthread_cond_broadcast(&service->queued);
+    pthread_mutex_unlock(&service->lock);
+
+    int i;
+    for (i = 0; i < service->num_workers; i++) {
+        pthread_join(service->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&service->disconnected);
+    pthread_cond_destroy(&service->finished);
+    pthread_cond_destroy(&service->queued);
+    pthread_mutex_destroy(&service->lock);
+    free(service->workers);
+    free(service->path);
+    free(service);
+}
+
+
+// The client.
+
+struct ServiceConnection {
+    FILE* in;
+    FILE* out;
+};
+
+struct ServiceConnection* connect_service(char* path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        return NULL;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    struct ServiceConnection* connection = malloc(
+        sizeof(struct ServiceConnection));
+    connection->in = fdopen(fd, "rb");
+    connection->out = fdopen(dup(fd), "wb");
+    return connection;
+}
+
+void close_service_connection(struct ServiceConnection* connection) {
+    fclose(connection->out);
+    fclose(connection->in);
+    free(connection);
+}
+
+struct Real* call_service(struct ServiceConnection* connection,
+                          enum service_op_t op, struct Real** args,
+                          ssize_t min_sig_word_idx) {
+    int num_args = service_op_num_args(op);
+    if (num_args < 0) {
+        return NULL;
+    }
+
+    int64_t header[2] = {op, min_sig_word_idx};
+    if (fwrite(header, sizeof(int64_t), 2, connection->out) != 2) {
+        return NULL;
+    }
+    int i;
+    for (i = 0; i < num_args; i++) {
+        if (write_real(connection->out, args[i]) != 0) {
+            return NULL;
+        }
+    }
+    if (fflush(connection->out) != 0) {
+        return NULL;
+    }
+
+    int64_t status;
+    if (fread(&status, sizeof(int64_t), 1, connection->in) != 1 ||
+        status != 0) {
+        return NULL;
+    }
+    return read_real(connection->in);
+}
@@ -0,0 +1,88 @@
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include "real.h"
+
+// A long-running service that does computations for other processes over
+// a Unix domain socket, so they can share its warm caches (the constants
+// and the powers of ten) instead of each recomputing them.
+//
+// Each connection sends a request and waits for its result, any number
+// of times. Requests from all of the connections go onto one queue,
+// which a pool of worker threads takes from in order. A worker that
+// takes a request for a constant also takes every other queued request
+// for that constant, and answers them with a single computation at the
+// most precise of their precisions. Other requests each get a worker of
+// their own.
+//
+// A request is the operation and `min_sig_word_idx` as 64-bit integers,
+// followed by the arguments in the `write_real` format. A response is a
+// 64-bit status, 0 or -1, followed by the result in the `write_real`
+// format if the status is 0.
+//
+// So that one request can't take all of the service's memory or hold a
+// worker for long, the word indices of the arguments and
+// `min_sig_word_idx` have to be within `SERVICE_MAX_WORD_IDX` of 0. The
+// service closes the connection of a request that's out of bounds, like
+// any other malformed one. Multiplying and dividing can't be cancelled,
+// so the bound is what keeps them to seconds; everything else is also
+// stopped at the service's timeout, and then fails.
+//
+// Writing to a socket whose other end has closed raises SIGPIPE, so
+// processes using either side should ignore it.
+
+#define SERVICE_MAX_WORD_IDX ((ssize_t) 1 << 14)
+
+enum service_op_t {
+    SERVICE_PI,
+    SERVICE_E,
+    SERVICE_LN2,
+    SERVICE_ADD,
+    SERVICE_SUBTRACT,
+    SERVICE_MULTIPLY,
+    SERVICE_DIVIDE,
+    SERVICE_SQRT,
+    SERVICE_EXP,
+    SERVICE_LOG,
+    SERVICE_COS,
+    SERVICE_SIN,
+    NUM_SERVICE_OPS
+};
+
+// Returns how many arguments `op` takes, or -1 if it isn't an operation.
+int service_op_num_args(enum service_op_t op);
+
+
+// The server.
+
+struct Service;
+
+// Starts serving on a socket at `path`, which must not exist yet, with
+// `num_workers` worker threads (or one per CPU if 0). A request that's
+// still computing `timeout` seconds after a worker took it is cancelled
+// (see progress.h), unless `timeout` is 0. Returns NULL if the socket
+// can't be created.
+struct Service* start_service(char* path, int num_workers, double timeout);
+
+// Stops accepting connections, finishes the queued requests, closes all
+// of the connections and removes the socket.
+void stop_service(struct Service* service);
+
+
+// The client.
+
+struct ServiceConnection;
+
+// Returns NULL if nothing is serving at `path`.
+struct ServiceConnection* connect_service(char* path);
+
+void close_service_connection(struct ServiceConnection* connection);
+
+// Computes `op` of `args` (as many as it takes) to within a few units of
+// the word at `min_sig_word_idx`. Returns NULL if the service can't
+// compute it (e.g. dividing by 0) or in time, or the connection fails.
+struct Real* call_service(struct ServiceConnection* connection,
+                          enum service_op_t op, struct Real** args,
+                          ssize_t min_sig_word_idx);
+
+#endif
@@ -0,0 +1,292 @@
+#include "shared_mul.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "progress.h"
+#include "thresholds.h"
+
+
+struct SplitProducts {
+    // While collecting, `products` is NULL, and the operands of each
+    // sub-product are appended to `operands` in pairs. While combining,
+    // the sub-products are taken from `products` in the same order.
+    struct Real** operands;
+    int num_products;
+    struct Real** products;
+    int next;
+};
+
+struct Real* split_karatsuba(struct Real* a, struct Real* b, int depth,
+                             struct SplitProducts* split) {
+    // Follows `karatsuba` for `depth` levels. While collecting, records
+    // the products it would compute at that depth and returns NULL.
+    // While combining, returns a * b made from those products.
+    if (get_max_word_idx(a) < get_max_word_idx(b)) {
+        struct Real* temp = a;
+        a = b;
+        b = temp;
+    }
+    if (depth == 0 || get_max_word_idx(b) < thresholds.karatsuba_min_words) {
+        if (split->products != NULL) {
+            return split->products[split->next++];
+        }
+        split->operands[2*split->num_products] = view_real(
+            a, 0, get_max_word_idx(a));
+        split->operands[2*split->num_products + 1] = view_real(
+            b, 0, get_max_word_idx(b));
+        split->num_products++;
+        return NULL;
+    }
+
+    ssize_t half = (get_max_word_idx(a) + 1) / 2;
+    struct Real* a0 = view_real(a, 0, half);
+    struct Real* a1 = view_real(a, half, get_max_word_idx(a));
+    shift_words(a1, -half);
+
+    struct Real* p;
+    if (get_max_word_idx(b) <= half) {
+        struct Real* high = split_karatsuba(a1, b, depth - 1, split);
+        p = split_karatsuba(a0, b, depth - 1, split);
+        if (p != NULL) {
+            shift_words(high, half);
+            add_to(p, high);
+            free_real(high);
+        }
+    } else {
+        struct Real* b0 = view_real(b, 0, half);
+        struct Real* b1 = view_real(b, half, get_max_word_idx(b));
+        shift_words(b1, -half);
+
+        struct Real* z2 = split_karatsuba(a1, b1, depth - 1, split);
+        p = split_karatsuba(a0, b0, depth - 1, split);
+        struct Real* sum_a = add(a0, a1);
+        struct Real* sum_b = add(b0, b1);
+        struct Real* z1 = split_karatsuba(sum_a, sum_b, depth - 1, split);
+        if (p != NULL) {
+            subtract_from(z1, p);
+            subtract_from(z1, z2);
+            shift_words(z1, half);
+            shift_words(z2, 2*half);
+            add_to(p, z1);
+            add_to(p, z2);
+            free_real(z1);
+            free_real(z2);
+        }
+
+        free_real(b0);
+        free_real(b1);
+        free_real(sum_a);
+        free_real(sum_b);
+    }
+    free_real(a0);
+    free_real(a1);
+    return p;
+}
+
+
+// The shared memory starts with a `struct SharedProduct` for each
+// sub-product, followed by the words of all of the operands and products.
+// Operands and products are non-negative integers, stored from word 0.
+
+struct SharedProduct {
+    // Offsets are in words from the start of the words.
+    int64_t offsets[3];
+    int64_t num_words[3];
+    // Set by the worker once the product is written.
+    int64_t done;
+};
+
+struct SharedMemory {
+    struct SharedProduct* products;
+    word* words;
+    size_t size;
+};
+
+void store_words(word* dst, struct Real* r, ssize_t num_words) {
+    ssize_t i;
+    for (i = 0; i < num_words; i++) {
+        dst[i] = get_word(r, i);
+    }
+}
+
+struct Real* load_words(word* src, ssize_t num_words) {
+    struct Real* r = alloc_real(POSITIVE, 0, num_words);
+    ssize_t i;
+    for (i = 0; i < num_words; i++) {
+        set_word(r, i, src[i]);
+    }
+    return r;
+}
+
+int create_shared_memory(struct SharedMemory* shared, int num_products,
+                         size_t num_words) {
+    // Returns 0 on success and -1 on error.
+    static int counter = 0;
+    char name[64];
+    snprintf(name, sizeof(name), "/real_mul_%d_%d", getpid(),
+             __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED));
+
+    shared->size = (num_products * sizeof(struct SharedProduct)
+                    + num_words * sizeof(word));
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+    // The workers inherit the mapping, so nothing needs the name again,
+    // and unlinking it now means nothing is left behind.
+    shm_unlink(name);
+    void* map = MAP_FAILED;
+    if (ftruncate(fd, shared->size) == 0) {
+        map = mmap(NULL, shared->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    shared->products = (struct SharedProduct*) map;
+    shared->words = (word*) (shared->products + num_products);
+    return 0;
+}
+
+void compute_shared_product(struct SharedMemory* shared, int i) {
+    struct SharedProduct* product = &shared->products[i];
+    struct Real* a = load_words(shared->words + product->offsets[0],
+                                product->num_words[0]);
+    struct Real* b = load_words(shared->words + product->offsets[1],
+                                product->num_words[1]);
+    struct Real* p = multiply(a, b);
+    store_words(shared->words + product->offsets[2], p,
+                product->num_words[2]);
+    __atomic_store_n(&product->done, 1, __ATOMIC_RELEASE);
+    free_real(a);
+    free_real(b);
+    free_real(p);
+}
+
+struct Real* multiply_in_processes(struct Real* r1, struct Real* r2,
+                                   int num_processes) {
+    if (num_processes <= 0) {
+        num_processes = MAX(1, sysconf(_SC_NPROCESSORS_ONLN));
+    }
+
+    enum sign_t sign = (get_sign(r1) == get_sign(r2)) ? POSITIVE : NEGATIVE;
+    ssize_t shift = get_min_word_idx(r1) + get_min_word_idx(r2);
+    struct Real* a = view_real(r1, get_min_word_idx(r1),
+                               get_max_word_idx(r1));
+    struct Real* b = view_real(r2, get_min_word_idx(r2),
+                               get_max_word_idx(r2));
+    shift_words(a, -get_min_word_idx(a));
+    shift_words(b, -get_min_word_idx(b));
+    set_sign(a, POSITIVE);
+    set_sign(b, POSITIVE);
+
+    // Each level triples the number of sub-products, so there are at
+    // least as many as workers.
+    int depth = 0;
+    int max_products = 1;
+    while (max_products < num_processes) {
+        depth++;
+        max_products *= 3;
+    }
+    struct SplitProducts split;
+    split.operands = malloc(2 * max_products * sizeof(struct Real*));
+    split.num_products = 0;
+    split.products = NULL;
+    split.next = 0;
+    split_karatsuba(a, b, depth, &split);
+    int num_products = split.num_products;
+
+    size_t num_words = 0;
+    int i, j;
+    for (i = 0; i < 2*num_products; i += 2) {
+        num_words += 2 * (get_max_word_idx(split.operands[i])
+                          + get_max_word_idx(split.operands[i + 1]));
+    }
+
+    struct SharedMemory shared;
+    split.products = malloc(num_products * sizeof(struct Real*));
+    if (create_shared_memory(&shared, num_products, num_words) != 0) {
+        // Just do it all here.
+        for (i = 0; i < num_products; i++) {
+            split.products[i] = multiply(split.operands[2*i],
+                                         split.operands[2*i + 1]);
+        }
+    } else {
+        size_t offset = 0;
+        struct SharedProduct* product;
+        for (i = 0; i < num_products; i++) {
+            product = &shared.products[i];
+            for (j = 0; j < 2; j++) {
+                product->offsets[j] = offset;
+                product->num_words[j] = get_max_word_idx(
+                    split.operands[2*i + j]);
+                store_words(shared.words + offset, split.operands[2*i + j],
+                            product->num_words[j]);
+                offset += product->num_words[j];
+            }
+            product->offsets[2] = offset;
+            product->num_words[2] = product->num_words[0]
+                + product->num_words[1];
+            offset += product->num_words[2];
+            product->done = 0;
+        }
+
+        // Worker `w` computes every `num_processes`-th sub-product,
+        // starting with the `w`th.
+        int num_workers = MIN(num_processes, num_products);
+        pid_t* pids = malloc(num_workers * sizeof(pid_t));
+        int w;
+        for (w = 0; w < num_workers; w++) {
+            pids[w] = fork();
+            if (pids[w] == 0) {
+                for (i = w; i < num_products; i += num_workers) {
+                    compute_shared_product(&shared, i);
+                }
+                _exit(0);
+            }
+        }
+        begin_stage("multiply", num_workers);
+        for (w = 0; w < num_workers; w++) {
+            if (pids[w] > 0) {
+                waitpid(pids[w], NULL, 0);
+            }
+            checkpoint(w + 1);
+        }
+        end_stage();
+        free(pids);
+
+        for (i = 0; i < num_products; i++) {
+            product = &shared.products[i];
+            if (!__atomic_load_n(&product->done, __ATOMIC_ACQUIRE)) {
+                compute_shared_product(&shared, i);
+            }
+            split.products[i] = load_words(shared.words + product->offsets[2],
+                                           product->num_words[2]);
+        }
+        munmap(shared.products, shared.size);
+    }
+
+    split.next = 0;
+    struct Real* p = split_karatsuba(a, b, depth, &split);
+    shift_words(p, shift);
+    set_sign(p, sign);
+
+    for (i = 0; i < 2*num_products; i++) {
+        free_real(split.operands[i]);
+    }
+    free(split.operands);
+    free(split.products);
+    free_real(a);
+    free_real(b);
+    return p;
+}
@@ -0,0 +1,30 @@
+#ifndef SHARED_MUL_H
+#define SHARED_MUL_H
+
+#include "real.h"
+
+// Multiplication of very large numbers split across worker processes.
+//
+// The top levels of the Karatsuba recursion are unrolled in this process
+// into a list of independent sub-products. Their operands are copied into
+// a POSIX shared memory object, and `num_processes` forked workers each
+// compute a share of the sub-products and write them back there. Each
+// worker is the first to touch the pages of its own products, so on a
+// NUMA machine they end up on the worker's node, and the workers can be
+// spread over the nodes by the scheduler or with `numactl`. This process
+// then combines the sub-products the way Karatsuba would.
+//
+// Any sub-product a worker fails to deliver (e.g. because it couldn't be
+// forked or it crashed) is computed in this process instead, so the
+// result is always the exact product, the same as `multiply` gives.
+//
+// Workers are forked from the calling process, so it shouldn't have
+// other threads in the middle of anything the workers need (stdio,
+// locks of its own, ...).
+
+// Returns r1 * r2 exactly, using up to `num_processes` worker processes
+// (or one per CPU if 0).
+struct Real* multiply_in_processes(struct Real* r1, struct Real* r2,
+                                   int num_processes);
+
+#endif
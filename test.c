@@ -2,6 +2,9 @@
 
 #include <stdio.h>
 
+#include "real.h"
+#include "arithmetic.h"
+
 extern test_func_t tests[];
 extern char* test_names[];
 
@@ -30,6 +33,40 @@ void run_tests(test_func_t* tests, char** test_names) {
     printf("-----------------------------------------\n");
 }
 
+int close_enough(struct Real* r1, struct Real* r2, ssize_t min_sig_word_idx) {
+    struct Real* diff = subtract(r1, r2);
+    trim_most_significant_zeros(diff);
+    int rtn = (is_zero(diff) ||
+               get_max_word_idx(diff) <= min_sig_word_idx + 1);
+    free_real(diff);
+    return rtn;
+}
+
+int same(struct Real* r1, struct Real* r2) {
+    trim_zeros(r1);
+    trim_zeros(r2);
+    if (is_zero(r1)) {
+        set_sign(r1, POSITIVE);
+    }
+    if (is_zero(r2)) {
+        set_sign(r2, POSITIVE);
+    }
+    int rtn = check_equal(r1, r2);
+    free_real(r1);
+    return rtn;
+}
+
+struct Real* pattern_real(enum sign_t sign, ssize_t min_word_idx,
+                          ssize_t max_word_idx, word seed) {
+    struct Real* r = alloc_real(sign, min_word_idx, max_word_idx);
+    ssize_t word_idx;
+    for (word_idx = min_word_idx; word_idx < max_word_idx; word_idx++) {
+        seed = seed*6364136223846793005ul + 1442695040888963407ul;
+        set_word(r, word_idx, (seed >> 62) ? ~((word) 0) : seed);
+    }
+    return r;
+}
+
 int main(void) {
     run_tests(tests, test_names);
 
@@ -1,6 +1,8 @@
 #ifndef TEST_H
 #define TEST_H
 
+#include "real.h"
+
 #define FAIL(msg) printf("%s failed: %s\n", __func__, msg); \
     rtn = -1;
 
@@ -12,4 +14,17 @@ typedef int (*test_func_t)(void);
 // length.
 void run_tests(test_func_t* tests, char** test_names);
 
+// Returns 1 if |r1 - r2| < 2^(64 * (min_sig_word_idx + 1)).
+int close_enough(struct Real* r1, struct Real* r2, ssize_t min_sig_word_idx);
+
+// Returns 1 if `r1` and `r2` are the same number, whatever zero words
+// they have and whatever the sign of 0, and frees `r1`, which is meant
+// to be the freshly made number under test.
+int same(struct Real* r1, struct Real* r2);
+
+// Returns a number with a mix of all-1 and arbitrary words, so that
+// carries run a long way. The words are the same for the same `seed`.
+struct Real* pattern_real(enum sign_t sign, ssize_t min_word_idx,
+                          ssize_t max_word_idx, word seed);
+
 #endif
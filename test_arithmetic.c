@@ -5,6 +5,7 @@
 
 #include "arithmetic.h"
 #include "decimal.h"
+#include "thresholds.h"
 #include "test.h"
 
 
@@ -52,6 +53,354 @@ int test_add() {
     return rtn;
 }
 
+int test_add_to() {
+    int rtn = 0;
+
+    // 0x1.8 + 0x1.8 = 0x3, with a carry out of the top word.
+    struct Real* acc = fill_real(POSITIVE, -1, 1,
+                                 (word) 0x1 << (WORD_BITS - 1),
+                                 (word) -1);
+    struct Real* r = fill_real(POSITIVE, -1, 1,
+                               (word) 0x1 << (WORD_BITS - 1), 1);
+    struct Real* correct = fill_real(POSITIVE, -1, 2, 0, 1, 1);
+    add_to(acc, r);
+    if (check_equal(acc, correct) != 1) {
+        FAIL("add_to with carry");
+    }
+    free_real(correct);
+
+    // Subtracting the bigger value flips the sign.
+    struct Real* big = fill_real(POSITIVE, -2, 2, 5, 0, 0, 2);
+    subtract_from(acc, big);
+    correct = fill_real(NEGATIVE, -2, 2, 5, 0, (word) -1, 0);
+    trim_most_significant_zeros(correct);
+    if (check_equal(acc, correct) != 1) {
+        FAIL("subtract_from a bigger value");
+    }
+    free_real(correct);
+
+    // Adding a positive to a negative.
+    add_to(acc, big);
+    correct = fill_real(POSITIVE, -1, 2, 0, 1, 1);
+    if (check_equal(acc, correct) != 1) {
+        FAIL("add_to with opposite signs");
+    }
+
+    // Aliased operands.
+    add_to(acc, acc);
+    struct Real* twice = add(correct, correct);
+    if (check_equal(acc, twice) != 1) {
+        FAIL("add_to itself");
+    }
+    subtract_from(acc, acc);
+    if (is_zero(acc) != 1) {
+        FAIL("subtract_from itself");
+    }
+
+    free_real(twice);
+    free_real(correct);
+    free_real(big);
+    free_real(r);
+    free_real(acc);
+
+    return rtn;
+}
+
+int test_fma() {
+    int rtn = 0;
+
+    struct Real* a = fill_real(POSITIVE, -2, 1,
+                               0x0123456789abcdef, 0xfedcba9876543210, 3);
+    struct Real* b = fill_real(NEGATIVE, -1, 1,
+                               0x8badf00ddeadbeef, 1);
+    struct Real* small = fill_real(POSITIVE, -3, 0, 5, 6, 7);
+    struct Real* big = fill_real(POSITIVE, -1, 3, 1, 2, 3, 4);
+    struct Real* accs[2] = {small, big};
+
+    // Compare against separate multiplies and adds for all combinations
+    // of signs, including results that change the sign of `acc`.
+    struct Real* acc;
+    struct Real* prod;
+    struct Real* correct;
+    int i, neg_acc, neg_b, sub;
+    for (i = 0; i < 2; i++) {
+        for (neg_acc = 0; neg_acc < 2; neg_acc++) {
+            for (neg_b = 0; neg_b < 2; neg_b++) {
+                for (sub = 0; sub < 2; sub++) {
+                    acc = copy_real(accs[i]);
+                    if (neg_acc) {
+                        negate(acc);
+                    }
+                    if (neg_b) {
+                        negate(b);
+                    }
+
+                    prod = mul_with_sig(a, b, -2);
+                    if (sub) {
+                        correct = subtract(acc, prod);
+                        fms_with_sig(acc, a, b, -2);
+                    } else {
+                        correct = add(acc, prod);
+                        fma_with_sig(acc, a, b, -2);
+                    }
+                    if (check_equal(acc, correct) != 1) {
+                        FAIL(sub ? "fms_with_sig" : "fma_with_sig");
+                        print_real(acc);
+                        print_real(correct);
+                    }
+
+                    if (neg_b) {
+                        negate(b);
+                    }
+                    free_real(acc);
+                    free_real(prod);
+                    free_real(correct);
+                }
+            }
+        }
+    }
+
+    // acc -= acc * acc
+    acc = copy_real(a);
+    prod = mul_with_sig(a, a, -3);
+    correct = subtract(a, prod);
+    fms_with_sig(acc, acc, acc, -3);
+    if (check_equal(acc, correct) != 1) {
+        FAIL("fms_with_sig with aliased operands");
+    }
+    free_real(acc);
+    free_real(prod);
+    free_real(correct);
+
+    // Operands long enough for Karatsuba, with and without aliasing.
+    ssize_t old_threshold = thresholds.karatsuba_min_words;
+    thresholds.karatsuba_min_words = 4;
+    struct Real* long_a = pattern_real(POSITIVE, -30, 10, 1);
+    struct Real* long_b = pattern_real(NEGATIVE, -20, 15, 2);
+    for (sub = 0; sub < 2; sub++) {
+        acc = pattern_real(POSITIVE, -40, 20, 3);
+        prod = mul_with_sig(long_a, long_b, -25);
+        if (sub) {
+            correct = subtract(acc, prod);
+            fms_with_sig(acc, long_a, long_b, -25);
+        } else {
+            correct = add(acc, prod);
+            fma_with_sig(acc, long_a, long_b, -25);
+        }
+        if (check_equal(acc, correct) != 1) {
+            FAIL(sub ? "long fms_with_sig" : "long fma_with_sig");
+        }
+        free_real(prod);
+        free_real(correct);
+
+        prod = mul_with_sig(acc, long_a, -25);
+        correct = sub ? subtract(acc, prod) : add(acc, prod);
+        if (sub) {
+            fms_with_sig(acc, acc, long_a, -25);
+        } else {
+            fma_with_sig(acc, acc, long_a, -25);
+        }
+        if (check_equal(acc, correct) != 1) {
+            FAIL("long aliased operands");
+        }
+        free_real(acc);
+        free_real(prod);
+        free_real(correct);
+    }
+    thresholds.karatsuba_min_words = old_threshold;
+    free_real(long_a);
+    free_real(long_b);
+
+    // acc += alpha * x
+    word alpha = 0xfedcba9876543210;
+    struct Real* alpha_real = fill_real(POSITIVE, 0, 1, alpha);
+    acc = copy_real(small);
+    prod = multiply(b, alpha_real);
+    correct = add(small, prod);
+    axpy(acc, alpha, b);
+    if (check_equal(acc, correct) != 1) {
+        FAIL("axpy");
+    }
+    free_real(prod);
+    free_real(correct);
+
+    prod = multiply(acc, alpha_real);
+    correct = add(acc, prod);
+    axpy(acc, alpha, acc);
+    if (check_equal(acc, correct) != 1) {
+        FAIL("axpy with aliased operands");
+    }
+    free_real(prod);
+    free_real(correct);
+    free_real(acc);
+    free_real(alpha_real);
+
+    free_real(a);
+    free_real(b);
+    free_real(small);
+    free_real(big);
+
+    return rtn;
+}
+
+int test_shift() {
+    int rtn = 0;
+
+    struct Real* r = fill_real(NEGATIVE, -1, 1,
+                               0x8000000000000001, 0xc000000000000003);
+    struct Real* correct = fill_real(NEGATIVE, -1, 2,
+                                     0x0000000000000010, 0x0000000000000038,
+                                     0xc);
+    struct Real* s = shift_left_bits(r, 4);
+    if (check_equal(s, correct) != 1) {
+        FAIL("shift_left_bits by 4");
+    }
+    free_real(s);
+    free_real(correct);
+
+    // Shifting right by 1 and 67 bits.
+    correct = fill_real(NEGATIVE, -2, 1,
+                        0x8000000000000000, 0xc000000000000000,
+                        0x6000000000000001);
+    s = shift_right_bits(r, 1);
+    if (check_equal(s, correct) != 1) {
+        FAIL("shift_right_bits by 1");
+    }
+    free_real(s);
+    free_real(correct);
+
+    struct Real* eighth = shift_right_bits(r, 3);
+    s = shift_right_bits(eighth, 64);
+    struct Real* t = shift_right_bits(r, 67);
+    if (check_equal(s, t) != 1) {
+        FAIL("shift_right_bits by 67");
+    }
+    free_real(eighth);
+    free_real(s);
+    free_real(t);
+
+    // Shifts by whole words.
+    s = shift_left_bits(r, -128);
+    shift_words(s, 2);
+    if (check_equal(s, r) != 1) {
+        FAIL("shift by whole words");
+    }
+    free_real(s);
+
+    // Round trips are exact.
+    s = shift_left_bits(r, 37);
+    t = shift_right_bits(s, 37);
+    if (check_equal(t, r) != 1) {
+        FAIL("shift round trip");
+    }
+    free_real(s);
+    free_real(t);
+    free_real(r);
+
+    return rtn;
+}
+
+int test_parallel_add() {
+    int rtn = 0;
+
+    struct Real* pairs[][2] = {
+        {pattern_real(POSITIVE, -20, 30, 1), pattern_real(POSITIVE, -25, 17, 2)},
+        {pattern_real(POSITIVE, -20, 30, 3), pattern_real(NEGATIVE, -20, 30, 4)},
+        {fill_real(POSITIVE, 0, 1, 1), pattern_real(POSITIVE, 0, 40, 0)},
+        {NULL, NULL}};
+    // All 1s plus 1 carries through every block.
+    ssize_t word_idx;
+    for (word_idx = 0; word_idx < 40; word_idx++) {
+        set_word(pairs[2][1], word_idx, ~((word) 0));
+    }
+
+    struct Thresholds old_thresholds = thresholds;
+    int old_threads = parallel_add_threads;
+    thresholds.parallel_add_min_words = 4;
+
+    int i;
+    struct Real* results[2][4];
+    for (i = 0; pairs[i][0] != NULL; i++) {
+        int parallel;
+        for (parallel = 0; parallel < 2; parallel++) {
+            parallel_add_threads = parallel ? 7 : 1;
+            results[parallel][0] = add(pairs[i][0], pairs[i][1]);
+            results[parallel][1] = subtract(pairs[i][1], pairs[i][0]);
+            results[parallel][2] = copy_real(pairs[i][0]);
+            add_to(results[parallel][2], pairs[i][1]);
+            results[parallel][3] = copy_real(pairs[i][1]);
+            subtract_from(results[parallel][3], pairs[i][0]);
+        }
+        int j;
+        for (j = 0; j < 4; j++) {
+            if (check_equal(results[0][j], results[1][j]) != 1) {
+                FAIL("parallel and serial results differ");
+                printf("pair %d, operation %d\n", i, j);
+            }
+            free_real(results[0][j]);
+            free_real(results[1][j]);
+        }
+        free_real(pairs[i][0]);
+        free_real(pairs[i][1]);
+    }
+
+    thresholds = old_thresholds;
+    parallel_add_threads = old_threads;
+
+    return rtn;
+}
+
+int test_karatsuba() {
+    int rtn = 0;
+
+    struct Thresholds old_thresholds = thresholds;
+
+    struct Real* pairs[][2] = {
+        {pattern_real(POSITIVE, 0, 40, 5), pattern_real(POSITIVE, 0, 40, 6)},
+        {pattern_real(NEGATIVE, -13, 20, 7), pattern_real(POSITIVE, -3, 50, 8)},
+        {pattern_real(POSITIVE, -30, 3, 9), pattern_real(NEGATIVE, -9, 0, 10)},
+        {NULL, NULL}};
+    ssize_t sigs[] = {0, -5, -40};
+
+    int i;
+    struct Real* schoolbook;
+    struct Real* split;
+    for (i = 0; pairs[i][0] != NULL; i++) {
+        // Full products should match exactly.
+        thresholds.karatsuba_min_words = 1000;
+        schoolbook = multiply(pairs[i][0], pairs[i][1]);
+        thresholds.karatsuba_min_words = 2;
+        split = multiply(pairs[i][0], pairs[i][1]);
+        trim_zeros(schoolbook);
+        trim_zeros(split);
+        if (check_equal(schoolbook, split) != 1) {
+            FAIL("karatsuba multiply");
+            printf("pair %d\n", i);
+        }
+        free_real(schoolbook);
+        free_real(split);
+
+        // Truncated ones are at least as accurate.
+        thresholds.karatsuba_min_words = 1000;
+        schoolbook = mul_with_sig(pairs[i][0], pairs[i][1], sigs[i]);
+        thresholds.karatsuba_min_words = 2;
+        split = mul_with_sig(pairs[i][0], pairs[i][1], sigs[i]);
+        if (close_enough(schoolbook, split, sigs[i] + 1) != 1) {
+            FAIL("karatsuba mul_with_sig");
+            printf("pair %d\n", i);
+        }
+        free_real(schoolbook);
+        free_real(split);
+
+        free_real(pairs[i][0]);
+        free_real(pairs[i][1]);
+    }
+
+    thresholds = old_thresholds;
+
+    return rtn;
+}
+
 int test_mul() {
     int rtn = 0;
 
@@ -123,12 +472,222 @@ int test_div() {
     }
     free_real(quotient);
 
+    quotient = copy_real(a);
+    divide_by_word(quotient, divisor, -2);
+    if (check_equal(b, quotient) != 1) {
+        FAIL("divide_by_word");
+    }
+    divide_by_word(quotient, divisor, 2);
+    if (is_zero(quotient) != 1) {
+        FAIL("divide_by_word to 0");
+    }
+    free_real(quotient);
+
+    free_real(a);
+    free_real(b);
+
+    return rtn;
+}
+
+int test_div_real() {
+    int rtn = 0;
+
+    struct Real* a = fill_real(POSITIVE, 0, 1, 10);
+    struct Real* b = fill_real(NEGATIVE, 0, 1, 7);
+    struct Real* correct = fill_real(NEGATIVE, -4, 1,
+                                     0x6db6db6db6db6db6, 0xb6db6db6db6db6db,
+                                     0xdb6db6db6db6db6d, 0x6db6db6db6db6db6,
+                                     1);
+    struct Real* quotient = div_real_with_sig(a, b, -4);
+    if (close_enough(quotient, correct, -4) != 1) {
+        FAIL("div_real_with_sig");
+    }
+    free_real(quotient);
+    free_real(correct);
+
+    // Dividing by a fraction.
+    set_sign(b, POSITIVE);
+    set_min_word_idx(b, -1);
+    set_max_word_idx(b, 0);
+    quotient = div_real_with_sig(b, b, -40);
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    if (close_enough(quotient, one, -40) != 1) {
+        FAIL("div_real_with_sig: r / r = 1");
+    }
+    free_real(quotient);
+    free_real(one);
+
+    struct Real* zero = fill_real(POSITIVE, 0, 1, 0);
+    if (div_real_with_sig(a, zero, -4) != NULL) {
+        FAIL("div_real_with_sig: division by 0 should be NULL");
+    }
+    free_real(zero);
     free_real(a);
     free_real(b);
 
     return rtn;
 }
 
+int test_long_div() {
+    int rtn = 0;
+
+    struct Thresholds old_thresholds = thresholds;
+
+    struct Real* pairs[][2] = {
+        {pattern_real(POSITIVE, -5, 30, 11), pattern_real(POSITIVE, -2, 9, 12)},
+        {pattern_real(NEGATIVE, 0, 10, 13), pattern_real(POSITIVE, -20, 1, 14)},
+        {pattern_real(POSITIVE, 0, 3, 15), fill_real(NEGATIVE, 0, 1, 7)},
+        {NULL, NULL}};
+
+    int i;
+    struct Real* newton;
+    struct Real* quotient;
+    for (i = 0; pairs[i][0] != NULL; i++) {
+        thresholds.newton_div_min_words = 1;
+        newton = div_real_with_sig(pairs[i][0], pairs[i][1], -30);
+        thresholds.newton_div_min_words = 1000;
+        quotient = div_real_with_sig(pairs[i][0], pairs[i][1], -30);
+        if (close_enough(newton, quotient, -30) != 1) {
+            FAIL("long division");
+            printf("pair %d\n", i);
+        }
+        free_real(newton);
+        free_real(quotient);
+        free_real(pairs[i][0]);
+        free_real(pairs[i][1]);
+    }
+
+    // Long division truncates exactly: 10^40 / 7 = 0x432bcd...924924.
+    struct Real* n = fill_real(POSITIVE, 0, 3, 0xb9f5610000000000,
+                               0x6329f1c35ca4bfab, 0x1d);
+    struct Real* d = fill_real(POSITIVE, 0, 1, 7);
+    struct Real* correct = fill_real(POSITIVE, 0, 3, 0xacd9e94924924924,
+                                     0x32bcd9650d3c1b61, 0x4);
+    quotient = div_real_with_sig(n, d, 0);
+    if (check_equal(quotient, correct) != 1) {
+        FAIL("10^40 / 7");
+        print_real(quotient);
+    }
+    free_real(quotient);
+    free_real(correct);
+    free_real(d);
+    free_real(n);
+
+    thresholds = old_thresholds;
+
+    return rtn;
+}
+
+int test_sqrt() {
+    int rtn = 0;
+
+    struct Real* a = fill_real(POSITIVE, 0, 1, 2);
+    struct Real* correct = fill_real(POSITIVE, -4, 1,
+                                     0xda2f590b0667322a, 0x3adec17512775099,
+                                     0xb2fb1366ea957d3e, 0x6a09e667f3bcc908,
+                                     1);
+    struct Real* root = sqrt_with_sig(a, -4);
+    if (close_enough(root, correct, -4) != 1) {
+        FAIL("sqrt_with_sig(2)");
+    }
+    free_real(a);
+    free_real(root);
+    free_real(correct);
+
+    // 12345678901234567890123
+    a = fill_real(POSITIVE, 0, 2, 0x42b64e76714244cb, 0x29d);
+    correct = fill_real(POSITIVE, -4, 1,
+                        0x4e2ba88dfadaaf7a, 0x79aa48c7d67255c1,
+                        0x7626b553764347fa, 0x1c71b365d959667c,
+                        0x00000019debcffd3);
+    root = sqrt_with_sig(a, -4);
+    if (close_enough(root, correct, -4) != 1) {
+        FAIL("sqrt_with_sig of a 2-word integer");
+    }
+    free_real(a);
+    free_real(root);
+    free_real(correct);
+
+    a = fill_real(NEGATIVE, 0, 1, 2);
+    if (sqrt_with_sig(a, -4) != NULL) {
+        FAIL("sqrt_with_sig of a negative should be NULL");
+    }
+    free_real(a);
+
+    return rtn;
+}
+
+int test_pow() {
+    int rtn = 0;
+
+    // 3^40 = 12157665459056928801 still fits in a word.
+    struct Real* p = pow_word(3, 40);
+    struct Real* correct = fill_real(POSITIVE, 0, 1, 12157665459056928801ul);
+    if (check_equal(p, correct) != 1) {
+        FAIL("pow_word(3, 40)");
+    }
+    free_real(p);
+    free_real(correct);
+
+    // Compare 7^300 against repeated multiplication.
+    correct = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* seven = fill_real(POSITIVE, 0, 1, 7);
+    struct Real* temp;
+    int i;
+    for (i = 0; i < 300; i++) {
+        temp = multiply(correct, seven);
+        free_real(correct);
+        correct = temp;
+    }
+    trim_zeros(correct);
+    p = pow_word(7, 300);
+    if (check_equal(p, correct) != 1) {
+        FAIL("pow_word(7, 300)");
+    }
+    free_real(p);
+    free_real(seven);
+
+    // (7/2^64)^300 = 7^300 / 2^(64 * 300).
+    seven = fill_real(POSITIVE, -1, 0, 7);
+    shift_words(correct, -300);
+    p = pow_real(seven, 300, -302);
+    if (p == NULL || close_enough(p, correct, -302) != 1) {
+        FAIL("pow_real(7/2^64, 300)");
+    }
+    free_real(p);
+    free_real(seven);
+    free_real(correct);
+
+    // sqrt(2)^10 = 32.
+    struct Real* two = fill_real(POSITIVE, 0, 1, 2);
+    struct Real* root = sqrt_with_sig(two, -6);
+    correct = fill_real(POSITIVE, 0, 1, 32);
+    p = pow_real(root, 10, -4);
+    if (p == NULL || close_enough(p, correct, -4) != 1) {
+        FAIL("pow_real(sqrt(2), 10)");
+    }
+    free_real(p);
+    free_real(correct);
+
+    // Anything to the 0 is 1.
+    correct = fill_real(POSITIVE, 0, 1, 1);
+    p = pow_real(root, 0, -4);
+    if (p == NULL || check_equal(p, correct) != 1) {
+        FAIL("pow_real(sqrt(2), 0)");
+    }
+    free_real(p);
+    p = pow_word(0, 0);
+    if (check_equal(p, correct) != 1) {
+        FAIL("pow_word(0, 0)");
+    }
+    free_real(p);
+    free_real(correct);
+    free_real(root);
+    free_real(two);
+
+    return rtn;
+}
+
 int dec_test() {
     struct Real* a = fill_real(POSITIVE, -1, 1,
                                0x243f6a8885a30000, 3);
@@ -147,12 +706,30 @@ int dec_test() {
 
 test_func_t tests[] = {
     test_add,
+    test_add_to,
+    test_parallel_add,
+    test_fma,
+    test_shift,
     test_mul,
+    test_karatsuba,
     test_div,
+    test_div_real,
+    test_long_div,
+    test_sqrt,
+    test_pow,
     NULL};
 
 char* test_names[] = {
     "add",
+    "add_to",
+    "parallel_add",
+    "fma",
+    "shift",
     "mul",
+    "karatsuba",
     "div",
+    "div_real",
+    "long_div",
+    "sqrt",
+    "pow",
     NULL};
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "batch.h"
+#include "test.h"
+
+
+// More than one block, and not a whole number of them.
+#define COUNT 600
+
+int check_batch_ops(ssize_t min_word_idx, ssize_t max_word_idx) {
+    // Returns 0 if the batch operations agree with struct Real ones for
+    // numbers in [`min_word_idx`, `max_word_idx`).
+    int rtn = 0;
+
+    // The operands' integer parts are at most half as long as the
+    // batches', so the results fit.
+    struct Real* a[COUNT];
+    struct Real* b[COUNT];
+    struct RealBatch* batch_a = alloc_batch(COUNT, min_word_idx,
+                                            max_word_idx);
+    struct RealBatch* batch_b = alloc_batch(COUNT, min_word_idx,
+                                            max_word_idx);
+    struct RealBatch* result = alloc_batch(COUNT, min_word_idx,
+                                           max_word_idx);
+    ssize_t operand_max_word_idx = (max_word_idx > 0)
+        ? (max_word_idx + 1) / 2 : max_word_idx;
+    int i;
+    for (i = 0; i < COUNT; i++) {
+        a[i] = pattern_real((i % 3) ? POSITIVE : NEGATIVE, min_word_idx,
+                            operand_max_word_idx, i);
+        b[i] = pattern_real((i % 5) ? NEGATIVE : POSITIVE, min_word_idx,
+                            operand_max_word_idx, i + COUNT);
+        // With small top words, sums and products of 2 of these fit in
+        // the range.
+        set_word(a[i], operand_max_word_idx - 1,
+                 get_word(a[i], operand_max_word_idx - 1) & 0xff);
+        set_word(b[i], operand_max_word_idx - 1,
+                 get_word(b[i], operand_max_word_idx - 1) & 0xff);
+        if (i % 7 == 0) {
+            free_real(b[i]);
+            b[i] = copy_real(a[i]);
+        }
+        if (set_batch_real(batch_a, i, a[i]) != 0 ||
+            set_batch_real(batch_b, i, b[i]) != 0) {
+            FAIL("set_batch_real");
+        }
+    }
+
+    int* results = malloc(COUNT * sizeof(int));
+    struct Real* correct;
+    batch_add(result, batch_a, batch_b);
+    for (i = 0; i < COUNT; i++) {
+        correct = add(a[i], b[i]);
+        if (same(get_batch_real(result, i), correct) != 1) {
+            FAIL("batch_add");
+        }
+        free_real(correct);
+    }
+    batch_subtract(result, batch_a, batch_b);
+    for (i = 0; i < COUNT; i++) {
+        correct = subtract(a[i], b[i]);
+        if (same(get_batch_real(result, i), correct) != 1) {
+            FAIL("batch_subtract");
+        }
+        free_real(correct);
+    }
+    batch_mul_word(result, batch_a, 1000003);
+    struct Real* w = fill_real(POSITIVE, 0, 1, 1000003);
+    for (i = 0; i < COUNT; i++) {
+        correct = multiply(a[i], w);
+        if (same(get_batch_real(result, i), correct) != 1) {
+            FAIL("batch_mul_word");
+        }
+        free_real(correct);
+    }
+    free_real(w);
+    batch_multiply(result, batch_a, batch_b);
+    for (i = 0; i < COUNT; i++) {
+        correct = multiply(a[i], b[i]);
+        truncate_real(correct, min_word_idx);
+        if (same(get_batch_real(result, i), correct) != 1) {
+            FAIL("batch_multiply");
+        }
+        free_real(correct);
+    }
+    batch_compare(results, batch_a, batch_b);
+    for (i = 0; i < COUNT; i++) {
+        correct = subtract(a[i], b[i]);
+        if (results[i] != (is_zero(correct) ? 0
+                           : (get_sign(correct) == POSITIVE) ? 1 : -1)) {
+            FAIL("batch_compare");
+        }
+        free_real(correct);
+    }
+
+    // The result can be an operand.
+    batch_multiply(batch_a, batch_a, batch_a);
+    for (i = 0; i < COUNT; i++) {
+        correct = multiply(a[i], a[i]);
+        truncate_real(correct, min_word_idx);
+        if (same(get_batch_real(batch_a, i), correct) != 1) {
+            FAIL("batch_multiply in place");
+        }
+        free_real(correct);
+    }
+
+    for (i = 0; i < COUNT; i++) {
+        free_real(a[i]);
+        free_real(b[i]);
+    }
+    free(results);
+    free_batch(batch_a);
+    free_batch(batch_b);
+    free_batch(result);
+    return rtn;
+}
+
+int test_batch_ops() {
+    int rtn = 0;
+
+    // Fractions, integers, and everything in between.
+    if (check_batch_ops(-4, 1) != 0 ||
+        check_batch_ops(-2, 2) != 0 ||
+        check_batch_ops(0, 4) != 0 ||
+        check_batch_ops(-8, -4) != 0 ||
+        check_batch_ops(1, 3) != 0) {
+        FAIL("batch ops");
+    }
+
+    return rtn;
+}
+
+int test_errors() {
+    int rtn = 0;
+
+    struct RealBatch* b = alloc_batch(10, -1, 1);
+    struct RealBatch* c = alloc_batch(10, -2, 1);
+    // Too big, and too big to leave room for the sign.
+    struct Real* big = fill_real(POSITIVE, 1, 2, 1);
+    struct Real* top = fill_real(NEGATIVE, 0, 1, (word) 1 << 63);
+    struct Real* r = fill_real(NEGATIVE, -1, 1, 1, 2);
+    if (set_batch_real(b, 0, big) != -1 ||
+        set_batch_real(b, 0, top) != -1 ||
+        set_batch_real(b, 10, r) != -1) {
+        FAIL("numbers that don't fit");
+    }
+    struct Real* zero = fill_real(POSITIVE, 0, 1, 0);
+    if (set_batch_real(b, 3, r) != 0 ||
+        same(get_batch_real(b, 3), r) != 1 ||
+        same(get_batch_real(b, 0), zero) != 1) {
+        FAIL("set_batch_real");
+    }
+    if (batch_add(b, b, c) != -1 || batch_compare(NULL, b, c) != -1) {
+        FAIL("batches that don't match");
+    }
+
+    free_real(zero);
+    free_real(big);
+    free_real(top);
+    free_real(r);
+    free_batch(b);
+    free_batch(c);
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_batch_ops,
+    test_errors,
+    NULL};
+char* test_names[] = {
+    "batch_ops",
+    "errors",
+    NULL};
@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "real.h"
+#include "bbp.h"
+#include "test.h"
+
+
+int test_pi_hex_word() {
+    int rtn = 0;
+
+    // The first words of pi's fraction.
+    word correct[] = {0x243f6a8885a308d3, 0x13198a2e03707344,
+                      0xa4093822299f31d0, 0x082efa98ec4e6c89,
+                      0x452821e638d01377, 0xbe5466cf34e90c6c};
+    int i;
+    for (i = 0; i < 6; i++) {
+        if (pi_hex_word(16*i) != correct[i]) {
+            FAIL("pi_hex_word");
+            printf("position %d: %016lx\n", 16*i, pi_hex_word(16*i));
+        }
+    }
+
+    // Positions needn't line up with words.
+    if (pi_hex_word(5) != 0xa8885a308d313198) {
+        FAIL("pi_hex_word(5)");
+    }
+
+    return rtn;
+}
+
+int test_pi_hex_digits() {
+    int rtn = 0;
+
+    char digits[64];
+    char* correct = "5a308d313198a2e03707344a4093822299f31d0082efa98ec4e6c89";
+    pi_hex_digits(9, strlen(correct), 3, digits);
+    if (strcmp(digits, correct) != 0) {
+        FAIL("pi_hex_digits");
+        printf("correct: %s\n", correct);
+        printf("ours:    %s\n", digits);
+    }
+
+    // The well-known digits starting at the millionth.
+    pi_hex_digits(999999, 14, 2, digits);
+    if (strcmp(digits, "26c65e52cb4593") != 0) {
+        FAIL("pi_hex_digits at 10^6");
+        printf("ours: %s\n", digits);
+    }
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_pi_hex_word,
+    test_pi_hex_digits,
+    NULL};
+char* test_names[] = {
+    "pi_hex_word",
+    "pi_hex_digits",
+    NULL};
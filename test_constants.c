@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "constants.h"
+#include "test.h"
+
+
+struct Real* correct_pi() {
+    return fill_real(POSITIVE, -6, 1,
+                     0xbe5466cf34e90c6c, 0x452821e638d01377,
+                     0x082efa98ec4e6c89, 0xa4093822299f31d0,
+                     0x13198a2e03707344, 0x243f6a8885a308d3,
+                     3);
+}
+
+struct Real* correct_e() {
+    return fill_real(POSITIVE, -6, 1,
+                     0xf4bf8d8d8c31d763, 0x324e7738926cfbe5,
+                     0xa784d9045190cfef, 0x62e7160f38b4da56,
+                     0xbf7158809cf4f3c7, 0xb7e151628aed2a6a,
+                     2);
+}
+
+int test_get_constant() {
+    int rtn = 0;
+
+    clear_constant_cache();
+
+    struct Real* correct = correct_pi();
+    struct Real* r = get_constant(CONSTANT_PI, -3);
+    if (close_enough(r, correct, -3) != 1) {
+        FAIL("pi at -3");
+    }
+    free_real(r);
+    if (get_constant_precision(CONSTANT_PI) != -3) {
+        FAIL("pi should be stored at -3");
+    }
+
+    // This should be answered by truncation.
+    r = get_constant(CONSTANT_PI, -2);
+    if (get_min_word_idx(r) < -2 || close_enough(r, correct, -2) != 1) {
+        FAIL("pi at -2");
+    }
+    free_real(r);
+    if (get_constant_precision(CONSTANT_PI) != -3) {
+        FAIL("pi shouldn't be recomputed for less precision");
+    }
+
+    // This should extend the stored value to at least twice the words.
+    r = get_constant(CONSTANT_PI, -4);
+    if (close_enough(r, correct, -4) != 1) {
+        FAIL("pi at -4");
+    }
+    free_real(r);
+    if (get_constant_precision(CONSTANT_PI) != -6) {
+        FAIL("pi should be stored at -6");
+    }
+    free_real(correct);
+
+    correct = correct_e();
+    r = get_constant(CONSTANT_E, -6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("e at -6");
+        print_real(r);
+    }
+    free_real(r);
+    free_real(correct);
+
+    correct = fill_real(POSITIVE, -6, 0,
+                        0x559552fb4afa1b10, 0xe7b876206debac98,
+                        0x8a0d175b8baafa2b, 0x40f343267298b62d,
+                        0xc9e3b39803f2f6af, 0xb17217f7d1cf79ab);
+    r = get_constant(CONSTANT_LN2, -6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("ln2 at -6");
+    }
+    free_real(r);
+    free_real(correct);
+
+    clear_constant_cache();
+
+    return rtn;
+}
+
+int test_save_load() {
+    int rtn = 0;
+
+    char path[] = "/tmp/test_constants_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        FAIL("mkstemp");
+        return rtn;
+    }
+    close(fd);
+
+    clear_constant_cache();
+    struct Real* r = get_constant(CONSTANT_PI, -6);
+    free_real(r);
+    if (save_constant_cache(path) != 0) {
+        FAIL("save_constant_cache");
+    }
+
+    clear_constant_cache();
+    if (load_constant_cache(path) != 0) {
+        FAIL("load_constant_cache");
+    }
+    if (get_constant_precision(CONSTANT_PI) != -6) {
+        FAIL("pi should be loaded at -6");
+    }
+    if (get_constant_precision(CONSTANT_E) != 1) {
+        FAIL("e shouldn't be loaded");
+    }
+
+    struct Real* correct = correct_pi();
+    r = get_constant(CONSTANT_PI, -6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("loaded pi");
+    }
+    free_real(r);
+    free_real(correct);
+
+    // Loading a less precise value shouldn't replace a more precise one.
+    clear_constant_cache();
+    r = get_constant(CONSTANT_PI, -8);
+    free_real(r);
+    if (load_constant_cache(path) != 0) {
+        FAIL("load_constant_cache");
+    }
+    if (get_constant_precision(CONSTANT_PI) != -8) {
+        FAIL("pi should still be stored at -8");
+    }
+
+    if (load_constant_cache("/nonexistent/constants") != -1) {
+        FAIL("loading a missing file should fail");
+    }
+
+    clear_constant_cache();
+    unlink(path);
+
+    return rtn;
+}
+
+void* get_pi_thread(void* arg) {
+    ssize_t min_sig_word_idx = *(ssize_t*) arg;
+    return get_constant(CONSTANT_PI, min_sig_word_idx);
+}
+
+int test_threads() {
+    int rtn = 0;
+
+    clear_constant_cache();
+
+    pthread_t threads[4];
+    ssize_t sigs[4] = {-2, -6, -4, -5};
+    struct Real* results[4];
+    int i;
+    for (i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, get_pi_thread, &sigs[i]);
+    }
+    for (i = 0; i < 4; i++) {
+        pthread_join(threads[i], (void**) &results[i]);
+    }
+
+    struct Real* correct = correct_pi();
+    for (i = 0; i < 4; i++) {
+        if (close_enough(results[i], correct, sigs[i]) != 1) {
+            FAIL("pi from a thread");
+        }
+        free_real(results[i]);
+    }
+    free_real(correct);
+
+    clear_constant_cache();
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_get_constant,
+    test_save_load,
+    test_threads,
+    NULL};
+char* test_names[] = {
+    "get_constant",
+    "save_load",
+    "threads",
+    NULL};
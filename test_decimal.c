@@ -3,7 +3,10 @@
 #include <string.h>
 
 #include "real.h"
+#include "arithmetic.h"
 #include "decimal.h"
+#include "progress.h"
+#include "thresholds.h"
 #include "test.h"
 
 
@@ -55,10 +58,198 @@ int test_real_to_decimal() {
     return rtn;
 }
 
+int test_powers_of_ten() {
+    int rtn = 0;
+
+    // 10^1000 is a 1 followed by 1000 0s.
+    struct Real* r = pow_word(10, 1000);
+    char* dec_str = real_to_decimal_str(r);
+    int i;
+    int correct = (strlen(dec_str) == 1001 && dec_str[0] == '1');
+    for (i = 1; i < 1001 && correct; i++) {
+        correct = (dec_str[i] == '0');
+    }
+    if (!correct) {
+        FAIL("10^1000 to decimal");
+    }
+    free(dec_str);
+
+    // 10^1000 - 1 is 1000 9s.
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    subtract_from(r, one);
+    dec_str = real_to_decimal_str(r);
+    correct = (strlen(dec_str) == 1000);
+    for (i = 0; i < 1000 && correct; i++) {
+        correct = (dec_str[i] == '9');
+    }
+    if (!correct) {
+        FAIL("10^1000 - 1 to decimal");
+    }
+    free(dec_str);
+    free_real(one);
+    free_real(r);
+
+    // 10^(19 * 4) is 10^19 squared twice.
+    r = pow_word(10, 19*4);
+    if (check_equal(r, get_power_of_ten(2)) != 1) {
+        FAIL("get_power_of_ten(2)");
+    }
+    free_real(r);
+
+    return rtn;
+}
+
+int test_decimal_to_real() {
+    int rtn = 0;
+
+    char* strs[] = {
+        "-342",
+        "0.5",
+        "30111958256045056550262256846967767576.76271600169430058847757619092581866378082250145855637206374712502560758825364072187248838663453653907708940096199512481689453125",
+        "123456789012345678901234567890123456789012345678901234567890",
+        NULL};
+
+    // These are all exact in binary, so they should come back unchanged.
+    int i;
+    struct Real* r;
+    char* dec_str;
+    for (i = 0; strs[i] != NULL; i++) {
+        r = decimal_str_to_real(strs[i]);
+        dec_str = real_to_decimal_str(r);
+        if (strcmp(dec_str, strs[i]) != 0) {
+            FAIL("decimal round trip");
+            printf("correct: %s\n", strs[i]);
+            printf("ours:    %s\n", dec_str);
+        }
+        free(dec_str);
+        free_real(r);
+    }
+
+    // 0.1 isn't exact, but it should be close: 0x0.1999...
+    r = decimal_str_to_real("0.1");
+    struct Real* correct = fill_real(POSITIVE, -1, 0, 0x1999999999999999);
+    struct Real* diff = subtract(r, correct);
+    trim_most_significant_zeros(diff);
+    if (!is_zero(diff) && get_max_word_idx(diff) > -1) {
+        FAIL("0.1");
+    }
+    free_real(diff);
+    free_real(correct);
+    free_real(r);
+
+    if (decimal_str_to_real("1.2.3") != NULL ||
+        decimal_str_to_real("-") != NULL) {
+        FAIL("invalid strings should be NULL");
+    }
+
+    return rtn;
+}
+
+int test_thresholds() {
+    int rtn = 0;
+
+    struct Thresholds old_thresholds = thresholds;
+
+    // Splitting and the basecase should agree either way.
+    struct Real* r = pow_word(7, 2000);
+    set_word(r, get_min_word_idx(r), 12345);
+    thresholds.decimal_split_min_words = 1000;
+    char* basecase = real_to_decimal_str(r);
+    thresholds.decimal_split_min_words = 2;
+    char* split = real_to_decimal_str(r);
+    if (strcmp(basecase, split) != 0) {
+        FAIL("real_to_decimal with and without splitting");
+    }
+
+    struct Real* back = decimal_str_to_real(split);
+    if (check_equal(back, r) != 1) {
+        FAIL("decimal_to_real with splitting");
+    }
+    free_real(back);
+    thresholds.decimal_split_min_words = 1000;
+    back = decimal_str_to_real(split);
+    if (check_equal(back, r) != 1) {
+        FAIL("decimal_to_real without splitting");
+    }
+    free_real(back);
+
+    // Both ways of getting base 10^19 digits should give the same digits
+    // as the string.
+    size_t num_limbs = strlen(basecase) / 19 + 2;
+    word* limbs = malloc(num_limbs * sizeof(word));
+    char* limb_digits = malloc(19*num_limbs + 1);
+    size_t padding = 19*num_limbs - strlen(basecase);
+    size_t i;
+    int split_min_words;
+    for (split_min_words = 1000; split_min_words >= 2;
+         split_min_words -= 998) {
+        thresholds.decimal_split_min_words = split_min_words;
+        integer_to_radix_words(r, limbs, num_limbs);
+        for (i = 0; i < num_limbs; i++) {
+            sprintf(limb_digits + 19*i, "%019lu", limbs[i]);
+        }
+        if (strspn(limb_digits, "0") < padding ||
+            strcmp(limb_digits + padding, basecase) != 0) {
+            FAIL("integer_to_radix_words");
+        }
+    }
+    free(limbs);
+    free(limb_digits);
+
+    free(basecase);
+    free(split);
+    free_real(r);
+
+    thresholds = old_thresholds;
+
+    return rtn;
+}
+
+int test_cancel() {
+    int rtn = 0;
+
+    struct Thresholds old_thresholds = thresholds;
+    thresholds.decimal_split_min_words = 2;
+    thresholds.newton_div_min_words = 1;
+
+    struct Real* r = pow_word(3, 1000);
+    char* correct = real_to_decimal_str(r);
+
+    struct Progress progress;
+    init_progress(&progress, 0);
+    cancel_progress(&progress);
+    set_thread_progress(&progress);
+
+    // Splitting only takes exact divisions, which carry on regardless.
+    char* s = real_to_decimal_str(r);
+    if (strcmp(s, correct) != 0) {
+        FAIL("real_to_decimal_str");
+    }
+    // This isn't exact in binary, so it takes a Newton division.
+    if (decimal_str_to_real("0.3333333333333333333333333333") != NULL) {
+        FAIL("decimal_str_to_real should be cancelled");
+    }
+
+    set_thread_progress(NULL);
+    thresholds = old_thresholds;
+    free(s);
+    free(correct);
+    free_real(r);
+    return rtn;
+}
+
 test_func_t tests[] = {
     test_real_to_decimal,
+    test_powers_of_ten,
+    test_decimal_to_real,
+    test_thresholds,
+    test_cancel,
     NULL};
 char* test_names[] = {
     "real_to_decimal",
+    "powers_of_ten",
+    "decimal_to_real",
+    "thresholds",
+    "cancel",
     NULL};
 
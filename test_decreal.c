@@ -0,0 +1,327 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "decimal.h"
+#include "decreal.h"
+#include "thresholds.h"
+#include "trig.h"
+#include "test.h"
+
+
+int has_str(struct DecReal* d, char* correct) {
+    // Returns 1 if `d` prints as `correct`, and frees `d`.
+    if (d == NULL) {
+        return 0;
+    }
+    char* s = dec_real_to_decimal_str(d);
+    int rtn = (strcmp(s, correct) == 0);
+    if (!rtn) {
+        printf("got:     %s\ncorrect: %s\n", s, correct);
+    }
+    free(s);
+    free_dec_real(d);
+    return rtn;
+}
+
+int close_to(struct DecReal* d1, struct DecReal* d2,
+             ssize_t min_sig_limb_idx) {
+    // Returns 1 if `d1` and `d2` are within a few units of the limb at
+    // `min_sig_limb_idx`, and frees `d1`.
+    struct DecReal* diff = dec_subtract(d1, d2);
+    int rtn = (is_dec_zero(diff) ||
+               (get_max_limb_idx(diff) <= min_sig_limb_idx + 1 &&
+                get_limb(diff, min_sig_limb_idx) < 10));
+    free_dec_real(diff);
+    free_dec_real(d1);
+    return rtn;
+}
+
+struct DecReal* digits(char* s) {
+    return decimal_str_to_dec_real(s);
+}
+
+char* pattern_digits(size_t num_digits, unsigned seed) {
+    // Returns a string of `num_digits` digits with runs of 9s, so that
+    // carries run through whole limbs.
+    char* s = malloc(num_digits + 1);
+    size_t i;
+    s[0] = '1' + seed % 9;
+    for (i = 1; i < num_digits; i++) {
+        seed = seed*1103515245 + 12345;
+        s[i] = ((seed >> 16) % 3 == 0) ? '9' : '0' + (seed >> 16) % 10;
+    }
+    s[num_digits] = 0;
+    return s;
+}
+
+int test_strings() {
+    int rtn = 0;
+
+    char* strs[] = {
+        "0", "-12.375", "100000000000000000000",
+        "0.0000000000000000000000001", "-9999999999999999999.5",
+        "31415926535897932384626433832795028841971.693993751"};
+    size_t i;
+    for (i = 0; i < sizeof(strs) / sizeof(strs[0]); i++) {
+        if (has_str(digits(strs[i]), strs[i]) != 1) {
+            FAIL("decimal string round trip");
+        }
+    }
+
+    // Zeros after the point and before the first digit are dropped.
+    if (has_str(digits("-0.000"), "0") != 1 ||
+        has_str(digits("007.2500"), "7.25") != 1 ||
+        has_str(digits(".5"), "0.5") != 1) {
+        FAIL("zeros");
+    }
+    if (digits("1.2.3") != NULL || digits("") != NULL ||
+        digits("-") != NULL) {
+        FAIL("invalid strings");
+    }
+
+    struct DecReal* d = fill_dec_real(NEGATIVE, -1, 2, 5000000000000000000ul,
+                                      7, 1);
+    if (has_str(d, "-10000000000000000007.5") != 1) {
+        FAIL("fill_dec_real");
+    }
+
+    return rtn;
+}
+
+int test_add_subtract() {
+    int rtn = 0;
+
+    struct DecReal* a = digits("9999999999999999999.9999999999999999999");
+    struct DecReal* b = digits("0.0000000000000000001");
+    struct DecReal* c = digits("-12.5");
+    if (has_str(dec_add(a, b), "10000000000000000000") != 1 ||
+        has_str(dec_add(b, a), "10000000000000000000") != 1) {
+        FAIL("carrying");
+    }
+    if (has_str(dec_subtract(b, a),
+                "-9999999999999999999.9999999999999999998") != 1 ||
+        has_str(dec_add(c, b), "-12.4999999999999999999") != 1) {
+        FAIL("borrowing");
+    }
+    if (has_str(dec_subtract(c, c), "0") != 1 ||
+        has_str(dec_subtract(c, a),
+                "-10000000000000000012.4999999999999999999") != 1) {
+        FAIL("signs");
+    }
+
+    free_dec_real(a);
+    free_dec_real(b);
+    free_dec_real(c);
+    return rtn;
+}
+
+int check_multiply(size_t num_digits1, size_t num_digits2) {
+    // Returns 0 if multiplying integers with these many digits agrees with
+    // multiplying them in binary.
+    int rtn = 0;
+    char* s1 = pattern_digits(num_digits1, num_digits1);
+    char* s2 = pattern_digits(num_digits2, num_digits2 + 1);
+    struct Real* r1 = decimal_str_to_real(s1);
+    struct Real* r2 = decimal_str_to_real(s2);
+    struct Real* p = multiply(r1, r2);
+    char* correct = real_to_decimal_str(p);
+    struct DecReal* d1 = digits(s1);
+    struct DecReal* d2 = digits(s2);
+    if (has_str(dec_multiply(d1, d2), correct) != 1) {
+        FAIL("dec_multiply");
+    }
+
+    free(s1);
+    free(s2);
+    free(correct);
+    free_real(r1);
+    free_real(r2);
+    free_real(p);
+    free_dec_real(d1);
+    free_dec_real(d2);
+    return rtn;
+}
+
+int test_multiply() {
+    int rtn = 0;
+
+    struct DecReal* a = digits("1.5");
+    struct DecReal* b = digits("-0.25");
+    if (has_str(dec_multiply(a, b), "-0.375") != 1) {
+        FAIL("fractions");
+    }
+    free_dec_real(a);
+    free_dec_real(b);
+
+    ssize_t old_threshold = thresholds.karatsuba_min_words;
+    ssize_t karatsuba_thresholds[] = {old_threshold, 4, 1000};
+    int i;
+    for (i = 0; i < 3; i++) {
+        thresholds.karatsuba_min_words = karatsuba_thresholds[i];
+        if (check_multiply(1, 1) != 0 ||
+            check_multiply(50, 60) != 0 ||
+            check_multiply(400, 400) != 0 ||
+            check_multiply(1000, 150) != 0) {
+            FAIL("multiplying integers");
+        }
+    }
+
+    // Only the partial products below the precision are dropped.
+    char* s1 = pattern_digits(200, 1);
+    char* s2 = pattern_digits(200, 2);
+    s1[100] = '.';
+    s2[90] = '.';
+    struct DecReal* d1 = digits(s1);
+    struct DecReal* d2 = digits(s2);
+    struct DecReal* exact = dec_multiply(d1, d2);
+    truncate_dec_real(exact, -5);
+    thresholds.karatsuba_min_words = 1000;
+    if (close_to(dec_mul_with_sig(d1, d2, -5), exact, -5) != 1) {
+        FAIL("dec_mul_with_sig");
+    }
+    thresholds.karatsuba_min_words = old_threshold;
+    free_dec_real(exact);
+
+    free(s1);
+    free(s2);
+    free_dec_real(d1);
+    free_dec_real(d2);
+    return rtn;
+}
+
+int test_div() {
+    int rtn = 0;
+
+    struct DecReal* one = digits("1");
+    struct DecReal* n = digits("-123456789012345678901234567890");
+    if (has_str(dec_div_with_sig(one, 3, -2),
+                "0.33333333333333333333333333333333333333") != 1) {
+        FAIL("1/3");
+    }
+    // Divisors don't have to fit in 32 bits.
+    if (has_str(dec_div_with_sig(n, 18446744073709551615ul, -1),
+                "-6692605942.7634869180302818301") != 1 ||
+        has_str(dec_div_with_sig(n, 18446744073709551615ul, 1), "0") != 1) {
+        FAIL("dividing by a big word");
+    }
+    if (dec_div_with_sig(one, 0, 0) != NULL) {
+        FAIL("dividing by 0");
+    }
+
+    free_dec_real(one);
+    free_dec_real(n);
+    return rtn;
+}
+
+int test_cos() {
+    int rtn = 0;
+
+    // These are all exact in binary, so `cos_with_sig` computes the same
+    // cosines.
+    char* thetas[] = {"0", "1", "-2.5", "100.125", "0.0009765625"};
+    size_t i;
+    ssize_t sigs[] = {-1, -3, -10};
+    size_t j;
+    for (i = 0; i < sizeof(thetas) / sizeof(thetas[0]); i++) {
+        for (j = 0; j < sizeof(sigs) / sizeof(sigs[0]); j++) {
+            ssize_t sig = sigs[j];
+            struct DecReal* theta = digits(thetas[i]);
+            struct Real* r_theta = decimal_str_to_real(thetas[i]);
+            // With a few words to spare, since a limb is less than a word.
+            struct Real* r_cos = cos_with_sig(r_theta, sig + sig/2 - 2);
+            struct DecReal* correct = real_to_dec_real(r_cos, sig);
+            if (close_to(dec_cos_with_sig(theta, sig), correct, sig) != 1) {
+                FAIL("dec_cos_with_sig");
+                printf("theta = %s, sig = %ld\n", thetas[i], sig);
+            }
+            free_dec_real(theta);
+            free_dec_real(correct);
+            free_real(r_theta);
+            free_real(r_cos);
+        }
+    }
+
+    return rtn;
+}
+
+int test_conversions() {
+    int rtn = 0;
+
+    // Fractions in binary have exact decimal expansions, of which the
+    // conversion keeps the first limbs.
+    struct Real* r = fill_real(NEGATIVE, -2, 2, 0x0123456789abcdeful,
+                               0xfedcba9876543210ul, 12345, 1);
+    char* correct = real_to_decimal_str(r);
+    struct DecReal* d = real_to_dec_real(r, -3);
+    char* s = dec_real_to_decimal_str(d);
+    if (strlen(s) < strlen(correct) - 128 + 50 ||
+        strncmp(s, correct, strlen(s)) != 0) {
+        FAIL("real_to_dec_real");
+    }
+    struct Real* back = dec_real_to_real(d, -3);
+    struct Real* diff = subtract(r, back);
+    // The limbs after the first 3 are gone, and 10^-57 < 2^-189.
+    if (get_exponent(diff) > -189 || get_sign(back) != NEGATIVE) {
+        FAIL("dec_real_to_real");
+    }
+    free(s);
+    free(correct);
+    free_real(r);
+    free_real(back);
+    free_real(diff);
+    free_dec_real(d);
+
+    // Integers convert exactly, with and without splitting.
+    ssize_t old_threshold = thresholds.decimal_split_min_words;
+    ssize_t split_thresholds[] = {old_threshold, 2};
+    int i;
+    for (i = 0; i < 2; i++) {
+        thresholds.decimal_split_min_words = split_thresholds[i];
+        r = pow_word(3, 1000);
+        shift_words(r, 1);
+        correct = real_to_decimal_str(r);
+        d = real_to_dec_real(r, 0);
+        back = dec_real_to_real(d, 0);
+        if (has_str(d, correct) != 1 || check_equal(back, r) != 1) {
+            FAIL("integers");
+        }
+        free(correct);
+        free_real(r);
+        free_real(back);
+    }
+    thresholds.decimal_split_min_words = old_threshold;
+
+    // Limbs above the units, and truncation at them.
+    d = digits("-5000000000000000000000000000000000000000");
+    r = dec_real_to_real(d, 0);
+    if (has_str(real_to_dec_real(r, 2),
+                "-5000000000000000000000000000000000000000") != 1 ||
+        has_str(real_to_dec_real(r, 3), "0") != 1) {
+        FAIL("big limbs");
+    }
+    free_real(r);
+    free_dec_real(d);
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_strings,
+    test_add_subtract,
+    test_multiply,
+    test_div,
+    test_cos,
+    test_conversions,
+    NULL};
+char* test_names[] = {
+    "strings",
+    "add_subtract",
+    "multiply",
+    "div",
+    "cos",
+    "conversions",
+    NULL};
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "decimal.h"
+#include "thresholds.h"
+#include "digitfile.h"
+#include "test.h"
+
+
+// 22/7 = 3.142857142857..., and 1/7 = 0.142857142857...
+char* sevenths = "142857";
+
+int make_temp_path(char* path) {
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+struct Real* over_seven(word n, enum sign_t sign, ssize_t min_sig_word_idx) {
+    struct Real* numerator = fill_real(sign, 0, 1, n);
+    struct Real* seven = fill_real(POSITIVE, 0, 1, 7);
+    struct Real* rtn = long_div_with_sig(numerator, seven, min_sig_word_idx);
+    free_real(numerator);
+    free_real(seven);
+    return rtn;
+}
+
+int check_sevenths(struct DigitFile* f, size_t position, size_t num_digits) {
+    // Returns 1 if the digits at `position` are those of 1/7.
+    char* digits = malloc(num_digits + 1);
+    int rtn = (read_digits(f, position, num_digits, digits) == 0);
+    size_t i;
+    for (i = 0; i < num_digits && rtn; i++) {
+        rtn = (digits[i] == sevenths[(position + i) % 6]);
+    }
+    free(digits);
+    return rtn;
+}
+
+int test_read_write() {
+    int rtn = 0;
+
+    char path[] = "/tmp/test_digitfile_XXXXXX";
+    if (make_temp_path(path) != 0) {
+        FAIL("mkstemp");
+        return rtn;
+    }
+
+    // Enough digits for 2 blocks, converted with splitting.
+    struct Thresholds old_thresholds = thresholds;
+    thresholds.decimal_split_min_words = 4;
+    size_t num_digits = 19*DIGIT_BLOCK_WORDS + 1000;
+    struct Real* r = over_seven(22, POSITIVE, -1100);
+    if (write_digit_file(path, r, num_digits) != 0) {
+        FAIL("write_digit_file");
+    }
+    free_real(r);
+    thresholds = old_thresholds;
+
+    struct DigitFile* f = open_digit_file(path);
+    if (f == NULL) {
+        FAIL("open_digit_file");
+        return rtn;
+    }
+    if (strcmp(get_integer_digits(f), "3") != 0 ||
+        get_num_digits(f) != num_digits) {
+        FAIL("header");
+    }
+
+    // The start, across words, across blocks and the very end.
+    if (check_sevenths(f, 0, 100) != 1 ||
+        check_sevenths(f, 17, 5) != 1 ||
+        check_sevenths(f, 19*DIGIT_BLOCK_WORDS - 10, 20) != 1 ||
+        check_sevenths(f, num_digits - 7, 7) != 1 ||
+        check_sevenths(f, 5, 0) != 1) {
+        FAIL("digits of 22/7");
+    }
+
+    char digits[10];
+    if (read_digits(f, num_digits - 7, 8, digits) != -1 ||
+        read_digits(f, num_digits + 1, 0, digits) != -1) {
+        FAIL("reading past the end should fail");
+    }
+    close_digit_file(f);
+
+    // Digits are truncated, and the last word only keeps the ones asked
+    // for.
+    r = over_seven(1, NEGATIVE, -2);
+    write_digit_file(path, r, 5);
+    free_real(r);
+    f = open_digit_file(path);
+    if (f == NULL || strcmp(get_integer_digits(f), "-0") != 0 ||
+        read_digits(f, 0, 5, digits) != 0 || strcmp(digits, "14285") != 0) {
+        FAIL("-1/7 to 5 digits");
+    }
+    if (f != NULL) {
+        close_digit_file(f);
+    }
+
+    // This should agree with the string conversion.
+    r = pow_word(3, 100);
+    shift_words(r, -3);
+    char* s = real_to_decimal_str(r);
+    write_digit_file(path, r, 150);
+    f = open_digit_file(path);
+    char* point = strchr(s, '.');
+    char* file_digits = malloc(151);
+    if (f == NULL || read_digits(f, 0, 150, file_digits) != 0 ||
+        strncmp(s, get_integer_digits(f), point - s) != 0 ||
+        strncmp(point + 1, file_digits, 150) != 0) {
+        FAIL("3^100 / 2^192");
+    }
+    if (f != NULL) {
+        close_digit_file(f);
+    }
+    free(file_digits);
+    free(s);
+    free_real(r);
+
+    unlink(path);
+    return rtn;
+}
+
+void flip_byte(char* path, long offset) {
+    FILE* f = fopen(path, "r+b");
+    fseek(f, offset, SEEK_SET);
+    int c = fgetc(f);
+    fseek(f, offset, SEEK_SET);
+    fputc(c ^ 1, f);
+    fclose(f);
+}
+
+int test_corruption() {
+    int rtn = 0;
+
+    char path[] = "/tmp/test_digitfile_XXXXXX";
+    if (make_temp_path(path) != 0) {
+        FAIL("mkstemp");
+        return rtn;
+    }
+
+    if (open_digit_file("/nonexistent/digits") != NULL ||
+        open_digit_file(path) != NULL) {
+        FAIL("a missing or empty file shouldn't open");
+    }
+
+    size_t num_digits = 19*DIGIT_BLOCK_WORDS + 1000;
+    struct Real* r = over_seven(1, POSITIVE, -1100);
+    write_digit_file(path, r, num_digits);
+    free_real(r);
+
+    // Damage the last word, which is in the second block.
+    FILE* file = fopen(path, "rb");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    flip_byte(path, size - 1);
+
+    struct DigitFile* f = open_digit_file(path);
+    if (f == NULL) {
+        FAIL("open_digit_file");
+        return rtn;
+    }
+    if (check_sevenths(f, 100, 100) != 1) {
+        FAIL("the first block is fine");
+    }
+    char digits[20];
+    if (read_digits(f, num_digits - 10, 10, digits) != -1) {
+        FAIL("the second block should be corrupt");
+    }
+    close_digit_file(f);
+
+    // Damaging the header or the index is caught when opening.
+    flip_byte(path, size - 1);
+    flip_byte(path, 0);
+    if (open_digit_file(path) != NULL) {
+        FAIL("bad magic");
+    }
+    flip_byte(path, 0);
+    // The index is just before the words.
+    flip_byte(path, size - (num_digits + 18) / 19 * sizeof(word) - 1);
+    if (open_digit_file(path) != NULL) {
+        FAIL("bad index");
+    }
+
+    // A header whose number of words wraps around to 0 when it's rounded
+    // up, so it has no blocks: the magic, then the number of digits, of
+    // words, of words per block and of blocks, the checksum of the empty
+    // index, and the integer part.
+    uint64_t header[14] = {0};
+    memcpy(header, "RDIGIT01", 8);
+    header[1] = (uint64_t) -1;
+    header[3] = DIGIT_BLOCK_WORDS;
+    header[5] = 0xcbf29ce484222325ul;
+    header[6] = '3';
+    file = fopen(path, "wb");
+    fwrite(header, sizeof(uint64_t), 14, file);
+    fclose(file);
+    f = open_digit_file(path);
+    if (f != NULL) {
+        FAIL("the number of words wrapped around");
+        if (read_digits(f, 100000000, 5, digits) != -1) {
+            FAIL("reading past the end of the file");
+        }
+        close_digit_file(f);
+    }
+
+    unlink(path);
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_read_write,
+    test_corruption,
+    NULL};
+char* test_names[] = {
+    "read_write",
+    "corruption",
+    NULL};
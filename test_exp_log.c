@@ -0,0 +1,157 @@
+#include <stdio.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "exp_log.h"
+#include "test.h"
+
+
+int test_constants() {
+    int rtn = 0;
+
+    struct Real* correct = fill_real(POSITIVE, -6, 1,
+                                     0xbe5466cf34e90c6c, 0x452821e638d01377,
+                                     0x082efa98ec4e6c89, 0xa4093822299f31d0,
+                                     0x13198a2e03707344, 0x243f6a8885a308d3,
+                                     3);
+    struct Real* r = pi_with_sig(-6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("pi_with_sig");
+        print_real(r);
+    }
+    free_real(r);
+    free_real(correct);
+
+    correct = fill_real(POSITIVE, -6, 0,
+                        0x559552fb4afa1b10, 0xe7b876206debac98,
+                        0x8a0d175b8baafa2b, 0x40f343267298b62d,
+                        0xc9e3b39803f2f6af, 0xb17217f7d1cf79ab);
+    r = ln2_with_sig(-6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("ln2_with_sig");
+    }
+    free_real(r);
+
+    struct Real* correct_short = div_with_sig(correct, 1, -2);
+    r = ln2_with_sig(-2);
+    if (close_enough(r, correct_short, -2) != 1) {
+        FAIL("ln2_with_sig(-2)");
+    }
+    free_real(r);
+    free_real(correct_short);
+    free_real(correct);
+
+    return rtn;
+}
+
+int test_exp() {
+    int rtn = 0;
+
+    struct Real* x = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* correct = fill_real(POSITIVE, -6, 1,
+                                     0xf4bf8d8d8c31d763, 0x324e7738926cfbe5,
+                                     0xa784d9045190cfef, 0x62e7160f38b4da56,
+                                     0xbf7158809cf4f3c7, 0xb7e151628aed2a6a,
+                                     2);
+    struct Real* r = exp_with_sig(x, -6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("exp(1)");
+        print_real(r);
+    }
+    free_real(x);
+    free_real(r);
+    free_real(correct);
+
+    x = fill_real(NEGATIVE, -1, 1, (word) 1 << (WORD_BITS - 1), 2);
+    correct = fill_real(POSITIVE, -6, 0,
+                        0xa94083f9e5dd652e, 0x1a4d89a218c2da4a,
+                        0x9db7c82da0de5111, 0x0799197b545e8037,
+                        0x5e4834abd7028400, 0x150385c094f424a7);
+    r = exp_with_sig(x, -6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("exp(-2.5)");
+    }
+    free_real(x);
+    free_real(r);
+    free_real(correct);
+
+    x = fill_real(POSITIVE, 0, 1, 10);
+    correct = fill_real(POSITIVE, -6, 1,
+                        0x3b6c538c6456869f, 0xa9c30b846ae8e86f,
+                        0x86ec735a7ddacc3f, 0xcd4a5cc3b7cc68f7,
+                        0x3015b44d322ea985, 0x773e54157e7c1faa,
+                        0x000000000000560a);
+    r = exp_with_sig(x, -6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("exp(10)");
+    }
+    free_real(x);
+    free_real(r);
+    free_real(correct);
+
+    return rtn;
+}
+
+int test_log() {
+    int rtn = 0;
+
+    struct Real* x = fill_real(POSITIVE, 0, 1, 10);
+    struct Real* correct = fill_real(POSITIVE, -6, 1,
+                                     0x31c32f00b17c35a0, 0x58bc0b5ec6a04173,
+                                     0x0f187a0807c0b5ca, 0x8a3fb3e76977e43a,
+                                     0xa95b58ae0b4c28a3, 0x4d763776aaa2b05b,
+                                     2);
+    struct Real* r = log_with_sig(x, -6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("log(10)");
+        print_real(r);
+    }
+    free_real(x);
+    free_real(r);
+    free_real(correct);
+
+    // log(1/2) = -log(2)
+    x = fill_real(POSITIVE, -1, 0, (word) 1 << (WORD_BITS - 1));
+    correct = fill_real(NEGATIVE, -6, 0,
+                        0x559552fb4afa1b10, 0xe7b876206debac98,
+                        0x8a0d175b8baafa2b, 0x40f343267298b62d,
+                        0xc9e3b39803f2f6af, 0xb17217f7d1cf79ab);
+    r = log_with_sig(x, -6);
+    if (close_enough(r, correct, -6) != 1) {
+        FAIL("log(1/2)");
+    }
+    free_real(x);
+    free_real(r);
+    free_real(correct);
+
+    // exp(log(x)) = x at high precision.
+    x = fill_real(POSITIVE, -1, 1, 0x243f6a8885a308d3, 3);
+    r = log_with_sig(x, -30);
+    struct Real* y = exp_with_sig(r, -28);
+    if (close_enough(x, y, -28) != 1) {
+        FAIL("exp(log(x)) = x");
+    }
+    free_real(x);
+    free_real(r);
+    free_real(y);
+
+    x = fill_real(NEGATIVE, 0, 1, 1);
+    if (log_with_sig(x, -2) != NULL) {
+        FAIL("log of a negative number should be NULL");
+    }
+    free_real(x);
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_constants,
+    test_exp,
+    test_log,
+    NULL};
+char* test_names[] = {
+    "constants",
+    "exp",
+    "log",
+    NULL};
@@ -0,0 +1,199 @@
+#include <stdio.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "constants.h"
+#include "expr.h"
+#include "test.h"
+
+
+int test_arithmetic() {
+    int rtn = 0;
+
+    struct Real* r = fill_real(POSITIVE, 0, 1, 1);
+    struct Expr* one = const_expr(r);
+    free_real(r);
+    r = fill_real(POSITIVE, 0, 1, 3);
+    struct Expr* three = const_expr(r);
+    free_real(r);
+
+    // (1/3) * 3 - 1 = 0
+    struct Expr* third = div_expr(one, three);
+    struct Expr* product = mul_expr(third, three);
+    struct Expr* zero = sub_expr(product, one);
+
+    struct Real* correct = fill_real(POSITIVE, 0, 1, 0);
+    r = eval_expr(zero, -5);
+    if (r == NULL || close_enough(r, correct, -6) != 1) {
+        FAIL("(1/3) * 3 - 1");
+    }
+    free_real(r);
+    free_real(correct);
+
+    // 1/3 = 0x0.5555...
+    correct = fill_real(POSITIVE, -4, 0, 0x5555555555555555,
+                        0x5555555555555555, 0x5555555555555555,
+                        0x5555555555555555);
+    r = eval_expr(third, -3);
+    if (r == NULL || close_enough(r, correct, -4) != 1) {
+        FAIL("1/3");
+    }
+    free_real(r);
+
+    // -(1/3) + 1/3 = 0
+    struct Expr* neg_third = neg_expr(third);
+    struct Expr* sum = add_expr(neg_third, third);
+    r = eval_expr(sum, -4);
+    if (r == NULL || !is_zero(r)) {
+        FAIL("-(1/3) + 1/3");
+    }
+    free_real(r);
+    free_real(correct);
+
+    // Dividing by something that is exactly 0 can't be evaluated.
+    struct Expr* bad = div_expr(one, zero);
+    if (eval_expr(bad, -1) != NULL) {
+        FAIL("division by 0 should be NULL");
+    }
+
+    release_expr(bad);
+    release_expr(sum);
+    release_expr(neg_third);
+    release_expr(zero);
+    release_expr(product);
+    release_expr(third);
+    release_expr(three);
+    release_expr(one);
+
+    return rtn;
+}
+
+int test_functions() {
+    int rtn = 0;
+
+    struct Real* r = fill_real(NEGATIVE, -1, 1, 0x8000000000000000, 2);
+    struct Expr* x = const_expr(r);
+    free_real(r);
+
+    // cos^2 + sin^2 = 1
+    struct Expr* c = cos_expr(x);
+    struct Expr* s = sin_expr(x);
+    struct Expr* c2 = mul_expr(c, c);
+    struct Expr* s2 = mul_expr(s, s);
+    struct Expr* one = add_expr(c2, s2);
+
+    struct Real* correct = fill_real(POSITIVE, 0, 1, 1);
+    r = eval_expr(one, -4);
+    if (r == NULL || close_enough(r, correct, -5) != 1) {
+        FAIL("cos^2 + sin^2");
+    }
+    free_real(r);
+
+    // sqrt(e^(2 log(cos^2 + sin^2))) = 1
+    struct Expr* l = log_expr(one);
+    struct Expr* l2 = add_expr(l, l);
+    struct Expr* e = exp_expr(l2);
+    struct Expr* root = sqrt_expr(e);
+    r = eval_expr(root, -4);
+    if (r == NULL || close_enough(r, correct, -5) != 1) {
+        FAIL("sqrt(exp(2 log(1)))");
+    }
+    free_real(r);
+    free_real(correct);
+
+    // e^(log(x^2)/2) = |x|
+    struct Expr* x2 = mul_expr(x, x);
+    struct Expr* lx2 = log_expr(x2);
+    struct Expr* mx = neg_expr(x);
+    struct Expr* lx = log_expr(mx);
+    struct Expr* diff = sub_expr(lx2, lx);
+    struct Expr* abs_x = exp_expr(diff);
+    r = eval_expr(abs_x, -3);
+    correct = fill_real(POSITIVE, -1, 1, 0x8000000000000000, 2);
+    if (r == NULL || close_enough(r, correct, -4) != 1) {
+        FAIL("exp(log(x^2) - log(-x))");
+    }
+    free_real(r);
+    free_real(correct);
+
+    release_expr(abs_x);
+    release_expr(diff);
+    release_expr(lx);
+    release_expr(mx);
+    release_expr(lx2);
+    release_expr(x2);
+    release_expr(root);
+    release_expr(e);
+    release_expr(l2);
+    release_expr(l);
+    release_expr(one);
+    release_expr(s2);
+    release_expr(c2);
+    release_expr(s);
+    release_expr(c);
+    release_expr(x);
+
+    return rtn;
+}
+
+int test_caching() {
+    int rtn = 0;
+
+    struct Expr* pi = pi_expr();
+    struct Real* r = fill_real(POSITIVE, 0, 1, 4);
+    struct Expr* four = const_expr(r);
+    free_real(r);
+    struct Expr* quarter_pi = div_expr(pi, four);
+    struct Expr* s = sin_expr(quarter_pi);
+    struct Expr* half = mul_expr(s, s);
+
+    struct Real* correct = fill_real(POSITIVE, -1, 0, 0x8000000000000000);
+    r = eval_expr(half, -3);
+    if (r == NULL || close_enough(r, correct, -4) != 1) {
+        FAIL("sin(pi/4)^2 at -3");
+    }
+    free_real(r);
+
+    // This is answered from the cache.
+    ssize_t cached = get_expr_precision(half);
+    r = eval_expr(half, -2);
+    if (r == NULL || close_enough(r, correct, -3) != 1) {
+        FAIL("sin(pi/4)^2 at -2");
+    }
+    free_real(r);
+    if (get_expr_precision(half) != cached) {
+        FAIL("a less precise query shouldn't recompute");
+    }
+
+    // A slightly more precise query goes to at least twice the words.
+    r = eval_expr(half, cached - 1);
+    if (r == NULL || close_enough(r, correct, cached - 2) != 1) {
+        FAIL("sin(pi/4)^2 at higher precision");
+    }
+    free_real(r);
+    if (get_expr_precision(half) > 2*cached - 1) {
+        FAIL("the cache should at least double");
+    }
+    free_real(correct);
+
+    release_expr(half);
+    release_expr(s);
+    release_expr(quarter_pi);
+    release_expr(four);
+    release_expr(pi);
+    clear_constant_cache();
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_arithmetic,
+    test_functions,
+    test_caching,
+    NULL};
+char* test_names[] = {
+    "arithmetic",
+    "functions",
+    "caching",
+    NULL};
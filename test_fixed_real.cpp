@@ -0,0 +1,124 @@
+#include <stdio.h>
+
+#include "fixed_real.hpp"
+
+extern "C" {
+#include "arithmetic.h"
+#include "test.h"
+}
+
+
+template <int N, int F = N - 1>
+using Fixed = real::fixed::Real<N, F>;
+
+// Built at compile time.
+constexpr Fixed<3> one_third = Fixed<3>(1) / 3;
+static_assert(one_third.get_word_at(-1) == 0x5555555555555555, "1/3");
+static_assert(one_third * 3 != Fixed<3>(1) && one_third * 3 < Fixed<3>(1),
+              "1/3 * 3 is truncated");
+static_assert(-(Fixed<2>(2) - Fixed<2>(5)) == Fixed<2>(3), "-(2 - 5)");
+static_assert((Fixed<2>(0) - Fixed<2>(0)).sign() == POSITIVE, "0 - 0");
+
+template <int N, int F>
+Fixed<N, F> pattern_fixed(enum sign_t sign, word seed) {
+    // Returns a number with a mix of all-1 and arbitrary words, so that
+    // carries run all the way through. The integer part is at most 255,
+    // so sums and products don't overflow.
+    struct Real* r = pattern_real(sign, 0, N, seed);
+    word words[N] = {};
+    int i;
+    for (i = 0; i < N; i++) {
+        words[i] = get_word(r, i);
+        if (i > F) {
+            words[i] = 0;
+        } else if (i == F) {
+            words[i] &= 0xff;
+        }
+    }
+    free_real(r);
+    return Fixed<N, F>::from_words(sign, words);
+}
+
+template <int N, int F>
+int check_against_real() {
+    // Returns 0 if the fixed-width arithmetic agrees with struct Real
+    // truncated to the same words.
+    int rtn = 0;
+    enum sign_t signs[] = {POSITIVE, NEGATIVE};
+    struct Real* zero = fill_real(POSITIVE, 0, 1, 0);
+    int i, j;
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 4; j++) {
+            Fixed<N, F> a = pattern_fixed<N, F>(signs[i % 2], i);
+            Fixed<N, F> b = pattern_fixed<N, F>(signs[j / 2], j + 10);
+            struct Real* ra = a.to_real();
+            struct Real* rb = b.to_real();
+            struct Real* sum = add(ra, rb);
+            struct Real* diff = subtract(ra, rb);
+            struct Real* p = multiply(ra, rb);
+            truncate_real(p, -F);
+            struct Real* q = div_with_sig(ra, 1000003, -F);
+
+            if (same((a + b).to_real(), sum) != 1) {
+                FAIL("add");
+            }
+            if (same((a - b).to_real(), diff) != 1 ||
+                same((a - a).to_real(), zero) != 1) {
+                FAIL("subtract");
+            }
+            if (same((a * b).to_real(), p) != 1) {
+                FAIL("multiply");
+            }
+            if (same((a / 1000003).to_real(), q) != 1) {
+                FAIL("divide");
+            }
+            Fixed<N, F> c = Fixed<N, F>::from_real(ra);
+            if (c != a || (a < b) + (b < a) + (a == b) != 1) {
+                FAIL("from_real and compare");
+            }
+
+            free_real(ra);
+            free_real(rb);
+            free_real(sum);
+            free_real(diff);
+            free_real(p);
+            free_real(q);
+        }
+    }
+    free_real(zero);
+    return rtn;
+}
+
+int test_arithmetic() {
+    int rtn = 0;
+
+    if (check_against_real<2, 1>() != 0 ||
+        check_against_real<4, 3>() != 0 ||
+        check_against_real<8, 7>() != 0 ||
+        check_against_real<5, 2>() != 0 ||
+        check_against_real<3, 0>() != 0) {
+        FAIL("fixed-width arithmetic");
+    }
+
+    // Only the words in range are kept.
+    struct Real* r = fill_real(NEGATIVE, -3, 2, 1, 2, 3, 4, 5);
+    Fixed<3, 2> x = Fixed<3, 2>::from_real(r);
+    struct Real* kept = fill_real(NEGATIVE, -2, 1, 2, 3, 4);
+    if (same(x.to_real(), kept) != 1) {
+        FAIL("from_real");
+    }
+    free_real(kept);
+    free_real(r);
+
+    return rtn;
+}
+
+
+extern "C" {
+test_func_t tests[] = {
+    test_arithmetic,
+    NULL};
+char* test_names[] = {
+    (char*) "arithmetic",
+    NULL};
+}
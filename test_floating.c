@@ -0,0 +1,163 @@
+#include <stdio.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "floating.h"
+#include "test.h"
+
+
+int test_round() {
+    int rtn = 0;
+
+    struct FloatContext ctx = {1, ROUND_NEAREST};
+
+    // 1.5 is a tie between 1 and 2, so we round to the even one.
+    struct Real* r = fill_real(POSITIVE, -1, 1,
+                               (word) 1 << (sizeof(word)*8 - 1), 1);
+    struct Real* correct = fill_real(POSITIVE, 0, 1, 2);
+    round_to_precision(r, &ctx);
+    if (check_equal(r, correct) != 1) {
+        FAIL("round_to_precision: tie rounding up to even");
+    }
+    if (get_exponent(r) != 2) {
+        FAIL("get_exponent");
+    }
+    free_real(r);
+    free_real(correct);
+
+    // 2.5 is a tie between 2 and 3, so we round down to 2.
+    ctx.precision = 2;
+    r = fill_real(NEGATIVE, -1, 1,
+                  (word) 1 << (sizeof(word)*8 - 1), 2);
+    correct = fill_real(NEGATIVE, 0, 1, 2);
+    round_to_precision(r, &ctx);
+    if (check_equal(r, correct) != 1) {
+        FAIL("round_to_precision: tie rounding down to even");
+    }
+    if (get_min_word_idx(r) != 0 || get_max_word_idx(r) != 1) {
+        FAIL("round_to_precision: normalized word indices");
+    }
+    free_real(r);
+    free_real(correct);
+
+    return rtn;
+}
+
+int test_float_add() {
+    int rtn = 0;
+
+    struct FloatContext ctx = {64, ROUND_NEAREST};
+
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* tiny = fill_real(POSITIVE, -4, -3, 1);
+    struct Real* sum;
+    struct Real* correct;
+
+    sum = float_add(&ctx, one, tiny);
+    if (check_equal(sum, one) != 1) {
+        FAIL("float_add: nearest with tiny addend");
+    }
+    if (get_max_word_idx(sum) - get_min_word_idx(sum) != 1) {
+        FAIL("float_add: result should be a single word");
+    }
+    free_real(sum);
+
+    // Truncating 1 - tiny gives the largest value below 1.
+    ctx.rounding = ROUND_ZERO;
+    sum = float_subtract(&ctx, one, tiny);
+    correct = fill_real(POSITIVE, -1, 0, (word) -1);
+    if (check_equal(sum, correct) != 1) {
+        FAIL("float_subtract: truncation with tiny subtrahend");
+    }
+    free_real(sum);
+    free_real(correct);
+
+    free_real(one);
+    free_real(tiny);
+
+    return rtn;
+}
+
+int test_float_mul_div() {
+    int rtn = 0;
+
+    struct FloatContext ctx = {64, ROUND_NEAREST};
+
+    struct Real* a = fill_real(POSITIVE, 0, 1, (word) -1);
+    struct Real* correct = fill_real(POSITIVE, 1, 2, (word) -2);
+    struct Real* p = float_multiply(&ctx, a, a);
+    if (check_equal(p, correct) != 1) {
+        FAIL("float_multiply");
+    }
+    free_real(a);
+    free_real(p);
+    free_real(correct);
+
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* q = float_div_word(&ctx, one, 3);
+    correct = fill_real(POSITIVE, -2, 0,
+                        0x8000000000000000, 0x5555555555555555);
+    if (check_equal(q, correct) != 1) {
+        FAIL("float_div_word: 64 bits");
+    }
+    free_real(q);
+    free_real(correct);
+
+    ctx.precision = 10;
+    q = float_div_word(&ctx, one, 3);
+    correct = fill_real(POSITIVE, -1, 0, 0x5560000000000000);
+    if (check_equal(q, correct) != 1) {
+        FAIL("float_div_word: 10 bits");
+    }
+    free_real(q);
+    free_real(correct);
+    free_real(one);
+
+    return rtn;
+}
+
+int test_bounded() {
+    int rtn = 0;
+
+    // Iterate x <- (x*x + 1)/3; without rounding the number of words would
+    // double every step.
+    struct FloatContext ctx = {128, ROUND_NEAREST};
+
+    struct Real* x = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* temp1;
+    struct Real* temp2;
+
+    int step;
+    for (step = 0; step < 50; step++) {
+        temp1 = float_multiply(&ctx, x, x);
+        temp2 = float_add(&ctx, temp1, one);
+        free_real(temp1);
+        free_real(x);
+        x = float_div_word(&ctx, temp2, 3);
+        free_real(temp2);
+
+        if (get_max_word_idx(x) - get_min_word_idx(x) > 3) {
+            FAIL("words should stay bounded by the precision");
+            break;
+        }
+    }
+    free_real(x);
+    free_real(one);
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_round,
+    test_float_add,
+    test_float_mul_div,
+    test_bounded,
+    NULL};
+char* test_names[] = {
+    "round",
+    "float_add",
+    "float_mul_div",
+    "bounded",
+    NULL};
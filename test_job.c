@@ -0,0 +1,166 @@
+#include <stdio.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "trig.h"
+#include "exp_log.h"
+#include "constants.h"
+#include "job.h"
+#include "test.h"
+
+
+// Big enough that these jobs run for a good while.
+#define LONG_JOB_SIG_WORD_IDX -100000
+
+
+int test_results() {
+    int rtn = 0;
+
+    struct JobParams params = {NULL, -8, 0};
+    struct Job* job = real_job_start(JOB_PI, &params);
+    if (real_job_wait(job, -1) != 0) {
+        FAIL("waiting forever should wait until it's done");
+    }
+    struct JobProgress progress;
+    real_job_progress(job, &progress);
+    if (progress.status != JOB_DONE || progress.num_stages != 0) {
+        FAIL("pi should be done");
+    }
+    struct Real* r = real_job_result(job);
+    struct Real* correct = pi_with_sig(-8);
+    if (r == NULL || close_enough(r, correct, -8) != 1) {
+        FAIL("pi");
+    }
+    free_real(r);
+    free_real(correct);
+    real_job_free(job);
+
+    params.x = fill_real(POSITIVE, -1, 1, 0x8000000000000000, 1);
+    job = real_job_start(JOB_COS, &params);
+    // The job has its own copy of the argument.
+    free_real(params.x);
+    params.x = NULL;
+    real_job_wait(job, -1);
+    r = real_job_result(job);
+    struct Real* theta = fill_real(POSITIVE, -1, 1, 0x8000000000000000, 1);
+    correct = cos_with_sig(theta, -8);
+    if (r == NULL || close_enough(r, correct, -8) != 1) {
+        FAIL("cos(1.5)");
+    }
+    free_real(r);
+    free_real(correct);
+    real_job_free(job);
+
+    negate(theta);
+    params.x = theta;
+    job = real_job_start(JOB_LOG, &params);
+    real_job_wait(job, -1);
+    real_job_progress(job, &progress);
+    if (progress.status != JOB_FAILED || real_job_result(job) != NULL) {
+        FAIL("the log of a negative number should fail");
+    }
+    real_job_free(job);
+
+    if (real_job_start(JOB_SQRT, &(struct JobParams) {NULL, -1, 0})
+        != NULL) {
+        FAIL("a job without its argument shouldn't start");
+    }
+    free_real(theta);
+
+    return rtn;
+}
+
+int test_cancel() {
+    int rtn = 0;
+
+    struct JobParams params = {NULL, LONG_JOB_SIG_WORD_IDX, 0};
+    struct Job* job = real_job_start(JOB_PI, &params);
+    if (real_job_wait(job, 0.05) != -1) {
+        FAIL("pi shouldn't be done this quickly");
+    }
+
+    struct JobProgress progress;
+    real_job_progress(job, &progress);
+    if (progress.status != JOB_RUNNING || progress.num_stages < 1) {
+        FAIL("pi should be running");
+    } else if (progress.stages[0].total == 0) {
+        FAIL("the AGM steps should have a total");
+    }
+    if (progress.elapsed < 0.05) {
+        FAIL("elapsed time");
+    }
+
+    real_job_cancel(job);
+    if (real_job_wait(job, 60) != 0) {
+        FAIL("cancelling should stop pi");
+    }
+    real_job_progress(job, &progress);
+    if (progress.status != JOB_CANCELLED || real_job_result(job) != NULL) {
+        FAIL("pi should be cancelled");
+    }
+    real_job_free(job);
+
+    // Freeing a running job cancels it.
+    params.x = fill_real(POSITIVE, 0, 1, 1);
+    job = real_job_start(JOB_SIN, &params);
+    real_job_free(job);
+    free_real(params.x);
+
+    return rtn;
+}
+
+int test_deadline() {
+    int rtn = 0;
+
+    // log needs pi and ln(2) from the constant cache, and a cancelled
+    // constant shouldn't be stored.
+    clear_constant_cache();
+    struct JobParams params = {NULL, LONG_JOB_SIG_WORD_IDX, 0.05};
+    params.x = fill_real(POSITIVE, 0, 1, 3);
+    struct Job* job = real_job_start(JOB_LOG, &params);
+    if (real_job_wait(job, 60) != 0) {
+        FAIL("the deadline should stop log");
+    }
+    struct JobProgress progress;
+    real_job_progress(job, &progress);
+    if (progress.status != JOB_CANCELLED) {
+        FAIL("log should be cancelled");
+    }
+    real_job_free(job);
+
+    if (get_constant_precision(CONSTANT_PI) < LONG_JOB_SIG_WORD_IDX / 2 ||
+        get_constant_precision(CONSTANT_LN2) < LONG_JOB_SIG_WORD_IDX / 2) {
+        FAIL("cancelled constants shouldn't be stored");
+    }
+
+    // Cancelling a job doesn't affect other ones.
+    params.min_sig_word_idx = -4;
+    params.timeout = 0;
+    job = real_job_start(JOB_EXP, &params);
+    real_job_wait(job, -1);
+    struct Real* r = real_job_result(job);
+    struct Real* correct = exp_with_sig(params.x, -4);
+    if (r == NULL || close_enough(r, correct, -4) != 1) {
+        FAIL("exp(3)");
+    }
+    free_real(r);
+    free_real(correct);
+    real_job_free(job);
+
+    free_real(params.x);
+    clear_constant_cache();
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_results,
+    test_cancel,
+    test_deadline,
+    NULL};
+char* test_names[] = {
+    "results",
+    "cancel",
+    "deadline",
+    NULL};
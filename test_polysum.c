@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "polysum.h"
+#include "test.h"
+
+
+int test_squares() {
+    int rtn = 0;
+
+    // 1 + 4 + ... + n^2 = (n + 3n^2 + 2n^3) / 6
+    struct Real** poly = malloc(3 * sizeof(struct Real*));
+    poly[0] = fill_real(POSITIVE, 0, 1, 0);
+    poly[1] = fill_real(POSITIVE, 0, 1, 0);
+    poly[2] = fill_real(POSITIVE, 0, 1, 1);
+
+    struct Real* denominator;
+    struct Real** sum = polysum(poly, 2, &denominator);
+    word correct[] = {0, 1, 3, 2};
+    int i;
+    struct Real* c;
+    for (i = 0; i <= 3; i++) {
+        c = fill_real(POSITIVE, 0, 1, correct[i]);
+        if (check_equal(sum[i], c) != 1) {
+            FAIL("sum of squares coefficient");
+            printf("x^%d: ", i);
+            print_real(sum[i]);
+        }
+        free_real(c);
+    }
+    c = fill_real(POSITIVE, 0, 1, 6);
+    if (check_equal(denominator, c) != 1) {
+        FAIL("sum of squares denominator");
+    }
+    free_real(c);
+
+
+    // Up to 2^64: 2^64 (2^64 + 1) (2^65 + 1) / 6.
+    struct Real* n = fill_real(POSITIVE, 0, 2, 0, 1);
+    struct Real* value = eval_polysum(sum, 3, denominator, n);
+    struct Real* n_1 = fill_real(POSITIVE, 0, 2, 1, 1);
+    struct Real* n_2 = fill_real(POSITIVE, 0, 2, 1, 2);
+    struct Real* temp = multiply(n, n_1);
+    struct Real* product = multiply(temp, n_2);
+    struct Real* expected = long_div_with_sig(product, denominator, 0);
+    if (check_equal(value, expected) != 1) {
+        FAIL("sum of squares up to 2^64");
+    }
+    free_real(expected);
+    free_real(product);
+    free_real(temp);
+    free_real(n_2);
+    free_real(n_1);
+    free_real(n);
+    free_real(value);
+
+    free_poly(sum, 3);
+    free_poly(poly, 2);
+    free_real(denominator);
+
+    return rtn;
+}
+
+int test_high_degree() {
+    int rtn = 0;
+
+    // P(x) = sum_i (-1)^i (i + 1) x^i for degree 60. S(n) - S(n - 1) should
+    // be P(n).
+    int degree = 60;
+    struct Real** poly = malloc((degree + 1) * sizeof(struct Real*));
+    int i;
+    for (i = 0; i <= degree; i++) {
+        poly[i] = fill_real((i % 2) ? NEGATIVE : POSITIVE, 0, 1, i + 1);
+    }
+
+    struct Real* denominator;
+    struct Real** sum = polysum(poly, degree, &denominator);
+
+    struct Real* ns[3] = {fill_real(POSITIVE, 0, 1, 1),
+                          fill_real(POSITIVE, 0, 1, 1000),
+                          fill_real(POSITIVE, 0, 1, 999)};
+    struct Real* results[3];
+    eval_polysum_batch(sum, degree + 1, denominator, ns, 3, results, 2);
+
+    // S(1) = P(1) = 1 - 2 + 3 - ... + 61 = 31.
+    struct Real* correct = fill_real(POSITIVE, 0, 1, 31);
+    if (check_equal(results[0], correct) != 1) {
+        FAIL("S(1)");
+        print_real(results[0]);
+    }
+    free_real(correct);
+
+    // P(1000) by Horner's method.
+    correct = copy_real(poly[degree]);
+    struct Real* temp;
+    for (i = degree - 1; i >= 0; i--) {
+        temp = multiply(correct, ns[1]);
+        free_real(correct);
+        correct = add(temp, poly[i]);
+        free_real(temp);
+    }
+    subtract_from(results[1], results[2]);
+    trim_zeros(results[1]);
+    trim_zeros(correct);
+    if (check_equal(results[1], correct) != 1) {
+        FAIL("S(1000) - S(999)");
+    }
+    free_real(correct);
+
+    for (i = 0; i < 3; i++) {
+        free_real(ns[i]);
+        free_real(results[i]);
+    }
+    free_poly(sum, degree + 1);
+    free_poly(poly, degree);
+    free_real(denominator);
+
+    return rtn;
+}
+
+int test_clear_denominators() {
+    int rtn = 0;
+
+    // 1/2 - x/3 = (3 - 2x) / 6
+    struct Rational* poly[2];
+    struct Real* n = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* d = fill_real(POSITIVE, 0, 1, 2);
+    poly[0] = make_rational(n, d);
+    free_real(d);
+    negate(n);
+    d = fill_real(POSITIVE, 0, 1, 3);
+    poly[1] = make_rational(n, d);
+    free_real(d);
+    free_real(n);
+
+    struct Real* common_den;
+    struct Real** cleared = clear_denominators(poly, 1, &common_den);
+    struct Real* correct[3] = {fill_real(POSITIVE, 0, 1, 3),
+                               fill_real(NEGATIVE, 0, 1, 2),
+                               fill_real(POSITIVE, 0, 1, 6)};
+    if (check_equal(cleared[0], correct[0]) != 1 ||
+        check_equal(cleared[1], correct[1]) != 1 ||
+        check_equal(common_den, correct[2]) != 1) {
+        FAIL("clear_denominators");
+    }
+
+    int i;
+    for (i = 0; i < 3; i++) {
+        free_real(correct[i]);
+    }
+    free_poly(cleared, 1);
+    free_real(common_den);
+    free_rational(poly[0]);
+    free_rational(poly[1]);
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_squares,
+    test_high_degree,
+    test_clear_denominators,
+    NULL};
+char* test_names[] = {
+    "squares",
+    "high_degree",
+    "clear_denominators",
+    NULL};
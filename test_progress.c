@@ -0,0 +1,97 @@
+#include <stdio.h>
+
+#include "real.h"
+#include "progress.h"
+#include "test.h"
+
+
+int test_stages() {
+    int rtn = 0;
+
+    // Without a `struct Progress` nothing is recorded or cancelled.
+    begin_stage("ignored", 1);
+    if (checkpoint(0) != 0 || is_cancelled() != 0) {
+        FAIL("nothing should be cancelled without progress");
+    }
+    end_stage();
+
+    struct Progress progress;
+    init_progress(&progress, 0);
+    set_thread_progress(&progress);
+
+    struct Stage stages[MAX_STAGES];
+    if (get_stages(&progress, stages) != 0) {
+        FAIL("there should be no stages yet");
+    }
+
+    begin_stage("outer", 10);
+    checkpoint(3);
+    begin_stage("inner", 0);
+    checkpoint(7);
+    if (get_stages(&progress, stages) != 2) {
+        FAIL("there should be 2 stages");
+    } else if (stages[0].step != 3 || stages[0].total != 10 ||
+               stages[1].step != 7 || stages[1].total != 0) {
+        FAIL("stage steps");
+    }
+
+    // Stages deeper than MAX_STAGES aren't recorded, but still nest.
+    int i;
+    for (i = 2; i < MAX_STAGES + 2; i++) {
+        begin_stage("deep", 1);
+    }
+    checkpoint(1);
+    if (get_stages(&progress, stages) != MAX_STAGES) {
+        FAIL("only MAX_STAGES stages should be recorded");
+    }
+    for (i = 2; i < MAX_STAGES + 2; i++) {
+        end_stage();
+    }
+    end_stage();
+    if (get_stages(&progress, stages) != 1 || stages[0].step != 3) {
+        FAIL("the outer stage should be left");
+    }
+    end_stage();
+
+    set_thread_progress(NULL);
+    return rtn;
+}
+
+int test_cancel() {
+    int rtn = 0;
+
+    struct Progress progress;
+    init_progress(&progress, 0);
+    set_thread_progress(&progress);
+    if (checkpoint(0) != 0) {
+        FAIL("nothing should be cancelled yet");
+    }
+    cancel_progress(&progress);
+    if (checkpoint(1) != 1 || is_cancelled() != 1) {
+        FAIL("cancel");
+    }
+
+    // A deadline in the past cancels at the next check, and it sticks.
+    init_progress(&progress, monotonic_seconds() - 1);
+    if (checkpoint(0) != 1 || progress.cancelled != 1) {
+        FAIL("deadline");
+    }
+
+    init_progress(&progress, monotonic_seconds() + 1000);
+    if (checkpoint(0) != 0) {
+        FAIL("a later deadline shouldn't cancel");
+    }
+
+    set_thread_progress(NULL);
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_stages,
+    test_cancel,
+    NULL};
+char* test_names[] = {
+    "stages",
+    "cancel",
+    NULL};
@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "rational.h"
+#include "thresholds.h"
+#include "test.h"
+
+
+struct Rational* small_rational(enum sign_t sign, word num, word den) {
+    struct Real* n = fill_real(sign, 0, 1, num);
+    struct Real* d = fill_real(POSITIVE, 0, 1, den);
+    struct Rational* q = make_rational(n, d);
+    free_real(n);
+    free_real(d);
+    return q;
+}
+
+int check_str(struct Rational* q, char* correct) {
+    char* str = rational_to_str(q);
+    int rtn = (strcmp(str, correct) == 0);
+    if (!rtn) {
+        printf("correct: %s\n", correct);
+        printf("ours:    %s\n", str);
+    }
+    free(str);
+    return rtn;
+}
+
+int test_gcd() {
+    int rtn = 0;
+
+    // gcd(2^200 3^5, 2^130 3^7 5) = 2^130 3^5
+    struct Real* three_5 = pow_word(3, 5);
+    struct Real* a = shift_left_bits(three_5, 200);
+    struct Real* b_odd = pow_word(3, 7);
+    struct Real* temp = fill_real(POSITIVE, 0, 1, 5);
+    struct Real* b_part = multiply(b_odd, temp);
+    struct Real* b = shift_left_bits(b_part, 130);
+    struct Real* correct = shift_left_bits(three_5, 130);
+    struct Real* g = gcd(a, b);
+    trim_zeros(g);
+    trim_zeros(correct);
+    if (check_equal(g, correct) != 1) {
+        FAIL("gcd of powers");
+        print_real(g);
+    }
+    free_real(g);
+    free_real(correct);
+    free_real(b);
+    free_real(b_part);
+    free_real(temp);
+    free_real(b_odd);
+    free_real(a);
+    free_real(three_5);
+
+    // Consecutive Fibonacci numbers are the worst case for Euclid, and
+    // are coprime.
+    struct Real* f_1 = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* f_2 = fill_real(POSITIVE, 0, 1, 1);
+    int i;
+    for (i = 0; i < 1000; i++) {
+        temp = add(f_1, f_2);
+        free_real(f_1);
+        f_1 = f_2;
+        f_2 = temp;
+    }
+    g = gcd(f_2, f_1);
+    correct = fill_real(POSITIVE, 0, 1, 1);
+    if (check_equal(g, correct) != 1) {
+        FAIL("gcd of Fibonacci numbers");
+    }
+    free_real(g);
+
+    // gcd(7^300 F, 7^200 F') = 7^200.
+    struct Real* seven_300 = pow_word(7, 300);
+    struct Real* seven_200 = pow_word(7, 200);
+    a = multiply(seven_300, f_2);
+    b = multiply(seven_200, f_1);
+    g = gcd(a, b);
+    trim_zeros(g);
+    trim_zeros(seven_200);
+    if (check_equal(g, seven_200) != 1) {
+        FAIL("gcd with a big common factor");
+    }
+    free_real(g);
+    free_real(a);
+    free_real(b);
+    free_real(seven_200);
+    free_real(seven_300);
+
+    // gcd(x, 0) = |x|
+    free_real(correct);
+    correct = fill_real(POSITIVE, 0, 1, 0);
+    g = gcd(correct, f_1);
+    if (check_equal(g, f_1) != 1) {
+        FAIL("gcd(0, x)");
+    }
+    free_real(g);
+    free_real(correct);
+    free_real(f_1);
+    free_real(f_2);
+
+    return rtn;
+}
+
+struct Real* fibonacci(int n) {
+    struct Real* f_1 = fill_real(POSITIVE, 0, 1, 0);
+    struct Real* f_2 = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* temp;
+    int i;
+    for (i = 0; i < n; i++) {
+        temp = add(f_1, f_2);
+        free_real(f_1);
+        f_1 = f_2;
+        f_2 = temp;
+    }
+    free_real(f_2);
+    trim_zeros(f_1);
+    return f_1;
+}
+
+int check_half_gcd(struct Real* a, struct Real* b) {
+    // Returns 1 if the half-GCD at every level finds the same GCD as
+    // Lehmer's method alone.
+    ssize_t old_threshold = thresholds.hgcd_min_words;
+    thresholds.hgcd_min_words = (ssize_t) 1 << 40;
+    struct Real* correct = gcd(a, b);
+    ssize_t hgcd_thresholds[] = {2, 3, 8};
+    int rtn = 1;
+    int i;
+    struct Real* g;
+    for (i = 0; i < 3; i++) {
+        thresholds.hgcd_min_words = hgcd_thresholds[i];
+        g = gcd(a, b);
+        trim_zeros(g);
+        trim_zeros(correct);
+        if (check_equal(g, correct) != 1) {
+            rtn = 0;
+        }
+        free_real(g);
+    }
+    thresholds.hgcd_min_words = old_threshold;
+    free_real(correct);
+    return rtn;
+}
+
+int test_half_gcd() {
+    int rtn = 0;
+
+    // Multiples of a big common factor by Fibonacci numbers, which take
+    // the most steps of Euclid's algorithm, and by less special numbers.
+    struct Real* c = pow_word(3, 2000);
+    struct Real* f_3000 = fibonacci(3000);
+    struct Real* f_2999 = fibonacci(2999);
+    struct Real* five = pow_word(5, 1500);
+    struct Real* other = add(f_2999, five);
+    struct Real* a = multiply(c, f_3000);
+    struct Real* b = multiply(c, f_2999);
+    struct Real* d = multiply(c, other);
+    trim_zeros(a);
+    trim_zeros(b);
+    trim_zeros(d);
+
+    ssize_t old_threshold = thresholds.hgcd_min_words;
+    thresholds.hgcd_min_words = 2;
+    struct Real* g = gcd(a, b);
+    thresholds.hgcd_min_words = old_threshold;
+    trim_zeros(g);
+    trim_zeros(c);
+    if (check_equal(g, c) != 1) {
+        FAIL("gcd of multiples of Fibonacci numbers");
+    }
+    free_real(g);
+    if (check_half_gcd(a, b) != 1 ||
+        check_half_gcd(a, d) != 1 ||
+        check_half_gcd(d, f_3000) != 1 ||
+        check_half_gcd(a, five) != 1) {
+        FAIL("half-GCD and Lehmer's method disagree");
+    }
+
+    free_real(c);
+    free_real(f_3000);
+    free_real(f_2999);
+    free_real(five);
+    free_real(other);
+    free_real(a);
+    free_real(b);
+    free_real(d);
+    return rtn;
+}
+
+int test_arithmetic() {
+    int rtn = 0;
+
+    struct Rational* third = small_rational(POSITIVE, 1, 3);
+    struct Rational* sixth = small_rational(POSITIVE, 1, 6);
+    struct Rational* q = add_rational(third, sixth);
+    if (!check_str(q, "1/2")) {
+        FAIL("1/3 + 1/6");
+    }
+    free_rational(q);
+
+    q = subtract_rational(sixth, third);
+    if (!check_str(q, "-1/6")) {
+        FAIL("1/6 - 1/3");
+    }
+    free_rational(q);
+
+    q = divide_rational(sixth, third);
+    if (!check_str(q, "1/2")) {
+        FAIL("(1/6) / (1/3)");
+    }
+    free_rational(q);
+
+    struct Rational* zero = small_rational(NEGATIVE, 0, 5);
+    if (!check_str(zero, "0")) {
+        FAIL("-0/5");
+    }
+    if (divide_rational(third, zero) != NULL) {
+        FAIL("division by 0 should be NULL");
+    }
+    free_rational(zero);
+
+    // The denominator's sign moves to the numerator.
+    struct Real* n = fill_real(POSITIVE, 0, 1, 4);
+    struct Real* d = fill_real(NEGATIVE, 0, 1, 6);
+    q = make_rational(n, d);
+    if (!check_str(q, "-2/3")) {
+        FAIL("4/-6");
+    }
+    free_rational(q);
+    free_real(n);
+    free_real(d);
+
+    // 1/3 = 0x0.5555...
+    struct Real* r = rational_to_real(third, -2);
+    struct Real* correct = fill_real(POSITIVE, -2, 0, 0x5555555555555555,
+                                     0x5555555555555555);
+    if (check_equal(r, correct) != 1) {
+        FAIL("rational_to_real(1/3)");
+    }
+    free_real(r);
+    free_real(correct);
+
+    free_rational(third);
+    free_rational(sixth);
+
+    return rtn;
+}
+
+int test_lazy() {
+    int rtn = 0;
+
+    // sum_k 1/(k (k + 1)) telescopes to 1 - 1/(n + 1).
+    struct Rational* sum = small_rational(POSITIVE, 0, 1);
+    struct Rational* term;
+    struct Rational* temp;
+    word k;
+    for (k = 1; k <= 300; k++) {
+        term = small_rational(POSITIVE, 1, k*(k + 1));
+        temp = add_rational(sum, term);
+        free_rational(sum);
+        free_rational(term);
+        sum = temp;
+    }
+    if (!check_str(sum, "300/301")) {
+        FAIL("telescoping sum");
+    }
+    free_rational(sum);
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_gcd,
+    test_half_gcd,
+    test_arithmetic,
+    test_lazy,
+    NULL};
+char* test_names[] = {
+    "gcd",
+    "half_gcd",
+    "arithmetic",
+    "lazy",
+    NULL};
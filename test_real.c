@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <pthread.h>
 
 #include "real.h"
 #include "test.h"
@@ -185,15 +186,204 @@ int test_trim() {
     return rtn;
 }
 
+int test_view() {
+    int rtn = 0;
+
+    struct Real* r = fill_real(NEGATIVE, -2, 2, 1, 2, 3, 4);
+    struct Real* v = view_real(r, -1, 1);
+    if (get_min_word_idx(v) != -1 || get_max_word_idx(v) != 1 ||
+        get_sign(v) != NEGATIVE) {
+        FAIL("view_real: indices and sign");
+    }
+    if (get_word(v, -2) != 0 || get_word(v, -1) != 2 ||
+        get_word(v, 0) != 3 || get_word(v, 1) != 0) {
+        FAIL("view_real: words");
+    }
+
+    // Views can't be changed.
+    if (set_word(v, 0, 7) != -1 || get_word(v, 0) != 3) {
+        FAIL("set_word on a view");
+    }
+
+    // Changing the parent doesn't change the view.
+    set_word(r, 0, 7);
+    if (get_word(r, 0) != 7 || get_word(v, 0) != 3) {
+        FAIL("set_word on the parent of a view");
+    }
+
+    // The view outlives its parent.
+    free_real(r);
+    if (get_word(v, -1) != 2 || get_word(v, 0) != 3) {
+        FAIL("view after freeing the parent");
+    }
+
+    struct Real* c = copy_real(v);
+    if (check_equal(c, v) != 1 || set_word(c, 0, 5) != 0) {
+        FAIL("copy of a view");
+    }
+    free_real(c);
+    free_real(v);
+
+    // Ranges are clamped to the words of the parent.
+    r = fill_real(POSITIVE, 0, 2, 0, 9);
+    v = view_real(r, -5, 5);
+    if (check_equal(r, v) != 1 || get_min_word_idx(v) != 0 ||
+        get_max_word_idx(v) != 2) {
+        FAIL("view_real: clamping");
+    }
+    trim_zeros(v);
+    if (get_min_word_idx(v) != 1 || get_word(v, 1) != 9 ||
+        get_min_word_idx(r) != 0) {
+        FAIL("trim_zeros on a view");
+    }
+    free_real(v);
+
+    v = view_real(r, 3, 5);
+    if (get_word(v, 0) != 0 || get_max_word_idx(v) != 1) {
+        FAIL("view_real: empty range");
+    }
+    free_real(v);
+    free_real(r);
+
+    return rtn;
+}
+
+#define VIEW_THREADS 4
+#define VIEWS_PER_THREAD 100000
+
+void* take_views(void* arg) {
+    struct Real* r = arg;
+    int i;
+    for (i = 0; i < VIEWS_PER_THREAD; i++) {
+        free_real(view_real(r, -1, 1));
+    }
+    return NULL;
+}
+
+int test_shared_views() {
+    int rtn = 0;
+
+    // Threads can take views of the same struct Real at once. If any
+    // reference count updates were lost, its words would be freed early
+    // or leaked, which valgrind reports.
+    struct Real* r = fill_real(POSITIVE, -2, 2, 1, 2, 3, 4);
+    pthread_t threads[VIEW_THREADS];
+    int i;
+    for (i = 0; i < VIEW_THREADS; i++) {
+        pthread_create(&threads[i], NULL, take_views, r);
+    }
+    for (i = 0; i < VIEW_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    struct Real* v = view_real(r, -2, 2);
+    set_word(r, 0, 7);
+    if (get_word(r, -1) != 2 || get_word(r, 0) != 7 ||
+        get_word(v, 0) != 3) {
+        FAIL("words after sharing views between threads");
+    }
+    free_real(v);
+    free_real(r);
+
+    return rtn;
+}
+
+int test_resize() {
+    int rtn = 0;
+
+    struct Real* r = fill_real(POSITIVE, -2, 2, 1, 2, 3, 4);
+
+    // Shrinking and then growing back exposes new words as 0.
+    resize_real(r, -1, 1);
+    if (get_word(r, -2) != 0 || get_word(r, -1) != 2 ||
+        get_word(r, 0) != 3 || get_word(r, 1) != 0) {
+        FAIL("shrinking");
+    }
+    resize_real(r, -2, 2);
+    if (get_word(r, -2) != 0 || get_word(r, -1) != 2 ||
+        get_word(r, 0) != 3 || get_word(r, 1) != 0) {
+        FAIL("growing within the buffer");
+    }
+
+    // Growing past the buffer keeps the old words.
+    resize_real(r, -5, 10);
+    set_word(r, 9, 9);
+    set_word(r, -5, 5);
+    if (get_word(r, -5) != 5 || get_word(r, -1) != 2 ||
+        get_word(r, 0) != 3 || get_word(r, 9) != 9 ||
+        get_word(r, 1) != 0) {
+        FAIL("growing past the buffer");
+    }
+
+    // Views keep their words when the parent is resized.
+    struct Real* v = view_real(r, -1, 1);
+    resize_real(r, -1, 0);
+    resize_real(r, -1, 1);
+    if (get_word(v, 0) != 3 || get_word(r, 0) != 0) {
+        FAIL("resizing the parent of a view");
+    }
+    if (resize_real(v, -2, 2) != -1) {
+        FAIL("resizing a view");
+    }
+    if (resize_real(r, 1, 1) != -1) {
+        FAIL("resizing to an empty range");
+    }
+
+    free_real(v);
+    free_real(r);
+
+    return rtn;
+}
+
+int test_shift_truncate() {
+    int rtn = 0;
+
+    struct Real* r = fill_real(POSITIVE, -2, 1, 1, 2, 3);
+    struct Real* v = view_real(r, -2, 1);
+
+    shift_words(v, 3);
+    if (get_min_word_idx(v) != 1 || get_max_word_idx(v) != 4 ||
+        get_word(v, 1) != 1 || get_word(v, 3) != 3) {
+        FAIL("shift_words");
+    }
+
+    truncate_real(v, 2);
+    if (get_min_word_idx(v) != 2 || get_word(v, 2) != 2 ||
+        get_word(v, 3) != 3) {
+        FAIL("truncate_real");
+    }
+    truncate_real(v, 7);
+    if (get_word(v, 0) != 0 || get_max_word_idx(v) != 1) {
+        FAIL("truncate_real to 0");
+    }
+
+    if (get_min_word_idx(r) != -2 || get_word(r, -2) != 1) {
+        FAIL("the parent of a view should be unchanged");
+    }
+
+    free_real(v);
+    free_real(r);
+
+    return rtn;
+}
+
 
 test_func_t tests[] = {
     test_fill_get_set,
     test_copy,
     test_equal,
-    test_trim, NULL};
+    test_trim,
+    test_view,
+    test_shared_views,
+    test_resize,
+    test_shift_truncate, NULL};
 char* test_names[] = {
     "fill_get_set",
     "copy",
     "equal",
-    "trim", NULL};
+    "trim",
+    "view",
+    "shared_views",
+    "resize",
+    "shift_truncate", NULL};
 
@@ -0,0 +1,224 @@
+#include <stdio.h>
+
+#include <stdexcept>
+#include <utility>
+
+#include "real.hpp"
+
+extern "C" {
+#include "test.h"
+}
+
+
+int equal(const real::Real& r1, struct Real* r2) {
+    // Returns 1 if `r1` and `r2` are the same number, and frees `r2`.
+    struct Real* a = copy_real(r1.get());
+    trim_zeros(a);
+    trim_zeros(r2);
+    int rtn = check_equal(a, r2);
+    free_real(a);
+    free_real(r2);
+    return rtn;
+}
+
+int test_ownership() {
+    int rtn = 0;
+
+    real::Real a(3);
+    struct Real* r = a.get();
+    real::Real b(std::move(a));
+    if (b.get() != r || a.get() != NULL) {
+        FAIL("moving should move the struct Real");
+    }
+    a = b.clone();
+    if (a.get() == b.get() || check_equal(a.get(), b.get()) != 1) {
+        FAIL("clone");
+    }
+    r = a.release();
+    if (a.get() != NULL) {
+        FAIL("release");
+    }
+    real::Real c(r);
+    if (c.to_string() != "3" ||
+        real::Real("-12.375").to_string() != "-12.375") {
+        FAIL("to_string");
+    }
+
+    bool threw = false;
+    try {
+        real::Real d("x");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    if (!threw) {
+        FAIL("parsing a bad string should throw");
+    }
+
+    return rtn;
+}
+
+int test_expressions() {
+    int rtn = 0;
+
+    real::Real a("1.5");
+    real::Real b("-2.25");
+    real::Real c("0.1");
+    real::Real d(7);
+
+    // Exact without a precision.
+    struct Real* ab = multiply(a.get(), b.get());
+    struct Real* cd = multiply(c.get(), d.get());
+    real::Real x = a*b + c;
+    if (equal(x, add(ab, c.get())) != 1) {
+        FAIL("a*b + c");
+    }
+    x = c*d - a*b - a;
+    struct Real* temp = subtract(cd, ab);
+    if (equal(x, subtract(temp, a.get())) != 1) {
+        FAIL("c*d - a*b - a");
+    }
+    free_real(temp);
+    x = -(a + b) * (c - d);
+    temp = add(a.get(), b.get());
+    struct Real* temp2 = subtract(c.get(), d.get());
+    negate(temp);
+    if (equal(x, multiply(temp, temp2)) != 1) {
+        FAIL("-(a + b) * (c - d)");
+    }
+    free_real(temp);
+    free_real(temp2);
+    x = (a*d)/3;
+    if (equal(x, fill_real(POSITIVE, -1, 1, (word) 0x8000000000000000, 3))
+        != 1) {
+        FAIL("(a*d)/3");
+    }
+
+    // Assigning to an operand.
+    x = a.clone();
+    x = x*b + x;
+    temp = add(ab, a.get());
+    if (equal(x, temp) != 1) {
+        FAIL("x = x*b + x");
+    }
+    x = a.clone();
+    x += x*b;
+    x -= b + x;
+    temp = add(ab, a.get());
+    temp2 = subtract(temp, b.get());
+    if (equal(x, subtract(temp2, temp)) != 1) {
+        FAIL("x += x*b; x -= b + x");
+    }
+    free_real(temp);
+    free_real(temp2);
+    free_real(ab);
+    free_real(cd);
+
+    return rtn;
+}
+
+int test_precision() {
+    int rtn = 0;
+
+    real::Real a(1);
+    real::Real b(3);
+    bool threw = false;
+    try {
+        real::Real q = a / b;
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    if (!threw) {
+        FAIL("dividing by a Real needs a precision");
+    }
+
+    real::Real third;
+    {
+        real::Precision precision(-4);
+        third = a / b;
+        {
+            real::Precision inner(-1);
+            if (equal(a/3, fill_real(POSITIVE, -1, 1,
+                                     (word) 0x5555555555555555, (word) 0))
+                != 1) {
+                FAIL("inner precision");
+            }
+        }
+        // Truncated products and sums, and functions.
+        real::Real x = third*third + third;
+        struct Real* t2 = mul_with_sig(third.get(), third.get(), -4);
+        struct Real* sum = add(t2, third.get());
+        if (close_enough(x.get(), sum, -4) != 1 ||
+            get_min_word_idx(x.get()) < -4) {
+            FAIL("third*third + third");
+        }
+        free_real(t2);
+        free_real(sum);
+
+        real::Real pi = real::pi();
+        real::Real s = real::sin(pi / 6);
+        struct Real* half = fill_real(POSITIVE, -1, 0,
+                                      (word) 0x8000000000000000);
+        if (close_enough(s.get(), half, -3) != 1) {
+            FAIL("sin(pi/6)");
+        }
+        free_real(half);
+
+        threw = false;
+        try {
+            real::Real r = real::sqrt(-b);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        if (!threw) {
+            FAIL("sqrt(-3) should throw");
+        }
+
+        // Word divisors have to fit in 32 bits.
+        if (equal(b / 0xffffffff, div_with_sig(b.get(), 0xffffffff, -4))
+            != 1) {
+            FAIL("b / (2^32 - 1)");
+        }
+        int num_threw = 0;
+        try {
+            real::Real q = b / (((word) 1 << 40) + 1);
+        } catch (const std::domain_error&) {
+            num_threw++;
+        }
+        try {
+            real::Real q = b.clone();
+            q /= (word) 1 << 32;
+        } catch (const std::domain_error&) {
+            num_threw++;
+        }
+        if (num_threw != 2) {
+            FAIL("dividing by 2^32 or more should throw");
+        }
+    }
+    struct Real* correct = fill_real(POSITIVE, -4, 0,
+                                     (word) 0x5555555555555555,
+                                     (word) 0x5555555555555555,
+                                     (word) 0x5555555555555555,
+                                     (word) 0x5555555555555555);
+    if (close_enough(third.get(), correct, -4) != 1 ||
+        real::Precision::is_set()) {
+        FAIL("a / b");
+    }
+    free_real(correct);
+
+    clear_constant_cache();
+    return rtn;
+}
+
+
+extern "C" {
+test_func_t tests[] = {
+    test_ownership,
+    test_expressions,
+    test_precision,
+    NULL};
+char* test_names[] = {
+    (char*) "ownership",
+    (char*) "expressions",
+    (char*) "precision",
+    NULL};
+}
@@ -0,0 +1,341 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "exp_log.h"
+#include "trig.h"
+#include "constants.h"
+#include "progress.h"
+#include "service.h"
+#include "test.h"
+
+
+#define NUM_CLIENTS 6
+
+void make_socket_path(char* path) {
+    snprintf(path, 64, "/tmp/test_service_%d", getpid());
+    unlink(path);
+}
+
+int test_ops() {
+    int rtn = 0;
+
+    signal(SIGPIPE, SIG_IGN);
+    char path[64];
+    make_socket_path(path);
+    struct Service* service = start_service(path, 2, 0);
+    if (service == NULL) {
+        FAIL("start_service");
+        return rtn;
+    }
+    if (start_service(path, 1, 0) != NULL) {
+        FAIL("the socket is already there");
+    }
+    struct ServiceConnection* connection = connect_service(path);
+    if (connection == NULL) {
+        FAIL("connect_service");
+        stop_service(service);
+        return rtn;
+    }
+
+    struct Real* r = call_service(connection, SERVICE_PI, NULL, -10);
+    struct Real* correct = pi_with_sig(-10);
+    if (r == NULL || close_enough(r, correct, -10) != 1) {
+        FAIL("pi");
+    }
+    free_real(r);
+    free_real(correct);
+
+    // 1.5 and 3.
+    struct Real* args[2] = {
+        fill_real(POSITIVE, -1, 1, 0x8000000000000000, 1),
+        fill_real(POSITIVE, 0, 1, 3)};
+    enum service_op_t ops[] = {
+        SERVICE_ADD, SERVICE_SUBTRACT, SERVICE_MULTIPLY, SERVICE_DIVIDE,
+        SERVICE_SQRT, SERVICE_EXP, SERVICE_LOG, SERVICE_COS, SERVICE_SIN};
+    struct Real* temp;
+    size_t i;
+    for (i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        switch (ops[i]) {
+        case SERVICE_ADD:
+            correct = add(args[0], args[1]);
+            break;
+        case SERVICE_SUBTRACT:
+            correct = subtract(args[0], args[1]);
+            break;
+        case SERVICE_MULTIPLY:
+            correct = multiply(args[0], args[1]);
+            break;
+        case SERVICE_DIVIDE:
+            correct = div_real_with_sig(args[0], args[1], -6);
+            break;
+        case SERVICE_SQRT:
+            correct = sqrt_with_sig(args[0], -6);
+            break;
+        case SERVICE_EXP:
+            correct = exp_with_sig(args[0], -6);
+            break;
+        case SERVICE_LOG:
+            correct = log_with_sig(args[0], -6);
+            break;
+        case SERVICE_COS:
+            correct = cos_with_sig(args[0], -6);
+            break;
+        default:
+            correct = sin_with_sig(args[0], -6);
+            break;
+        }
+        r = call_service(connection, ops[i], args, -6);
+        if (r == NULL || close_enough(r, correct, -6) != 1) {
+            printf("Op %d\n", ops[i]);
+            FAIL("wrong result");
+        }
+        if (r != NULL) {
+            free_real(r);
+        }
+        free_real(correct);
+    }
+
+    // Failures don't close the connection.
+    temp = args[1];
+    args[1] = fill_real(POSITIVE, 0, 1, 0);
+    if (call_service(connection, SERVICE_DIVIDE, args, -2) != NULL ||
+        call_service(connection, NUM_SERVICE_OPS, args, -2) != NULL) {
+        FAIL("dividing by 0 or a bad op should fail");
+    }
+    free_real(args[1]);
+    args[1] = temp;
+    r = call_service(connection, SERVICE_ADD, args, -2);
+    if (r == NULL || get_word(r, 0) != 4) {
+        FAIL("the connection should still work");
+    }
+    free_real(r);
+
+    free_real(args[0]);
+    free_real(args[1]);
+    close_service_connection(connection);
+    stop_service(service);
+    if (connect_service(path) != NULL) {
+        FAIL("the socket should be gone");
+    }
+    clear_constant_cache();
+    return rtn;
+}
+
+int send_raw_request(char* path, int64_t* request, size_t num_ints) {
+    // Sends `request` as it is and returns 1 if the service closes the
+    // connection instead of answering.
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 0;
+    }
+    int64_t status;
+    int rtn = (write(fd, request, num_ints*sizeof(int64_t))
+               == (ssize_t) (num_ints*sizeof(int64_t)) &&
+               read(fd, &status, sizeof(status)) == 0);
+    close(fd);
+    return rtn;
+}
+
+int test_malformed() {
+    int rtn = 0;
+
+    signal(SIGPIPE, SIG_IGN);
+    char path[64];
+    make_socket_path(path);
+    struct Service* service = start_service(path, 2, 0);
+    if (service == NULL) {
+        FAIL("start_service");
+        return rtn;
+    }
+
+    // Headers that would have the service allocate far too much, or
+    // nothing at all.
+    int64_t huge[] = {SERVICE_COS, -2, POSITIVE, 0, (int64_t) 1 << 60};
+    int64_t far[] = {SERVICE_COS, -2, POSITIVE, -((int64_t) 1 << 40),
+                     1 - ((int64_t) 1 << 40)};
+    int64_t empty[] = {SERVICE_COS, -2, POSITIVE, 5, 5};
+    int64_t precise[] = {SERVICE_PI, -((int64_t) 1 << 50)};
+    if (send_raw_request(path, huge, 5) != 1 ||
+        send_raw_request(path, far, 5) != 1 ||
+        send_raw_request(path, empty, 5) != 1 ||
+        send_raw_request(path, precise, 2) != 1) {
+        FAIL("malformed requests should close the connection");
+    }
+
+    // None of that hurt the service.
+    struct ServiceConnection* connection = connect_service(path);
+    struct Real* r = NULL;
+    if (connection != NULL) {
+        r = call_service(connection, SERVICE_PI, NULL, -2);
+        close_service_connection(connection);
+    }
+    struct Real* correct = pi_with_sig(-2);
+    if (r == NULL || close_enough(r, correct, -2) != 1) {
+        FAIL("the service should still work");
+    }
+    if (r != NULL) {
+        free_real(r);
+    }
+    free_real(correct);
+
+    stop_service(service);
+    clear_constant_cache();
+    return rtn;
+}
+
+int test_timeout() {
+    int rtn = 0;
+
+    signal(SIGPIPE, SIG_IGN);
+    char path[64];
+    make_socket_path(path);
+    struct Service* service = start_service(path, 1, 0.1);
+    if (service == NULL) {
+        FAIL("start_service");
+        return rtn;
+    }
+    struct ServiceConnection* connection = connect_service(path);
+    if (connection == NULL) {
+        FAIL("connect_service");
+        stop_service(service);
+        return rtn;
+    }
+
+    // This takes minutes, so it fails, and frees the worker for the next
+    // request.
+    struct Real* x = fill_real(POSITIVE, -1, 1, 0x8000000000000000, 1);
+    double start = monotonic_seconds();
+    struct Real* r = call_service(connection, SERVICE_LOG, &x, -2048);
+    if (r != NULL) {
+        FAIL("the request should time out");
+        free_real(r);
+    } else if (monotonic_seconds() - start > 10) {
+        FAIL("the request took too long to time out");
+    }
+    r = call_service(connection, SERVICE_LOG, &x, -2);
+    struct Real* correct = log_with_sig(x, -2);
+    if (r == NULL || close_enough(r, correct, -2) != 1) {
+        FAIL("the service should still work");
+    }
+    if (r != NULL) {
+        free_real(r);
+    }
+    free_real(correct);
+    free_real(x);
+
+    close_service_connection(connection);
+    stop_service(service);
+    return rtn;
+}
+
+struct Client {
+    char* path;
+    // SERVICE_E or SERVICE_SQRT of 2.
+    enum service_op_t op;
+    ssize_t min_sig_word_idx;
+    struct Real* result;
+};
+
+void* run_client(void* arg) {
+    struct Client* client = (struct Client*) arg;
+    struct ServiceConnection* connection = connect_service(client->path);
+    struct Real* two = fill_real(POSITIVE, 0, 1, 2);
+    if (connection != NULL) {
+        client->result = call_service(connection, client->op, &two,
+                                      client->min_sig_word_idx);
+        close_service_connection(connection);
+    }
+    free_real(two);
+    return NULL;
+}
+
+int test_concurrent() {
+    int rtn = 0;
+
+    signal(SIGPIPE, SIG_IGN);
+    char path[64];
+    make_socket_path(path);
+    struct Service* service = start_service(path, 2, 0);
+    if (service == NULL) {
+        FAIL("start_service");
+        return rtn;
+    }
+
+    // Clients asking for e at different precisions all get their own
+    // precision, however they're batched, and the square roots queued
+    // between them aren't lost.
+    struct Client clients[NUM_CLIENTS];
+    pthread_t threads[NUM_CLIENTS];
+    int i;
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        clients[i].path = path;
+        clients[i].op = (i % 3 == 2) ? SERVICE_SQRT : SERVICE_E;
+        clients[i].min_sig_word_idx = -5 - 7*i;
+        clients[i].result = NULL;
+        pthread_create(&threads[i], NULL, run_client, &clients[i]);
+    }
+    struct Real* two = fill_real(POSITIVE, 0, 1, 2);
+    struct Real* correct_e = get_constant(CONSTANT_E, -5 - 7*NUM_CLIENTS);
+    struct Real* correct_sqrt = sqrt_with_sig(two, -5 - 7*NUM_CLIENTS);
+    struct Real* correct;
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        pthread_join(threads[i], NULL);
+        correct = (clients[i].op == SERVICE_E) ? correct_e : correct_sqrt;
+        if (clients[i].result == NULL ||
+            get_min_word_idx(clients[i].result)
+            < clients[i].min_sig_word_idx ||
+            close_enough(clients[i].result, correct,
+                         clients[i].min_sig_word_idx) != 1) {
+            printf("Client %d\n", i);
+            FAIL("wrong result");
+        }
+        if (clients[i].result != NULL) {
+            free_real(clients[i].result);
+        }
+    }
+    free_real(two);
+    free_real(correct_e);
+    free_real(correct_sqrt);
+
+    // Stopping with a connection still open closes it.
+    struct ServiceConnection* connection = connect_service(path);
+    stop_service(service);
+    if (connection == NULL ||
+        call_service(connection, SERVICE_PI, NULL, -2) != NULL) {
+        FAIL("the connection should be closed");
+    }
+    if (connection != NULL) {
+        close_service_connection(connection);
+    }
+    clear_constant_cache();
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_ops,
+    test_concurrent,
+    test_malformed,
+    test_timeout,
+    NULL};
+char* test_names[] = {
+    "ops",
+    "concurrent",
+    "malformed",
+    "timeout",
+    NULL};
@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "thresholds.h"
+#include "shared_mul.h"
+#include "test.h"
+
+
+int test_multiply() {
+    int rtn = 0;
+
+    struct Thresholds old_thresholds = thresholds;
+    thresholds.karatsuba_min_words = 4;
+
+    struct Real* pairs[][2] = {
+        {pattern_real(POSITIVE, 0, 200, 1), pattern_real(POSITIVE, 0, 200, 2)},
+        {pattern_real(NEGATIVE, -70, 90, 3), pattern_real(POSITIVE, -5, 40, 4)},
+        {pattern_real(POSITIVE, -3, 0, 5), pattern_real(NEGATIVE, 2, 300, 6)},
+        {pattern_real(POSITIVE, 0, 2, 7), pattern_real(POSITIVE, 0, 1, 8)},
+        {NULL, NULL}};
+    // 1 worker splits nothing, and 9 splits 2 levels.
+    int num_processes[] = {1, 2, 4, 9};
+
+    int i, j;
+    struct Real* correct;
+    struct Real* p;
+    for (i = 0; pairs[i][0] != NULL; i++) {
+        correct = multiply(pairs[i][0], pairs[i][1]);
+        trim_zeros(correct);
+        for (j = 0; j < 4; j++) {
+            p = multiply_in_processes(pairs[i][0], pairs[i][1],
+                                      num_processes[j]);
+            trim_zeros(p);
+            if (check_equal(correct, p) != 1) {
+                FAIL("wrong product");
+                printf("pair %d, %d processes\n", i, num_processes[j]);
+            }
+            free_real(p);
+        }
+        free_real(correct);
+        free_real(pairs[i][0]);
+        free_real(pairs[i][1]);
+    }
+
+    thresholds = old_thresholds;
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_multiply,
+    NULL};
+char* test_names[] = {
+    "multiply",
+    NULL};
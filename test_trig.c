@@ -0,0 +1,142 @@
+#include <stdio.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "trig.h"
+#include "test.h"
+
+
+int test_cos() {
+    int rtn = 0;
+
+    struct Real* theta = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* correct = fill_real(POSITIVE, -8, 0,
+                                     0x9606fa2352b46375, 0xc9344041db820204,
+                                     0x43f3450e3b8ff99b, 0x96a94430a52d0e9e,
+                                     0xf2300240b760e6fa, 0xa2373a894f96c3b7,
+                                     0xc2466d976871bd29, 0x8a51407da8345c91);
+    struct Real* c = cos_with_sig(theta, -8);
+    if (close_enough(c, correct, -8) != 1) {
+        FAIL("cos(1)");
+        print_real(c);
+        print_real(correct);
+    }
+    free_real(c);
+    free_real(correct);
+
+    // Low precision should still be right at that precision.
+    correct = fill_real(POSITIVE, -1, 0, 0x8a51407da8345c91);
+    c = cos_with_sig(theta, -1);
+    if (close_enough(c, correct, -1) != 1) {
+        FAIL("cos(1) with one word");
+    }
+    free_real(c);
+    free_real(correct);
+    free_real(theta);
+
+    theta = fill_real(NEGATIVE, -1, 0, 0xc000000000000000);
+    correct = fill_real(POSITIVE, -8, 0,
+                        0x94980cc78c9582b2, 0x1fa13c555304c25d,
+                        0xcc891f2dd8e7df66, 0x106dbe6fd069f9b5,
+                        0xe4aee845e35575c3, 0xe0bfb8f20e7e44e6,
+                        0xc151839cb9d993b4, 0xbb4ff632a908f73e);
+    c = cos_with_sig(theta, -8);
+    if (close_enough(c, correct, -8) != 1) {
+        FAIL("cos(-3/4)");
+    }
+    free_real(c);
+    free_real(correct);
+    free_real(theta);
+
+    theta = fill_real(POSITIVE, 0, 1, 0);
+    correct = fill_real(POSITIVE, 0, 1, 1);
+    c = cos_with_sig(theta, -4);
+    if (close_enough(c, correct, -4) != 1) {
+        FAIL("cos(0)");
+    }
+    free_real(c);
+    free_real(correct);
+    free_real(theta);
+
+    return rtn;
+}
+
+int test_sin() {
+    int rtn = 0;
+
+    struct Real* theta = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* correct = fill_real(POSITIVE, -8, 0,
+                                     0xfe89a6250ceb0417, 0xc26355635dfd0ceb,
+                                     0x7655b5826a3d3b50, 0xfb0bd9ff1edcd457,
+                                     0xefb6ca5fd6c649bd, 0x89e511132f518b4d,
+                                     0xc6e9e909c50f3c32, 0xd76aa47848677020);
+    struct Real* s = sin_with_sig(theta, -8);
+    if (close_enough(s, correct, -8) != 1) {
+        FAIL("sin(1)");
+    }
+    free_real(s);
+    free_real(correct);
+    free_real(theta);
+
+    theta = fill_real(NEGATIVE, -1, 0, 0xc000000000000000);
+    correct = fill_real(NEGATIVE, -8, 0,
+                        0xb53cadf4f5459f68, 0xe7c8e05106f81956,
+                        0xef13e9a827e858ee, 0x0a971a49a6a40f98,
+                        0x7533f532cd044cb1, 0x476747c2646425fc,
+                        0x966e1d6af140a488, 0xae7fe0b5fc786b2d);
+    s = sin_with_sig(theta, -8);
+    if (close_enough(s, correct, -8) != 1) {
+        FAIL("sin(-3/4)");
+    }
+    free_real(s);
+    free_real(correct);
+    free_real(theta);
+
+    return rtn;
+}
+
+int test_sincos() {
+    int rtn = 0;
+
+    // sin^2 + cos^2 should be 1 at high precision.
+    struct Real* theta = fill_real(POSITIVE, -1, 1, 0x243f6a8885a308d3, 1);
+    struct Real* s;
+    struct Real* c;
+    sincos_with_sig(theta, -40, &s, &c);
+
+    struct Real* s_squared = mul_with_sig(s, s, -40);
+    struct Real* c_squared = mul_with_sig(c, c, -40);
+    struct Real* sum = add(s_squared, c_squared);
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    if (close_enough(sum, one, -40) != 1) {
+        FAIL("sin^2 + cos^2 = 1");
+    }
+
+    struct Real* c_only = cos_with_sig(theta, -40);
+    if (close_enough(c, c_only, -40) != 1) {
+        FAIL("sincos_with_sig and cos_with_sig agree");
+    }
+
+    free_real(theta);
+    free_real(s);
+    free_real(c);
+    free_real(s_squared);
+    free_real(c_squared);
+    free_real(sum);
+    free_real(one);
+    free_real(c_only);
+
+    return rtn;
+}
+
+
+test_func_t tests[] = {
+    test_cos,
+    test_sin,
+    test_sincos,
+    NULL};
+char* test_names[] = {
+    "cos",
+    "sin",
+    "sincos",
+    NULL};
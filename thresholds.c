@@ -0,0 +1,27 @@
+#include "thresholds.h"
+
+#if __has_include("tuned_thresholds.h")
+#include "tuned_thresholds.h"
+#else
+#define KARATSUBA_MIN_WORDS 32
+// Newton's method costs a few multiplications, and didn't beat long
+// division up to 16384 words, so it's off unless `make tune` finds
+// otherwise.
+#define NEWTON_DIV_MIN_WORDS ((ssize_t) 1 << 40)
+#define DECIMAL_SPLIT_MIN_WORDS 512
+#define PARALLEL_ADD_MIN_WORDS (1 << 16)
+#endif
+
+// Tuned headers from before the half-GCD don't have it.
+#ifndef HGCD_MIN_WORDS
+#define HGCD_MIN_WORDS 4096
+#endif
+
+
+struct Thresholds thresholds = {
+    KARATSUBA_MIN_WORDS,
+    NEWTON_DIV_MIN_WORDS,
+    DECIMAL_SPLIT_MIN_WORDS,
+    PARALLEL_ADD_MIN_WORDS,
+    HGCD_MIN_WORDS,
+};
@@ -0,0 +1,30 @@
+#ifndef THRESHOLDS_H
+#define THRESHOLDS_H
+
+#include <sys/types.h>
+
+// Crossover points between algorithms, in words.
+//
+// The defaults are built in, unless `make tune` has measured this
+// machine and generated tuned_thresholds.h, in which case those values
+// are used instead. Either way they can be changed at runtime.
+struct Thresholds {
+    // Operands at least this long are multiplied with Karatsuba instead
+    // of the schoolbook method.
+    ssize_t karatsuba_min_words;
+    // Divisors at least this long are divided by with Newton's method for
+    // the reciprocal instead of long division.
+    ssize_t newton_div_min_words;
+    // Integers at least this long are split in 2 for decimal conversion
+    // instead of repeatedly dividing out 10^9.
+    ssize_t decimal_split_min_words;
+    // Additions at least this long are split across threads.
+    ssize_t parallel_add_min_words;
+    // GCDs of integers at least this long use the recursive half-GCD
+    // instead of Lehmer's method alone.
+    ssize_t hgcd_min_words;
+};
+
+extern struct Thresholds thresholds;
+
+#endif
@@ -0,0 +1,223 @@
+#include "trig.h"
+
+#include "real.h"
+#include "arithmetic.h"
+#include "progress.h"
+
+
+struct TrigPlan {
+    // We evaluate the series at `theta / 2^k`.
+    ssize_t k;
+    // Only powers of the reduced argument below `max_power` are summed.
+    word max_power;
+    // The working precision, with guard words for the error growth of
+    // the double-angle steps.
+    ssize_t work_sig_word_idx;
+};
+
+ssize_t isqrt(ssize_t n) {
+    ssize_t x = 0;
+    while ((x + 1) * (x + 1) <= n) {
+        x++;
+    }
+    return x;
+}
+
+void plan_trig(struct Real* theta, ssize_t min_sig_word_idx,
+               struct TrigPlan* plan) {
+    // Pick the reduction and the number of terms up front.
+    // If |theta / 2^k| < 2^-r, each double-angle step costs about the same
+    // as each Taylor term, and the series needs about p/(2r) terms for
+    // p bits. Taking r ~ sqrt(p/2) roughly minimizes the total number of
+    // full-precision multiplies.
+    ssize_t target_bits = MAX(-min_sig_word_idx * WORD_BITS, WORD_BITS);
+    ssize_t r = isqrt(target_bits / 2) + 1;
+
+    plan->k = MAX(0, get_exponent(theta) + r);
+
+    // Each double-angle step can multiply the absolute error in
+    // 1 - cos by 4, so keep 2 extra bits per step.
+    ssize_t guard_words = (2*plan->k + WORD_BITS - 1) / WORD_BITS + 1;
+    plan->work_sig_word_idx = min_sig_word_idx - guard_words;
+
+    // The term y^m/m! is below 2^-(m*r + log2(m!)). Stop at the first power
+    // whose term is below the working precision. Summing floor(log2(j))
+    // gives a lower bound for log2(m!), so the bound is conservative.
+    ssize_t work_bits = -plan->work_sig_word_idx * WORD_BITS;
+    ssize_t log2_factorial = 0;
+    word m = 1;
+    while ((ssize_t) m * r + log2_factorial <= work_bits) {
+        m++;
+        log2_factorial += WORD_BITS - 1 - __builtin_clzl(m);
+    }
+    plan->max_power = m;
+}
+
+struct Real* reduce_argument(struct Real* theta, ssize_t k,
+                             ssize_t min_sig_word_idx) {
+    // Returns `theta / 2^k`.
+    struct Real* y = shift_right_bits(theta, k);
+    truncate_real(y, min_sig_word_idx);
+    return y;
+}
+
+struct Real* sum_series(struct Real* first_term, word first_power,
+                        struct Real* y_squared, word max_power,
+                        ssize_t min_sig_word_idx) {
+    // Sums the alternating series whose terms are (+/-) y^m / m! for
+    // m = first_power, first_power + 2, ... below `max_power`.
+    // Each term is computed from the previous one as
+    // -term * y^2 / ((m-1) * m).
+    // Returns NULL if the computation is cancelled.
+    struct Real* sum = copy_real(first_term);
+    struct Real* term = copy_real(first_term);
+    struct Real* temp1;
+    struct Real* temp2;
+
+    word m;
+    begin_stage("series term", (max_power - first_power) / 2);
+    for (m = first_power + 2; m < max_power; m += 2) {
+        if (checkpoint((m - first_power) / 2 - 1)) {
+            free_real(sum);
+            sum = NULL;
+            break;
+        }
+        temp1 = mul_with_sig(term, y_squared, min_sig_word_idx);
+        free_real(term);
+        temp2 = div_with_sig(temp1, (m - 1) * m, min_sig_word_idx);
+        free_real(temp1);
+        term = temp2;
+        negate(term);
+
+        add_to(sum, term);
+    }
+    end_stage();
+    free_real(term);
+    return sum;
+}
+
+void reduced_sincos(struct Real* theta, struct TrigPlan* plan,
+                    struct Real** sin_result,
+                    struct Real** one_minus_cos_result) {
+    // Computes sin(theta) (if `sin_result` is not NULL) and 1 - cos(theta)
+    // at the working precision of `plan`. Both results are NULL if the
+    // computation is cancelled.
+    // We track 1 - cos rather than cos, since cos is close to 1 for the
+    // reduced argument and the double-angle formula for 1 - cos doesn't
+    // lose precision to cancellation.
+    ssize_t work = plan->work_sig_word_idx;
+
+    struct Real* y = reduce_argument(theta, plan->k, work);
+    struct Real* y_squared = mul_with_sig(y, y, work);
+
+    // 1 - cos(y) = y^2/2 - y^4/4! + ...
+    struct Real* first_term = shift_right_bits(y_squared, 1);
+    truncate_real(first_term, work);
+    struct Real* c = sum_series(first_term, 2, y_squared,
+                                plan->max_power, work);
+    free_real(first_term);
+
+    // sin(y) = y - y^3/3! + ...
+    struct Real* s = NULL;
+    if (sin_result != NULL && c != NULL) {
+        s = sum_series(y, 1, y_squared, plan->max_power, work);
+    }
+    free_real(y);
+    free_real(y_squared);
+
+    // Double-angle steps:
+    //   1 - cos(2y) = 2 (1 - cos(y)) (2 - (1 - cos(y)))
+    //   sin(2y)     = 2 sin(y) (1 - (1 - cos(y)))
+    // Both are updated in-place, so only c^2 allocates.
+    struct Real* c_squared;
+    ssize_t step;
+    begin_stage("double-angle step", plan->k);
+    for (step = 0; step < plan->k; step++) {
+        // Once cancelled, this stays cancelled, which covers the series
+        // having stopped early.
+        if (checkpoint(step)) {
+            break;
+        }
+        if (s != NULL) {
+            fms_with_sig(s, s, c, work);
+            add_to(s, s);
+        }
+
+        c_squared = mul_with_sig(c, c, work);
+        add_to(c, c);
+        subtract_from(c, c_squared);
+        add_to(c, c);
+        free_real(c_squared);
+    }
+    end_stage();
+
+    if (is_cancelled()) {
+        if (s != NULL) {
+            free_real(s);
+            s = NULL;
+        }
+        if (c != NULL) {
+            free_real(c);
+            c = NULL;
+        }
+    }
+    if (sin_result != NULL) {
+        *sin_result = s;
+    }
+    *one_minus_cos_result = c;
+}
+
+struct Real* one_minus(struct Real* r, ssize_t min_sig_word_idx) {
+    // Returns 1 - r, truncated at `min_sig_word_idx`.
+    struct Real* one = fill_real(POSITIVE, 0, 1, 1);
+    struct Real* diff = subtract(one, r);
+    struct Real* rtn = div_with_sig(diff, 1, min_sig_word_idx);
+    free_real(one);
+    free_real(diff);
+    return rtn;
+}
+
+struct Real* cos_with_sig(struct Real* theta, ssize_t min_sig_word_idx) {
+    struct TrigPlan plan;
+    plan_trig(theta, min_sig_word_idx, &plan);
+
+    struct Real* c;
+    reduced_sincos(theta, &plan, NULL, &c);
+    if (c == NULL) {
+        return NULL;
+    }
+
+    struct Real* rtn = one_minus(c, min_sig_word_idx);
+    free_real(c);
+    return rtn;
+}
+
+struct Real* sin_with_sig(struct Real* theta, ssize_t min_sig_word_idx) {
+    struct Real* s;
+    struct Real* c;
+    sincos_with_sig(theta, min_sig_word_idx, &s, &c);
+    if (c != NULL) {
+        free_real(c);
+    }
+    return s;
+}
+
+void sincos_with_sig(struct Real* theta, ssize_t min_sig_word_idx,
+                     struct Real** sin_result, struct Real** cos_result) {
+    struct TrigPlan plan;
+    plan_trig(theta, min_sig_word_idx, &plan);
+
+    struct Real* s;
+    struct Real* c;
+    reduced_sincos(theta, &plan, &s, &c);
+    if (s == NULL) {
+        *sin_result = NULL;
+        *cos_result = NULL;
+        return;
+    }
+
+    *sin_result = div_with_sig(s, 1, min_sig_word_idx);
+    *cos_result = one_minus(c, min_sig_word_idx);
+    free_real(s);
+    free_real(c);
+}
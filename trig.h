@@ -0,0 +1,24 @@
+#ifndef TRIG_H
+#define TRIG_H
+
+#include "real.h"
+
+// Trigonometric functions, keeping only words at or above
+// `min_sig_word_idx`.
+//
+// The argument is divided by 2^k so that a short Taylor series
+// converges quickly, and the result is reconstructed with k
+// double-angle steps. Both k and the number of Taylor terms are picked
+// up front from the magnitude of `theta` and the requested precision.
+//
+// The results are accurate to within a few units of the word at
+// `min_sig_word_idx`, as long as `theta` is not huge. They are NULL if
+// the computation is cancelled (see progress.h).
+struct Real* cos_with_sig(struct Real* theta, ssize_t min_sig_word_idx);
+struct Real* sin_with_sig(struct Real* theta, ssize_t min_sig_word_idx);
+
+// Computes both sin(theta) and cos(theta) for the price of one.
+void sincos_with_sig(struct Real* theta, ssize_t min_sig_word_idx,
+                     struct Real** sin_result, struct Real** cos_result);
+
+#endif
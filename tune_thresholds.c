@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "real.h"
+#include "arithmetic.h"
+#include "decimal.h"
+#include "rational.h"
+#include "thresholds.h"
+
+// Measures where each faster algorithm starts beating the simpler one on
+// this machine, and writes the results as a header that thresholds.c
+// picks up in place of its defaults:
+//
+//   tune_thresholds <output header>
+//
+// `make tune` runs this and rebuilds.
+
+#define NEVER ((ssize_t) 1 << 40)
+
+// Each measurement runs for at least this long.
+#define MIN_SECONDS 0.02
+
+// The faster algorithm has to win by this much, so that noise doesn't
+// pick a threshold.
+#define MIN_SPEEDUP 1.1
+
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct Real* random_real(ssize_t min_word_idx, ssize_t max_word_idx) {
+    struct Real* r = alloc_real(POSITIVE, min_word_idx, max_word_idx);
+    ssize_t word_idx;
+    for (word_idx = min_word_idx; word_idx < max_word_idx; word_idx++) {
+        set_word(r, word_idx, ((word) rand() << 33) ^ ((word) rand() << 11)
+                 ^ rand());
+    }
+    // Make sure the top word isn't 0.
+    set_word(r, max_word_idx - 1, get_word(r, max_word_idx - 1) | 1);
+    return r;
+}
+
+enum operation_t {
+    OP_MULTIPLY,
+    OP_DIVIDE,
+    OP_TO_DECIMAL,
+    OP_ADD,
+    OP_GCD
+};
+
+double time_operation(enum operation_t op, struct Real* a, struct Real* b) {
+    // Returns the average time of one operation, in seconds.
+    double start = now();
+    double elapsed;
+    long num_runs = 0;
+    struct Real* r;
+    char* str;
+    do {
+        switch (op) {
+        case OP_MULTIPLY:
+            r = multiply(a, b);
+            free_real(r);
+            break;
+        case OP_DIVIDE:
+            r = div_real_with_sig(a, b, get_max_word_idx(a)
+                                  - 2*get_max_word_idx(b));
+            free_real(r);
+            break;
+        case OP_TO_DECIMAL:
+            str = real_to_decimal_str(a);
+            free(str);
+            break;
+        case OP_ADD:
+            r = add(a, b);
+            free_real(r);
+            break;
+        case OP_GCD:
+            r = gcd(a, b);
+            free_real(r);
+            break;
+        }
+        num_runs++;
+        elapsed = now() - start;
+    } while (elapsed < MIN_SECONDS);
+    return elapsed / num_runs;
+}
+
+ssize_t find_crossover(enum operation_t op, ssize_t* threshold,
+                       ssize_t* sizes, int num_sizes) {
+    // Returns the first size at which setting `*threshold` to that size
+    // (so the faster algorithm is used for one level) beats leaving it
+    // off. If it never does, it stays off: there's no telling how far
+    // past the sizes measured it would start to win, if at all.
+    ssize_t rtn = NEVER;
+    int i;
+    struct Real* a;
+    struct Real* b;
+    double slow, fast;
+    for (i = 0; i < num_sizes && rtn == NEVER; i++) {
+        a = random_real(0, (op == OP_DIVIDE) ? 2*sizes[i] : sizes[i]);
+        b = random_real(0, sizes[i]);
+
+        *threshold = NEVER;
+        slow = time_operation(op, a, b);
+        *threshold = sizes[i];
+        fast = time_operation(op, a, b);
+        printf("  %6ld words: %.3g s vs %.3g s\n", sizes[i], slow, fast);
+        if (fast*MIN_SPEEDUP < slow) {
+            rtn = sizes[i];
+        }
+
+        free_real(a);
+        free_real(b);
+    }
+    return rtn;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        puts("usage: tune_thresholds <output header>");
+        return 1;
+    }
+
+    ssize_t sizes[] = {4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256,
+                       384, 512};
+    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    ssize_t add_sizes[] = {1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18,
+                           1 << 20, 1 << 22};
+    int num_add_sizes = sizeof(add_sizes) / sizeof(add_sizes[0]);
+    // A GCD takes seconds at the top of these.
+    ssize_t gcd_sizes[] = {1024, 2048, 4096, 8192};
+    int num_gcd_sizes = sizeof(gcd_sizes) / sizeof(gcd_sizes[0]);
+
+    // Each of these uses the ones tuned before it.
+    struct Thresholds tuned = thresholds;
+
+    puts("schoolbook vs Karatsuba multiplication:");
+    tuned.karatsuba_min_words = find_crossover(
+        OP_MULTIPLY, &thresholds.karatsuba_min_words, sizes, num_sizes);
+    thresholds.karatsuba_min_words = tuned.karatsuba_min_words;
+
+    puts("long vs Newton division:");
+    tuned.newton_div_min_words = find_crossover(
+        OP_DIVIDE, &thresholds.newton_div_min_words, sizes, num_sizes);
+    thresholds.newton_div_min_words = tuned.newton_div_min_words;
+
+    puts("basecase vs split decimal conversion:");
+    tuned.decimal_split_min_words = find_crossover(
+        OP_TO_DECIMAL, &thresholds.decimal_split_min_words, sizes, num_sizes);
+    thresholds.decimal_split_min_words = tuned.decimal_split_min_words;
+
+    puts("serial vs parallel addition:");
+    tuned.parallel_add_min_words = find_crossover(
+        OP_ADD, &thresholds.parallel_add_min_words, add_sizes, num_add_sizes);
+    thresholds.parallel_add_min_words = tuned.parallel_add_min_words;
+
+    puts("Lehmer vs half-GCD:");
+    tuned.hgcd_min_words = find_crossover(
+        OP_GCD, &thresholds.hgcd_min_words, gcd_sizes, num_gcd_sizes);
+    thresholds.hgcd_min_words = tuned.hgcd_min_words;
+
+    FILE* f = fopen(argv[1], "w");
+    if (f == NULL) {
+        printf("Couldn't open %s!\n", argv[1]);
+        return 1;
+    }
+    fprintf(f, "// Generated by `make tune` for this machine. Delete this "
+            "file to go back\n// to the built-in defaults.\n\n");
+    fprintf(f, "#define KARATSUBA_MIN_WORDS %ld\n", tuned.karatsuba_min_words);
+    fprintf(f, "#define NEWTON_DIV_MIN_WORDS %ld\n",
+            tuned.newton_div_min_words);
+    fprintf(f, "#define DECIMAL_SPLIT_MIN_WORDS %ld\n",
+            tuned.decimal_split_min_words);
+    fprintf(f, "#define PARALLEL_ADD_MIN_WORDS %ld\n",
+            tuned.parallel_add_min_words);
+    fprintf(f, "#define HGCD_MIN_WORDS %ld\n", tuned.hgcd_min_words);
+    fclose(f);
+
+    printf("Wrote %s\n", argv[1]);
+    return 0;
+}